@@ -0,0 +1,579 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "csvParser.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define CORPUS_FILENAME "benchCsvParser.csv"
+#define CORPUS_BUFFER_SIZE (1024 * 1024)
+#define CORPUS_FIELD_MAX 128 // longest field written by the generator, quotes included
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Shape of the synthetic file, kept in the JSON report with the results
+typedef struct structCorpusOptions {
+  size_t size;    // bytes written at least, the last row is completed
+  int quoted;     // percentage of the fields quoted, a quarter of them with "" and a sixteenth with a newline
+  int minFields;  // fields of each row, drawn between the two
+  int maxFields;
+  uint64_t seed;
+} CorpusOptions;
+
+// What a mode has read, the same for all the modes or one of them is wrong
+typedef struct structTally {
+  uint64_t rows;
+  uint64_t fields;
+  uint64_t bytes; // of the fields once unquoted
+} Tally;
+
+typedef int (*ModeFunction)(const char *pFilePath, Tally *pTally);
+
+typedef struct structBenchMode {
+  const char *pName;
+  const char *pDescription;
+  ModeFunction function;
+} BenchMode;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static uint64_t _allocations;    // malloc(), calloc(), realloc() and strdup() calls of the parser
+static uint64_t _allocatedBytes; // bytes asked by these calls
+static uint64_t _random;
+static int _threads; // -j, for the parallel mode
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef BENCH_COUNT_ALLOCATIONS
+
+// The parser objects are linked with --wrap: their calls land here, those of the C library are not counted
+extern void *__real_malloc(size_t size);
+extern void *__real_calloc(size_t count, size_t size);
+extern void *__real_realloc(void *pBlock, size_t size);
+extern char *__real_strdup(const char *pText);
+
+static inline void countAllocation(size_t size) {
+  __atomic_fetch_add(&_allocations, 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&_allocatedBytes, size, __ATOMIC_RELAXED);
+}
+
+void *__wrap_malloc(size_t size) {
+  countAllocation(size);
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+  countAllocation(count * size);
+  return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pBlock, size_t size) {
+  countAllocation(size);
+  return __real_realloc(pBlock, size);
+}
+
+char *__wrap_strdup(const char *pText) {
+  countAllocation(strlen(pText) + 1);
+  return __real_strdup(pText);
+}
+
+#endif
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// xorshift64*, the same corpus on every platform for a given seed
+static uint32_t nextRandom(void) {
+  _random ^= _random >> 12;
+  _random ^= _random << 25;
+  _random ^= _random >> 27;
+  return (uint32_t)((_random * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static const char *const _ppWords[] = {"Verstappen", "Hamilton", "Leclerc", "Norris",  "Sainz",  "Russell",
+                                       "Piastri",    "Alonso",   "Gasly",   "Ocon",    "Albon",  "Bottas",
+                                       "Monaco",     "Suzuka",   "Monza",   "Imola",   "Spa",    "Silverstone",
+                                       "pit stop",   "soft",     "medium",  "hard",    "wet",    "safety car"};
+
+// A timing field as found in the files of the program: a number, a lap time or a name
+static int writeValue(char *pOutput) {
+  uint32_t value;
+
+  value = nextRandom();
+  switch (value % 4) {
+  case 0:
+    return sprintf(pOutput, "%u", value >> 8 & 0xFFFFF);
+  case 1:
+    return sprintf(pOutput, "%u:%02u.%03u", (value >> 8) % 2, (value >> 9) % 60, (value >> 16) % 1000);
+  case 2:
+    return sprintf(pOutput, "%u.%u", (value >> 8) % 1000, (value >> 20) % 100);
+  default:
+    return sprintf(pOutput, "%s", _ppWords[(value >> 8) % (sizeof(_ppWords) / sizeof(char *))]);
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static int writeField(char *pOutput, int quoted) {
+  uint32_t value;
+  int length;
+
+  if ((int)(nextRandom() % 100) >= quoted) {
+    return writeValue(pOutput);
+  }
+
+  // a quoted field always holds a delimiter, the parsers must not split it
+  value = nextRandom();
+  length = 0;
+  pOutput[length++] = '\"';
+  length += writeValue(pOutput + length);
+  pOutput[length++] = ',';
+  pOutput[length++] = ' ';
+  if (value % 4 == 0) {
+    length += sprintf(pOutput + length, "\"\"%s\"\"", _ppWords[(value >> 8) % (sizeof(_ppWords) / sizeof(char *))]);
+  } else {
+    length += writeValue(pOutput + length);
+  }
+  if (value % 16 == 1) {
+    pOutput[length++] = '\n';
+  }
+  pOutput[length++] = '\"';
+  return length;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static int writeCorpus(const char *pFilePath, const CorpusOptions *pOptions) {
+  char *pBuffer;
+  size_t written;
+  size_t used;
+  FILE *pFile;
+  int fields;
+  int i;
+
+  pFile = fopen(pFilePath, "wb");
+  pBuffer = (char *)malloc(CORPUS_BUFFER_SIZE);
+  if (pFile == NULL || pBuffer == NULL) {
+    printf("ERROR: unable to write '%s'\n", pFilePath);
+    free(pBuffer);
+    if (pFile != NULL) {
+      fclose(pFile);
+    }
+    return EXIT_FAILURE;
+  }
+
+  _random = pOptions->seed != 0 ? pOptions->seed : 1;
+  used = 0;
+  for (i = 0; i < pOptions->maxFields; i++) {
+    used += sprintf(pBuffer + used, i > 0 ? ",column%d" : "column%d", i);
+  }
+  pBuffer[used++] = '\n';
+
+  written = 0;
+  while (written + used < pOptions->size) {
+    fields = pOptions->minFields + (int)(nextRandom() % (uint32_t)(pOptions->maxFields - pOptions->minFields + 1));
+    for (i = 0; i < fields; i++) {
+      if (used + CORPUS_FIELD_MAX + 2 > CORPUS_BUFFER_SIZE) {
+        written += fwrite(pBuffer, 1, used, pFile);
+        used = 0;
+      }
+      if (i > 0) {
+        pBuffer[used++] = ',';
+      }
+      used += writeField(pBuffer + used, pOptions->quoted);
+    }
+    pBuffer[used++] = '\n';
+  }
+  written += fwrite(pBuffer, 1, used, pFile);
+
+  free(pBuffer);
+  if (fclose(pFile) != 0 || written < pOptions->size) {
+    printf("ERROR: unable to write '%s'\n", pFilePath);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void tallySlices(Tally *pTally, const CsvSliceRow *pRow) {
+  int i;
+
+  pTally->rows++;
+  pTally->fields += pRow->fields;
+  for (i = 0; i < pRow->fields; i++) {
+    pTally->bytes += pRow->pFields[i].length;
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static bool tallyRow(const CsvSliceRow *pRow, void *pUser) {
+  tallySlices((Tally *)pUser, pRow);
+  return true;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// csvParserGetRow(), with or without an arena
+static int parseRows(const char *pFilePath, bool arena, Tally *pTally) {
+  CsvParser *pCsvParser;
+  CsvArena csvArena;
+  CsvRow *pCsvRow;
+  int i;
+
+  pCsvParser = csvParserCreate(pFilePath, NULL, true);
+  if (pCsvParser == NULL) {
+    return EXIT_FAILURE;
+  }
+  if (arena) {
+    csvArenaInit(&csvArena, 0);
+    csvParserSetArena(pCsvParser, &csvArena);
+  }
+
+  while ((pCsvRow = csvParserGetRow(pCsvParser)) != NULL) {
+    pTally->rows++;
+    pTally->fields += pCsvRow->fields;
+    for (i = 0; i < pCsvRow->fields; i++) {
+      pTally->bytes += strlen(pCsvRow->ppFields[i]);
+    }
+    csvParserDestroyRow(pCsvRow);
+  }
+
+  csvParserDestroy(pCsvParser);
+  if (arena) {
+    csvArenaFree(&csvArena);
+  }
+  return EXIT_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static int parseRowsMalloc(const char *pFilePath, Tally *pTally) {
+  return parseRows(pFilePath, false, pTally);
+}
+
+static int parseRowsArena(const char *pFilePath, Tally *pTally) {
+  return parseRows(pFilePath, true, pTally);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// csvParserGetSlices() on the mapped file
+static int parseSlices(const char *pFilePath, bool structuralIndex, Tally *pTally) {
+  CsvParser *pCsvParser;
+  CsvSliceRow row;
+
+  pCsvParser = csvParserCreateFromMapping(pFilePath, NULL, true);
+  if (pCsvParser == NULL) {
+    return EXIT_FAILURE;
+  }
+  csvParserUseStructuralIndex(pCsvParser, structuralIndex);
+
+  while (csvParserGetSlices(pCsvParser, &row)) {
+    tallySlices(pTally, &row);
+  }
+
+  csvParserDestroy(pCsvParser);
+  return EXIT_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static int parseSlicesScalar(const char *pFilePath, Tally *pTally) {
+  return parseSlices(pFilePath, false, pTally);
+}
+
+static int parseSlicesIndexed(const char *pFilePath, Tally *pTally) {
+  return parseSlices(pFilePath, true, pTally);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static int parseForEach(const char *pFilePath, Tally *pTally) {
+  CsvParser *pCsvParser;
+  int rows;
+
+  pCsvParser = csvParserCreate(pFilePath, NULL, true);
+  if (pCsvParser == NULL) {
+    return EXIT_FAILURE;
+  }
+  rows = csvParserForEach(pCsvParser, tallyRow, pTally);
+  csvParserDestroy(pCsvParser);
+  return rows == -1 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static int parseParallel(const char *pFilePath, Tally *pTally) {
+  CsvParser *pCsvParser;
+  int rows;
+
+  pCsvParser = csvParserCreateFromMapping(pFilePath, NULL, true);
+  if (pCsvParser == NULL) {
+    return EXIT_FAILURE;
+  }
+  rows = csvParserForEachParallel(pCsvParser, _threads, tallyRow, pTally);
+  csvParserDestroy(pCsvParser);
+  return rows == -1 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static const BenchMode _pModes[] = {
+    {"rows", "csvParserGetRow(), one malloc() per row", parseRowsMalloc},
+    {"rowsArena", "csvParserGetRow() with a CsvArena", parseRowsArena},
+    {"slices", "csvParserGetSlices() on the mapping, byte per byte", parseSlicesScalar},
+    {"slicesIndexed", "csvParserGetSlices() on the mapping, structural index", parseSlicesIndexed},
+    {"forEach", "csvParserForEach(), chunks of CSV_CHUNK_SIZE", parseForEach},
+    {"parallel", "csvParserForEachParallel() on the mapping", parseParallel}};
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static double elapsedSeconds(const struct timespec *pStart) {
+  struct timespec end;
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  return (double)(end.tv_sec - pStart->tv_sec) + (double)(end.tv_nsec - pStart->tv_nsec) / 1e9;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The paths may hold '\' on Windows
+static void printJsonString(FILE *pOutput, const char *pText) {
+  fputc('\"', pOutput);
+  for (; *pText != '\0'; pText++) {
+    if (*pText == '\"' || *pText == '\\') {
+      fputc('\\', pOutput);
+    }
+    if ((unsigned char)*pText >= ' ') {
+      fputc(*pText, pOutput);
+    }
+  }
+  fputc('\"', pOutput);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void printUsage(void) {
+  size_t i;
+
+  printf("Usage: benchCsvParser [-s megabytes] [-q quoted%%] [-f fields[:maxFields]] [-r seed] [-n iterations]\n");
+  printf("                      [-j threads] [-m mode] [-i input.csv | -g corpus.csv] [-o results.json]\n");
+  printf("  -i  Parse an existing file instead of a generated one.\n");
+  printf("  -g  Write the generated corpus and exit.\n");
+  printf("  -m  Run this mode only:");
+  for (i = 0; i < sizeof(_pModes) / sizeof(BenchMode); i++) {
+    printf(" %s", _pModes[i].pName);
+  }
+  printf("\n  -o  Results as JSON in this file. Default: stdout\n");
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int main(int argc, char *ppArgv[]) {
+  struct timespec start;
+  struct stat status;
+  CorpusOptions corpus;
+  const BenchMode *pMode;
+  const char *pCorpusPath;
+  const char *pInputPath;
+  const char *pOutputPath;
+  const char *pModeName;
+  const char *pFilePath;
+  uint64_t allocations;
+  uint64_t allocatedBytes;
+  Tally reference;
+  Tally tally;
+  double seconds;
+  double best;
+  FILE *pOutput;
+  bool first;
+  int iterations;
+  int errors;
+  int modes;
+  int opt;
+  int n;
+  int i;
+
+  corpus.size = 64 * 1024 * 1024;
+  corpus.quoted = 10;
+  corpus.minFields = 8;
+  corpus.maxFields = 8;
+  corpus.seed = 42;
+  iterations = 3;
+  _threads = 0;
+  pCorpusPath = NULL;
+  pInputPath = NULL;
+  pOutputPath = NULL;
+  pModeName = NULL;
+  while ((opt = getopt(argc, ppArgv, "s:q:f:r:n:j:m:i:g:o:h?")) != -1) {
+    switch (opt) {
+    case 's':
+      corpus.size = (size_t)(strtod(optarg, NULL) * 1024 * 1024);
+      break;
+    case 'q':
+      corpus.quoted = atoi(optarg);
+      break;
+    case 'f':
+      if (sscanf(optarg, "%d:%d", &corpus.minFields, &corpus.maxFields) < 2) {
+        corpus.maxFields = corpus.minFields;
+      }
+      break;
+    case 'r':
+      corpus.seed = strtoull(optarg, NULL, 10);
+      break;
+    case 'n':
+      iterations = atoi(optarg);
+      break;
+    case 'j':
+      _threads = atoi(optarg);
+      break;
+    case 'm':
+      pModeName = optarg;
+      break;
+    case 'i':
+      pInputPath = optarg;
+      break;
+    case 'g':
+      pCorpusPath = optarg;
+      break;
+    case 'o':
+      pOutputPath = optarg;
+      break;
+    case 'h':
+    case '?':
+    default:
+      printUsage();
+      return EXIT_SUCCESS;
+    }
+  }
+  if (iterations < 1) {
+    iterations = 1;
+  }
+  if (_threads < 1) {
+    _threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  if (corpus.minFields < 1 || corpus.maxFields < corpus.minFields || corpus.maxFields > 1000 || corpus.quoted < 0 ||
+      corpus.quoted > 100) {
+    printf("ERROR: fields must be 1 to 1000 and quoted 0 to 100\n");
+    return EXIT_FAILURE;
+  }
+
+  if (pCorpusPath != NULL) {
+    return writeCorpus(pCorpusPath, &corpus);
+  }
+  pFilePath = pInputPath;
+  if (pFilePath == NULL) {
+    pFilePath = CORPUS_FILENAME;
+    if (writeCorpus(pFilePath, &corpus) != EXIT_SUCCESS) {
+      return EXIT_FAILURE;
+    }
+  }
+  if (stat(pFilePath, &status) != 0) {
+    printf("ERROR: unable to read '%s'\n", pFilePath);
+    return EXIT_FAILURE;
+  }
+
+  pOutput = pOutputPath != NULL ? fopen(pOutputPath, "w") : stdout;
+  if (pOutput == NULL) {
+    printf("ERROR: unable to write '%s'\n", pOutputPath);
+    return EXIT_FAILURE;
+  }
+
+  fprintf(pOutput, "{\"benchmark\":\"csvParser\",\"kernel\":\"%s\",\"iterations\":%d,\"threads\":%d,\n",
+          csvScanKernelName(csvScanKernel()), iterations, _threads);
+  fprintf(pOutput, " \"corpus\":{\"path\":");
+  printJsonString(pOutput, pFilePath);
+  fprintf(pOutput, ",\"bytes\":%lld,\"generated\":%s", (long long)status.st_size,
+          pInputPath == NULL ? "true" : "false");
+  if (pInputPath == NULL) {
+    fprintf(pOutput, ",\"quoted\":%d,\"minFields\":%d,\"maxFields\":%d,\"seed\":%llu", corpus.quoted,
+            corpus.minFields, corpus.maxFields, (unsigned long long)corpus.seed);
+  }
+  fprintf(pOutput, "},\n \"modes\":[");
+
+  // every mode must read what the first one read, the time kept is the best of the iterations
+  errors = 0;
+  modes = 0;
+  first = true;
+  memset(&reference, 0, sizeof(reference));
+  for (i = 0; i < (int)(sizeof(_pModes) / sizeof(BenchMode)); i++) {
+    pMode = &_pModes[i];
+    if (pModeName != NULL && strcmp(pModeName, pMode->pName) != 0) {
+      continue;
+    }
+
+    best = 0;
+    allocations = 0;
+    allocatedBytes = 0;
+    for (n = 0; n < iterations; n++) {
+      memset(&tally, 0, sizeof(tally));
+      _allocations = 0;
+      _allocatedBytes = 0;
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      if (pMode->function(pFilePath, &tally) != EXIT_SUCCESS) {
+        fprintf(stderr, "ERROR: mode %s is unable to parse '%s'\n", pMode->pName, pFilePath);
+        errors++;
+        break;
+      }
+      seconds = elapsedSeconds(&start);
+      allocations = _allocations;
+      allocatedBytes = _allocatedBytes;
+      if (n == 0 || seconds < best) {
+        best = seconds;
+      }
+    }
+    if (n < iterations) {
+      continue;
+    }
+
+    if (first) {
+      reference = tally;
+      first = false;
+    } else if (tally.rows != reference.rows || tally.fields != reference.fields || tally.bytes != reference.bytes) {
+      fprintf(stderr, "ERROR: mode %s read %llu rows, %llu fields, %llu bytes instead of %llu, %llu, %llu\n",
+              pMode->pName, (unsigned long long)tally.rows, (unsigned long long)tally.fields,
+              (unsigned long long)tally.bytes, (unsigned long long)reference.rows,
+              (unsigned long long)reference.fields, (unsigned long long)reference.bytes);
+      errors++;
+    }
+
+    fprintf(pOutput, "%s\n  {\"mode\":\"%s\",\"description\":\"%s\",\"seconds\":%.6f,\"mbPerSecond\":%.1f,",
+            modes > 0 ? "," : "", pMode->pName, pMode->pDescription, best, (double)status.st_size / best / 1e6);
+    fprintf(pOutput, "\"rowsPerSecond\":%.0f,\"rows\":%llu,\"fields\":%llu,", (double)tally.rows / best,
+            (unsigned long long)tally.rows, (unsigned long long)tally.fields);
+#ifdef BENCH_COUNT_ALLOCATIONS
+    fprintf(pOutput, "\"allocations\":%llu,\"allocatedBytes\":%llu,\"allocationsPerRow\":%.4f}",
+            (unsigned long long)allocations, (unsigned long long)allocatedBytes,
+            tally.rows > 0 ? (double)allocations / tally.rows : 0.0);
+#else
+    fprintf(pOutput, "\"allocations\":null,\"allocatedBytes\":null,\"allocationsPerRow\":null}");
+#endif
+    fprintf(stderr, "INFO: %-14s %8.1f MB/s %12.0f rows/s %10.4f allocations/row\n", pMode->pName,
+            (double)status.st_size / best / 1e6, (double)tally.rows / best,
+            tally.rows > 0 ? (double)allocations / tally.rows : 0.0);
+    modes++;
+  }
+  fprintf(pOutput, "\n ],\n \"errors\":%d}\n", errors);
+
+  if (pOutput != stdout) {
+    fclose(pOutput);
+  }
+  if (pInputPath == NULL) {
+    unlink(pFilePath);
+  }
+
+  return errors > 0 || modes == 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,663 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+
+#ifdef LINUX
+#include <linux/limits.h>
+#endif
+
+#include "csvParser.h"
+#include "report.h"
+#include "saveFile.h"
+#include "schema.h"
+#include "scoring.h"
+#include "testFixtures.h"
+#include "util.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define BENCH_YEAR 2024
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// fprintf() versions formerly used by saveGrandPrixToFile(), the totals left by a driver without lap are reset at
+// the start of each session as the buffer version does
+static int referenceSaveRace(Context *pCtx, FILE *pFile, Race *pRace) {
+  uint32_t previousTime;
+  RaceInfo *pRaceInfo;
+  const DriverInfo *pDriver;
+  char pBestLapTime[32];
+  char pBestS1Time[32];
+  char pBestS2Time[32];
+  char pBestS3Time[32];
+  char pTotalTime[32];
+  char pGapTime[32];
+  int carId;
+  int cars;
+  int i;
+
+  pRaceInfo = pRace->pItems;
+  fprintf(pFile, "\n\n");
+  fprintf(pFile, "Epreuve: %s\n", raceTypeToString(pRace->type));
+  fprintf(pFile, "Pos   Number     Driver                      Team                       Best S1  Best S2  "
+                 "Best S3   Best lap time     Gap     Laps   Total time\n");
+  fprintf(pFile, "------------------------------------------------------------------------------------------"
+                 "------------------------------------------------------\n");
+
+  if (pRace->type == race_Q2_GP || pRace->type == race_Q2_SPRINT) {
+    cars = MAX_DRIVERS_Q2;
+  } else if (pRace->type == race_Q3_GP || pRace->type == race_Q3_SPRINT) {
+    cars = MAX_DRIVERS_Q3;
+  } else {
+    cars = MAX_DRIVERS_Q1;
+  }
+  pTotalTime[0] = 0;
+  previousTime = 0;
+  for (i = 0; i < cars; i++) {
+    carId = pRaceInfo->carId;
+    pDriver = &pCtx->pDrivers[carId];
+
+    pBestLapTime[0] = 0;
+    pGapTime[0] = 0;
+    pBestS1Time[0] = pBestS2Time[0] = pBestS3Time[0] = 0;
+    if (pRaceInfo->bestLapTime > 0) {
+      timestampToSecond(pRaceInfo->bestS1, pBestS1Time, sizeof(pBestS1Time));
+      timestampToSecond(pRaceInfo->bestS2, pBestS2Time, sizeof(pBestS2Time));
+      timestampToSecond(pRaceInfo->bestS3, pBestS3Time, sizeof(pBestS3Time));
+      timestampToMinute(pRaceInfo->bestLapTime, pBestLapTime, sizeof(pBestLapTime));
+      timestampToHour(pRaceInfo->raceTime, pTotalTime, sizeof(pTotalTime));
+      if (i == 0) {
+        previousTime = pRaceInfo->bestLapTime;
+      } else {
+        milliToGap(pRaceInfo->bestLapTime - previousTime, pGapTime, sizeof(pGapTime));
+      }
+    }
+
+    fprintf(pFile, "%3d  %5s    %-20.20s   %-30.30s   %8s %8s %8s     %10s   %10s  %3d    %10s\n", i + 1,
+            pDriver->pNumber, pDriver->pName, pDriver->pTeam, pBestS1Time, pBestS2Time, pBestS3Time, pBestLapTime,
+            pGapTime, pRaceInfo->bestLap + 1, pTotalTime);
+    pRaceInfo++;
+  }
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static int referenceSaveSprintOrFinal(Context *pCtx, FILE *pFile, int grandPrixId, Race *pRace) {
+  int32_t pPoints[MAX_DRIVERS];
+  uint32_t previousTime;
+  RaceInfo *pRaceInfo;
+  const DriverInfo *pDriver;
+  char pBestLapTime[32];
+  char pBestS1Time[32];
+  char pBestS2Time[32];
+  char pBestS3Time[32];
+  char pTotalTime[32];
+  char pPitsTime[32];
+  char pGapTime[32];
+  char pPointsText[16];
+  int carId;
+  int cars;
+  int i;
+
+  racePoints(pCtx->pScoring, grandPrixId, pRace, pPoints);
+  pRaceInfo = pRace->pItems;
+  fprintf(pFile, "\n\n");
+  fprintf(pFile, "Epreuve: %s\n", raceTypeToString(pRace->type));
+  fprintf(pFile, "Pos   Number     Driver                      Team                       Best S1  Best S2  "
+                 "Best S3   Best lap time   Laps   Pits  Pits time   Total time     Gap      Points\n");
+  fprintf(pFile, "------------------------------------------------------------------------------------------"
+                 "---------------------------------------------------------------------------------\n");
+
+  if (pRace->type == race_Q2_GP || pRace->type == race_Q2_SPRINT) {
+    cars = MAX_DRIVERS_Q2;
+  } else if (pRace->type == race_Q3_GP || pRace->type == race_Q3_SPRINT) {
+    cars = MAX_DRIVERS_Q3;
+  } else {
+    cars = MAX_DRIVERS_Q1;
+  }
+  pPitsTime[0] = pTotalTime[0] = 0;
+  previousTime = 0;
+  for (i = 0; i < cars; i++) {
+    carId = pRaceInfo->carId;
+    pDriver = &pCtx->pDrivers[carId];
+
+    pBestLapTime[0] = 0;
+    pGapTime[0] = 0;
+    pBestS1Time[0] = pBestS2Time[0] = pBestS3Time[0] = 0;
+    if (pRaceInfo->bestLapTime > 0) {
+      timestampToSecond(pRaceInfo->bestS1, pBestS1Time, sizeof(pBestS1Time));
+      timestampToSecond(pRaceInfo->bestS2, pBestS2Time, sizeof(pBestS2Time));
+      timestampToSecond(pRaceInfo->bestS3, pBestS3Time, sizeof(pBestS3Time));
+      timestampToMinute(pRaceInfo->bestLapTime, pBestLapTime, sizeof(pBestLapTime));
+      timestampToMinute(pRaceInfo->pitsTime, pPitsTime, sizeof(pPitsTime));
+      timestampToHour(pRaceInfo->raceTime, pTotalTime, sizeof(pTotalTime));
+    }
+    if (i == 0) {
+      previousTime = pRaceInfo->raceTime;
+    } else {
+      milliToGap(pRaceInfo->raceTime - previousTime, pGapTime, sizeof(pGapTime));
+    }
+
+    fprintf(pFile, "%3d  %5s    %-20.20s   %-30.30s   %8s %8s %8s     %10s     %3d   %3d   %10s  %10s %10s  %4s\n",
+            i + 1, pDriver->pNumber, pDriver->pName, pDriver->pTeam, pBestS1Time, pBestS2Time, pBestS3Time,
+            pBestLapTime, pRaceInfo->bestLap + 1, pRaceInfo->pits, pPitsTime, pTotalTime, pGapTime,
+            pointsToString(pPoints[i], pPointsText, sizeof(pPointsText)));
+    pRaceInfo++;
+  }
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static int referenceSaveStartingGrid(Context *pCtx, FILE *pFile, RaceType type, Race *pRace) {
+  RaceInfo *pRaceInfo;
+  const DriverInfo *pDriver;
+  char pBestLapTime[32];
+  int carId;
+  int i;
+
+  pRaceInfo = pRace->pItems;
+  fprintf(pFile, "\n\n");
+  fprintf(pFile, "Grille de départ: %s\n", raceTypeToString(type));
+  fprintf(pFile, "Pos   Number     Driver                      Team                       Best time\n");
+  fprintf(pFile, "---------------------------------------------------------------------------------\n");
+
+  for (i = 0; i < MAX_DRIVERS; i++) {
+    if (i == 0) {
+      pRaceInfo = (RaceInfo *)pRace[2].pItems;
+    } else if (i == MAX_DRIVERS_Q3) {
+      pRaceInfo = (RaceInfo *)&pRace[1].pItems[MAX_DRIVERS_Q3];
+    } else if (i == MAX_DRIVERS_Q2) {
+      pRaceInfo = (RaceInfo *)&pRace[0].pItems[MAX_DRIVERS_Q2];
+    }
+
+    carId = pRaceInfo->carId;
+    pDriver = &pCtx->pDrivers[carId];
+
+    fprintf(pFile, "%3d  %5s    %-20.20s   %-30.30s    %10s\n", i + 1, pDriver->pNumber, pDriver->pName,
+            pDriver->pTeam, timestampToMinute(pRaceInfo->bestLapTime, pBestLapTime, sizeof(pBestLapTime)));
+    pRaceInfo++;
+  }
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static int referenceSaveStandings(Context *pCtx, FILE *pFile) {
+  StandingsTableItem *pStandingsTableItem;
+  const DriverInfo *pDriver;
+  char pPoints[16];
+  int carId;
+  int i;
+
+  fprintf(pFile, "\n\n");
+  fprintf(pFile, "Classement général\n");
+  fprintf(pFile, "Pos   Number     Driver                      Team                   Total points\n");
+  fprintf(pFile, "--------------------------------------------------------------------------------\n");
+
+  pStandingsTableItem = (StandingsTableItem *)pCtx->standingsTable.pItems;
+  for (i = 0; i < MAX_DRIVERS; i++) {
+    carId = pStandingsTableItem->carId;
+    pDriver = &pCtx->pDrivers[carId];
+    fprintf(pFile, "%3d  %5s    %-20.20s   %-30.30s   %5s\n", i + 1, pDriver->pNumber, pDriver->pName, pDriver->pTeam,
+            pointsToString(pStandingsTableItem->points, pPoints, sizeof(pPoints)));
+    pStandingsTableItem++;
+  }
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static int referenceSaveConstructors(Context *pCtx, FILE *pFile) {
+  ConstructorsTableItem *pConstructorsTableItem;
+  char pPoints[16];
+  int i;
+
+  fprintf(pFile, "\n\n");
+  fprintf(pFile, "Classement des constructeurs\n");
+  fprintf(pFile, "Pos   Team                                      Total points\n");
+  fprintf(pFile, "------------------------------------------------------------\n");
+
+  pConstructorsTableItem = pCtx->constructorsTable.pItems;
+  for (i = 0; i < pCtx->constructorsTable.teams; i++) {
+    fprintf(pFile, "%3d   %-40.40s   %5s\n", i + 1, pCtx->ppTeamNames[pConstructorsTableItem->teamId],
+            pointsToString(pConstructorsTableItem->points, pPoints, sizeof(pPoints)));
+    pConstructorsTableItem++;
+  }
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static int referenceSaveGrandPrix(Context *pCtx, int grandPrixId, const char *pFileName) {
+  GrandPrix *pGrandPrix;
+  Race *pRace;
+  bool special;
+  const GrandPrixInfo *pGrandPrixInfo;
+  FILE *pFile;
+  int returnCode;
+  int code;
+  int i;
+
+  pGrandPrix = &pCtx->pGrandPrix[grandPrixId];
+  special = pGrandPrix->specialGP;
+  pGrandPrixInfo = &pCtx->pCalendar[grandPrixId];
+
+  pFile = fopen(pFileName, "w");
+  if (pFile == NULL) {
+    logger(log_ERROR, "an error has occurred while opening file %s for writing, errno=%d\n", pFileName, errno);
+    return RETURN_KO;
+  }
+
+  fprintf(pFile, "Championnat %d Formule 1 Grand Prix %s/%s\n", pCtx->gpYear, pGrandPrixInfo->pName,
+          pGrandPrixInfo->pCircuit);
+
+  returnCode = RETURN_OK;
+  code = RETURN_OK;
+
+  for (i = 0; i < (special ? 1 : 3); i++) {
+    pRace = &pGrandPrix->pPractices[i];
+    if (pRace->type == race_ERROR) {
+      goto referenceSaveGrandPrixExit;
+    }
+    code = referenceSaveRace(pCtx, pFile, pRace);
+    if (code) {
+      returnCode = code;
+      goto referenceSaveGrandPrixExit;
+    }
+  }
+
+  if (special) {
+    for (i = 0; i < 3; i++) {
+      pRace = &pGrandPrix->pSprintShootout[i];
+      if (pRace->type == race_ERROR) {
+        goto referenceSaveGrandPrixExit;
+      }
+      code = referenceSaveRace(pCtx, pFile, pRace);
+      if (code) {
+        returnCode = code;
+        goto referenceSaveGrandPrixExit;
+      }
+    }
+
+    code = referenceSaveStartingGrid(pCtx, pFile, race_SPRINT, pGrandPrix->pSprintShootout);
+    if (code) {
+      returnCode = code;
+      goto referenceSaveGrandPrixExit;
+    }
+
+    pRace = &pGrandPrix->sprint;
+    if (pRace->type == race_ERROR) {
+      goto referenceSaveGrandPrixExit;
+    }
+    code = referenceSaveSprintOrFinal(pCtx, pFile, grandPrixId, pRace);
+    if (code) {
+      returnCode = code;
+      goto referenceSaveGrandPrixExit;
+    }
+  }
+
+  for (i = 0; i < 3; i++) {
+    pRace = &pGrandPrix->pQualifications[i];
+    if (pRace->type == race_ERROR) {
+      goto referenceSaveGrandPrixExit;
+    }
+    code = referenceSaveRace(pCtx, pFile, pRace);
+    if (code) {
+      returnCode = code;
+      goto referenceSaveGrandPrixExit;
+    }
+  }
+
+  code = referenceSaveStartingGrid(pCtx, pFile, race_GP, pGrandPrix->pQualifications);
+  if (code) {
+    returnCode = code;
+    goto referenceSaveGrandPrixExit;
+  }
+
+  pRace = &pGrandPrix->final;
+  if (pRace->type == race_ERROR) {
+    goto referenceSaveGrandPrixExit;
+  }
+  code = referenceSaveSprintOrFinal(pCtx, pFile, grandPrixId, pRace);
+  if (code) {
+    returnCode = code;
+    goto referenceSaveGrandPrixExit;
+  }
+
+referenceSaveGrandPrixExit:
+  if (code == RETURN_OK) {
+    referenceSaveStandings(pCtx, pFile);
+    referenceSaveConstructors(pCtx, pFile);
+  }
+
+  fclose(pFile);
+
+  return returnCode;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+double elapsedNanos(struct timespec *pStart) {
+  struct timespec end;
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  return (end.tv_sec - pStart->tv_sec) * 1e9 + (end.tv_nsec - pStart->tv_nsec);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int compareFiles(const char *pExpectedName, const char *pFileName) {
+  FILE *pExpected;
+  FILE *pFile;
+  int expected;
+  int value;
+  long offset;
+
+  pExpected = fopen(pExpectedName, "r");
+  pFile = fopen(pFileName, "r");
+  if (pExpected == NULL || pFile == NULL) {
+    printf("ERROR: unable to read %s or %s\n", pExpectedName, pFileName);
+    return 1;
+  }
+  offset = 0;
+  do {
+    expected = fgetc(pExpected);
+    value = fgetc(pFile);
+    offset++;
+  } while (expected == value && expected != EOF);
+  fclose(pFile);
+  fclose(pExpected);
+
+  if (expected != value) {
+    printf("ERROR: %s differs from %s at byte %ld\n", pFileName, pExpectedName, offset - 1);
+    return 1;
+  }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The season export writes the standings apart: pFileName followed by pStandingsName without its title line must
+// give the single Grand Prix report
+int compareSeasonReport(const char *pExpectedName, const char *pFileName, const char *pStandingsName) {
+  FILE *pExpected;
+  FILE *pFile;
+  FILE *pStandings;
+  int expected;
+  int value;
+  long offset;
+
+  pExpected = fopen(pExpectedName, "r");
+  pFile = fopen(pFileName, "r");
+  pStandings = fopen(pStandingsName, "r");
+  if (pExpected == NULL || pFile == NULL || pStandings == NULL) {
+    printf("ERROR: unable to read %s, %s or %s\n", pExpectedName, pFileName, pStandingsName);
+    return 1;
+  }
+  do {
+    value = fgetc(pStandings);
+  } while (value != '\n' && value != EOF);
+
+  offset = 0;
+  do {
+    expected = fgetc(pExpected);
+    value = fgetc(pFile);
+    if (value == EOF) {
+      value = fgetc(pStandings);
+    }
+    offset++;
+  } while (expected == value && expected != EOF);
+  fclose(pStandings);
+  fclose(pFile);
+  fclose(pExpected);
+
+  if (expected != value) {
+    printf("ERROR: %s and %s differ from %s at byte %ld\n", pFileName, pStandingsName, pExpectedName, offset - 1);
+    return 1;
+  }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int main(int argc, char *ppArgv[]) {
+  char pExpectedName[PATH_MAX];
+  char pFileName[PATH_MAX];
+  char pStandingsName[PATH_MAX];
+  struct timespec start;
+  ReportBuffer report;
+  GrandPrix *pGrandPrix;
+  Context ctx;
+  const char *pDriversName;
+  const char *pGrandPrixName;
+  const char *pOutputDir;
+  double referenceNs;
+  double reportNs;
+  double buildNs;
+  double seasonNs;
+  double singleNs;
+  size_t bytes;
+  int maxThreads;
+  int iterations;
+  int threads;
+  int drivers;
+  int errors;
+  int opt;
+  int n;
+  int i;
+
+  iterations = 20;
+  maxThreads = processorCores();
+  pDriversName = DRIVERS_FILENAME;
+  pGrandPrixName = GRANDPRIX_FILENAME;
+  pOutputDir = ".";
+  while ((opt = getopt(argc, ppArgv, "n:j:d:g:o:h?")) != -1) {
+    switch (opt) {
+    case 'n':
+      iterations = atoi(optarg);
+      break;
+    case 'j':
+      maxThreads = atoi(optarg);
+      break;
+    case 'd':
+      pDriversName = optarg;
+      break;
+    case 'g':
+      pGrandPrixName = optarg;
+      break;
+    case 'o':
+      pOutputDir = optarg;
+      break;
+    case 'h':
+    case '?':
+    default:
+      printf("Usage: benchReport [-n iterations] [-j threads] [-d drivers.csv] [-g grandPrix.csv] "
+             "[-o output directory]\n");
+      return EXIT_SUCCESS;
+    }
+  }
+  if (iterations < 1) {
+    iterations = 1;
+  }
+  if (maxThreads < 1) {
+    maxThreads = 1;
+  }
+
+  memset(&ctx, 0, sizeof(Context));
+  ctx.gpYear = BENCH_YEAR;
+  csvArenaInit(&ctx.driversArena, 0);
+  csvArenaInit(&ctx.grandPrixArena, 0);
+  if (schemaLoad(&driversSchema, pDriversName, ctx.pDrivers, MAX_DRIVERS, &drivers, &ctx.driversArena) != RETURN_OK ||
+      schemaLoad(&grandPrixSchema, pGrandPrixName, ctx.pCalendar, MAX_GP, &ctx.currentGP, &ctx.grandPrixArena) !=
+          RETURN_OK) {
+    printf("ERROR: unable to read %s or %s\n", pDriversName, pGrandPrixName);
+    return EXIT_FAILURE;
+  }
+  if (drivers != MAX_DRIVERS || ctx.currentGP == 0) {
+    printf("ERROR: %s must hold %d drivers and %s at least one Grand Prix\n", pDriversName, MAX_DRIVERS,
+           pGrandPrixName);
+    return EXIT_FAILURE;
+  }
+  if (loadScoringRules(&ctx, SCORING_FILENAME, NULL) != RETURN_OK) {
+    return EXIT_FAILURE;
+  }
+
+  // a whole season, the last Grand Prix stopped after its qualifications
+  ctx.pGrandPrix = (GrandPrix *)calloc(MAX_GP, sizeof(GrandPrix));
+  for (n = 0; n < ctx.currentGP; n++) {
+    pGrandPrix = &ctx.pGrandPrix[n];
+    pGrandPrix->grandPrixId = n;
+    pGrandPrix->specialGP = ctx.pCalendar[n].isSprint;
+    for (i = 0; i < 3; i++) {
+      fillRace(&pGrandPrix->pPractices[i], (RaceType)(race_P1 + i));
+      fillRace(&pGrandPrix->pQualifications[i], (RaceType)(race_Q1_GP + i));
+      if (pGrandPrix->specialGP) {
+        fillRace(&pGrandPrix->pSprintShootout[i], (RaceType)(race_Q1_SPRINT + i));
+      }
+    }
+    if (pGrandPrix->specialGP) {
+      fillRace(&pGrandPrix->sprint, race_SPRINT);
+    }
+    if (n < ctx.currentGP - 1) {
+      fillRace(&pGrandPrix->final, race_GP);
+    }
+  }
+  for (i = 0; i < MAX_DRIVERS; i++) {
+    ctx.standingsTable.pItems[i].carId = i;
+    ctx.standingsTable.pItems[i].points = (MAX_DRIVERS - i) * 37;
+    ctx.ppTeamNames[i / 2] = ctx.pDrivers[i * 2 % MAX_DRIVERS].pTeam;
+    ctx.constructorsTable.pItems[i / 2].teamId = i / 2;
+    ctx.constructorsTable.pItems[i / 2].points = (MAX_DRIVERS - i) * 71;
+  }
+  ctx.constructorsTable.teams = MAX_DRIVERS / 2;
+  for (n = 0; n < MAX_GP; n++) {
+    ctx.pGrandPrixVersions[n] = grandPrixVersion(&ctx.pGrandPrix[n]);
+  }
+
+  reportInit(&report);
+  referenceNs = reportNs = buildNs = 0;
+  bytes = 0;
+  errors = 0;
+  for (n = 0; n < iterations; n++) {
+    for (i = 0; i < ctx.currentGP; i++) {
+      snprintf(pExpectedName, sizeof(pExpectedName), "%s/benchReport_%d.ref.txt", pOutputDir, i + 1);
+      snprintf(pFileName, sizeof(pFileName), "%s/benchReport_%d.txt", pOutputDir, i + 1);
+
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      if (referenceSaveGrandPrix(&ctx, i, pExpectedName) != RETURN_OK) {
+        return EXIT_FAILURE;
+      }
+      referenceNs += elapsedNanos(&start);
+
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      reportReset(&report);
+      buildGrandPrixReport(&ctx, i, &report);
+      buildStandingsReport(&ctx, &report);
+      buildNs += elapsedNanos(&start);
+      if (reportWrite(&report, pFileName) != RETURN_OK) {
+        return EXIT_FAILURE;
+      }
+      reportNs += elapsedNanos(&start);
+      bytes += report.length;
+
+      // byte-exact compatibility, checked once
+      if (n == 0) {
+        errors += compareFiles(pExpectedName, pFileName);
+      }
+      if (n == iterations - 1) {
+        remove(pFileName);
+      }
+    }
+  }
+
+  if (errors > 0) {
+    printf("ERROR: %d reports differ from the fprintf() version\n", errors);
+    return EXIT_FAILURE;
+  }
+  printf("INFO: the %d reports are identical to the fprintf() version\n", ctx.currentGP);
+
+  printf("%-20s %14s %14s\n", "writer", "season us", "report us");
+  printf("%-20s %14.1f %14.1f\n", "fprintf", referenceNs / iterations / 1000,
+         referenceNs / iterations / ctx.currentGP / 1000);
+  printf("%-20s %14.1f %14.1f\n", "buffer", reportNs / iterations / 1000, reportNs / iterations / ctx.currentGP / 1000);
+  printf("%-20s %14.1f %14.1f\n", "buffer (build only)", buildNs / iterations / 1000,
+         buildNs / iterations / ctx.currentGP / 1000);
+  printf("%.1f KB per season, speedup %.1fx\n", (double)bytes / iterations / 1024, referenceNs / reportNs);
+
+  // the season export, standings formatted once and Grands Prix spread on the threads
+  singleNs = 0;
+  printf("%-20s %14s %14s\n", "export threads", "season us", "speedup");
+  for (threads = 1; threads <= maxThreads; threads *= 2) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (n = 0; n < iterations; n++) {
+      if (saveSeasonReports(&ctx, pOutputDir, threads, true) != RETURN_OK) {
+        return EXIT_FAILURE;
+      }
+    }
+    seasonNs = elapsedNanos(&start) / iterations;
+    if (threads == 1) {
+      singleNs = seasonNs;
+    }
+    printf("%-20d %14.1f %13.1fx\n", threads, seasonNs / 1000, singleNs / seasonNs);
+  }
+
+  // nothing stored since the last export: only the manifest is read and the standings formatted
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (n = 0; n < iterations; n++) {
+    if (saveSeasonReports(&ctx, pOutputDir, maxThreads, false) != RETURN_OK) {
+      return EXIT_FAILURE;
+    }
+  }
+  seasonNs = elapsedNanos(&start) / iterations;
+  printf("%-20s %14.1f %13.1fx\n", "unchanged", seasonNs / 1000, singleNs / seasonNs);
+
+  // one Grand Prix stored since the last export
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (n = 0; n < iterations; n++) {
+    ctx.pGrandPrixVersions[n % ctx.currentGP]++;
+    if (saveSeasonReports(&ctx, pOutputDir, maxThreads, false) != RETURN_OK) {
+      return EXIT_FAILURE;
+    }
+  }
+  seasonNs = elapsedNanos(&start) / iterations;
+  printf("%-20s %14.1f %13.1fx\n", "one Grand Prix", seasonNs / 1000, singleNs / seasonNs);
+
+  snprintf(pStandingsName, sizeof(pStandingsName), "%s/Standings_%d.txt", pOutputDir, BENCH_YEAR);
+  for (i = 0; i < ctx.currentGP; i++) {
+    snprintf(pExpectedName, sizeof(pExpectedName), "%s/benchReport_%d.ref.txt", pOutputDir, i + 1);
+    snprintf(pFileName, sizeof(pFileName), "%s/GrandPrix_%d_%d.txt", pOutputDir, BENCH_YEAR, i + 1);
+    errors += compareSeasonReport(pExpectedName, pFileName, pStandingsName);
+    remove(pExpectedName);
+    remove(pFileName);
+  }
+  remove(pStandingsName);
+  snprintf(pFileName, sizeof(pFileName), "%s/" REPORT_MANIFEST_FORMAT, pOutputDir, BENCH_YEAR);
+  remove(pFileName);
+  if (errors > 0) {
+    printf("ERROR: %d reports of the season export differ from the fprintf() version\n", errors);
+    return EXIT_FAILURE;
+  }
+  printf("INFO: the season export is identical to the fprintf() version\n");
+
+  reportFree(&report);
+  freeScoringRules(&ctx);
+  free(ctx.pGrandPrix);
+
+  return EXIT_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,198 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+
+#include "timeFormat.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define COLUMN_SIZE 20
+
+typedef int (*FormatFunction)(uint32_t timeMs, char *pOutput);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// snprintf() versions formerly used by timestampToHour(), timestampToMinute(), timestampToSecond() and milliToGap()
+int referenceHour(uint32_t timeMs, char *pOutput) {
+  int milli;
+  int second;
+  int minute;
+  int hour;
+
+  milli = timeMs % 1000;
+  timeMs /= 1000;
+  second = timeMs % 60;
+  timeMs /= 60;
+  minute = timeMs % 60;
+  hour = timeMs / 60;
+
+  return snprintf(pOutput, TIME_FORMAT_MAX, "%d:%02d:%02d.%03d", hour, minute, second, milli);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int referenceMinute(uint32_t timeMs, char *pOutput) {
+  int milli;
+  int second;
+  int minute;
+
+  milli = timeMs % 1000;
+  timeMs /= 1000;
+  second = timeMs % 60;
+  minute = timeMs / 60;
+
+  return snprintf(pOutput, TIME_FORMAT_MAX, "%d:%02d.%03d", minute, second, milli);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int referenceSecond(uint32_t timeMs, char *pOutput) {
+  return snprintf(pOutput, TIME_FORMAT_MAX, "%d.%03d", (int)(timeMs / 1000), (int)(timeMs % 1000));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int referenceGap(uint32_t timeMs, char *pOutput) {
+  return snprintf(pOutput, TIME_FORMAT_MAX, "+%d.%03ds", (int)(timeMs / 1000), (int)(timeMs % 1000));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static const char *const _ppFormatNames[] = {"hour", "minute", "second", "gap"};
+static const FormatFunction _pReferences[] = {referenceHour, referenceMinute, referenceSecond, referenceGap};
+static const FormatFunction _pKernels[] = {formatHour, formatMinute, formatSecond, formatGap};
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+double elapsedNanos(struct timespec *pStart) {
+  struct timespec end;
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  return (end.tv_sec - pStart->tv_sec) * 1e9 + (end.tv_nsec - pStart->tv_nsec);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int checkValue(int format, uint32_t timeMs) {
+  char pExpected[TIME_FORMAT_MAX];
+  char pOutput[TIME_FORMAT_MAX];
+  int expectedLength;
+  int length;
+
+  expectedLength = _pReferences[format](timeMs, pExpected);
+  length = _pKernels[format](timeMs, pOutput);
+  if (length != expectedLength || strcmp(pOutput, pExpected) != 0) {
+    printf("ERROR: %s format of %u gives '%s' instead of '%s'\n", _ppFormatNames[format], timeMs, pOutput, pExpected);
+    return 1;
+  }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int main(int argc, char *ppArgv[]) {
+  struct timespec start;
+  uint32_t *pTimes;
+  char *pColumn;
+  char pOutput[TIME_FORMAT_MAX];
+  double referenceNs;
+  double kernelNs;
+  double columnNs;
+  uint32_t timeMs;
+  uint64_t i;
+  int iterations;
+  int errors;
+  int format;
+  int opt;
+  int n;
+
+  iterations = 1000000;
+  while ((opt = getopt(argc, ppArgv, "n:h?")) != -1) {
+    switch (opt) {
+    case 'n':
+      iterations = atoi(optarg);
+      break;
+    case 'h':
+    case '?':
+    default:
+      printf("Usage: benchTimeFormat [-n iterations]\n");
+      return EXIT_SUCCESS;
+    }
+  }
+  if (iterations < 1) {
+    iterations = 1;
+  }
+
+  // byte-exact compatibility: every value up to 2 hours, then a sparse sweep of the whole 32 bits range
+  errors = 0;
+  for (format = 0; format < 4; format++) {
+    for (i = 0; i < 2 * 3600 * 1000 && errors < 10; i++) {
+      errors += checkValue(format, (uint32_t)i);
+    }
+    for (i = 0; i <= UINT32_MAX && errors < 10; i += 9973) {
+      errors += checkValue(format, (uint32_t)i);
+    }
+    errors += checkValue(format, UINT32_MAX);
+  }
+  if (errors > 0) {
+    printf("ERROR: %d differences with the snprintf() formats\n", errors);
+    return EXIT_FAILURE;
+  }
+  printf("INFO: output is identical to the snprintf() formats\n");
+
+  pTimes = (uint32_t *)malloc(sizeof(uint32_t) * iterations);
+  pColumn = (char *)malloc((size_t)COLUMN_SIZE * iterations);
+  if (pTimes == NULL || pColumn == NULL) {
+    printf("ERROR: unable to allocate %d times\n", iterations);
+    return EXIT_FAILURE;
+  }
+
+  srand(42);
+  for (n = 0; n < iterations; n++) {
+    pTimes[n] = (uint32_t)rand() % (3 * 3600 * 1000);
+  }
+
+  printf("%-8s %14s %14s %14s %8s\n", "format", "snprintf ns", "kernel ns", "column ns", "speedup");
+  for (format = 0; format < 4; format++) {
+    timeMs = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (n = 0; n < iterations; n++) {
+      _pReferences[format](pTimes[n], pOutput);
+      timeMs += (uint8_t)pOutput[1];
+    }
+    referenceNs = elapsedNanos(&start) / iterations;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (n = 0; n < iterations; n++) {
+      _pKernels[format](pTimes[n], pOutput);
+      timeMs += (uint8_t)pOutput[1];
+    }
+    kernelNs = elapsedNanos(&start) / iterations;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    formatTimeColumn((TimeFormat)format, pTimes, iterations, pColumn, COLUMN_SIZE);
+    columnNs = elapsedNanos(&start) / iterations;
+    timeMs += (uint8_t)pColumn[1];
+
+    printf("%-8s %14.1f %14.1f %14.1f %7.1fx\n", _ppFormatNames[format], referenceNs, kernelNs, columnNs,
+           referenceNs / kernelNs);
+  }
+
+  // keeps the loops from being optimized away
+  if (timeMs == 0) {
+    printf("\n");
+  }
+
+  free(pColumn);
+  free(pTimes);
+
+  return EXIT_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,600 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <assert.h>
+
+#include "capture.h"
+#include "util.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef WIN64
+#define SHUT_RDWR SD_BOTH
+#endif
+
+#define QUIT_POLL_INTERVAL_MS 200
+
+typedef struct structRenderThreadCtx {
+  Context *pCtx;
+  LiveRace *pLiveRace;
+  LeaderBoard *pLeaderBoard;
+  AcquireThreadCtx *pAcquireCtx;
+  LiveOutput *pOutput;
+} RenderThreadCtx;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef WIN64
+int compareCarStatus(void *pUserData, const void *pLeft, const void *pRight) {
+#else
+int compareCarStatus(const void *pLeft, const void *pRight, void *pUserData) {
+#endif
+  CarStatus *pCarStatus;
+  CarStatus *pCarA;
+  CarStatus *pCarB;
+  int compare;
+
+  pCarStatus = (CarStatus *)pUserData;
+  pCarA = &pCarStatus[*(int *)pLeft];
+  pCarB = &pCarStatus[*(int *)pRight];
+
+  if (pCarA->active && pCarB->active) {
+    compare = pCarB->segments - pCarA->segments;
+    if (compare == 0) {
+      compare = pCarA->totalLapsTime - pCarB->totalLapsTime;
+      if (compare == 0) {
+        compare = pCarA->cardId - pCarB->cardId;
+      }
+    }
+    return compare;
+  }
+
+  if (!pCarA->active && !pCarB->active) {
+    return pCarA->cardId - pCarB->cardId;
+  }
+  return pCarA->active ? -1 : 1;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef WIN64
+int compareCarStatusBestLap(void *pUserData, const void *pLeft, const void *pRight) {
+#else
+int compareCarStatusBestLap(const void *pLeft, const void *pRight, void *pUserData) {
+#endif
+  CarStatus *pCarStatus;
+  CarStatus *pCarA;
+  CarStatus *pCarB;
+
+  pCarStatus = (CarStatus *)pUserData;
+  pCarA = &pCarStatus[*(int *)pLeft];
+  pCarB = &pCarStatus[*(int *)pRight];
+
+  if (pCarA->active && pCarB->active) {
+    if (pCarA->bestLapTime == 0) {
+      if (pCarB->bestLapTime == 0) {
+        return pCarA->cardId - pCarB->cardId;
+      }
+      return 1;
+    }
+
+    if (pCarB->bestLapTime == 0) {
+      return -1;
+    }
+
+    return pCarA->bestLapTime - pCarB->bestLapTime;
+  }
+
+  if (!pCarA->active && !pCarB->active) {
+    return pCarA->cardId - pCarB->cardId;
+  }
+  return pCarA->active ? -1 : 1;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void sortLeaderBoard(LeaderBoard *pLeaderBoard) {
+  int *pSortIndices;
+  CarStatus *pCars;
+  bool bestLap;
+
+  pCars = pLeaderBoard->pCars;
+  pSortIndices = pLeaderBoard->pSortIndices;
+  bestLap = pLeaderBoard->type != race_SPRINT && pLeaderBoard->type != race_GP;
+#ifdef WIN64
+  if (bestLap) {
+    qsort_s(pSortIndices, pLeaderBoard->cars, sizeof(int), compareCarStatusBestLap, pCars);
+  } else {
+    qsort_s(pSortIndices, pLeaderBoard->cars, sizeof(int), compareCarStatus, pCars);
+  }
+#else
+  if (bestLap) {
+    qsort_r(pSortIndices, pLeaderBoard->cars, sizeof(int), compareCarStatusBestLap, pCars);
+  } else {
+    qsort_r(pSortIndices, pLeaderBoard->cars, sizeof(int), compareCarStatus, pCars);
+  }
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int processEvent(AcquireThreadCtx *pThreadCtx, EventRace *pEvent) {
+  CarStatus *pCar;
+
+  assert(pEvent->car >= 0 && pEvent->car < MAX_DRIVERS);
+
+  pCar = &pThreadCtx->pCarStatus[pEvent->car];
+  if (pCar->active == false) {
+    return RETURN_OK;
+  }
+
+  switch (pEvent->event) {
+  case event_ERROR:
+    logger(log_ERROR, "an illegal event was received\n");
+    return RETURN_KO;
+  case event_START:
+    pCar->currentLap = 0;
+    break;
+  case event_S1:
+    pCar->s1Time = pEvent->timestamp - pCar->lastSegmentTS;
+    if (pCar->bestS1Time == 0 || pCar->bestS1Time > pCar->s1Time) {
+      pCar->bestS1Time = pCar->s1Time;
+    }
+    pCar->s2Time = 0;
+    pCar->totalLapsTime += pCar->s1Time;
+    pCar->pitTime = 0;
+    pCar->lastSegmentTS = pEvent->timestamp;
+    pCar->segments++;
+    break;
+  case event_S2:
+    pCar->s2Time = pEvent->timestamp - pCar->lastSegmentTS;
+    if (pCar->bestS2Time == 0 || pCar->bestS2Time > pCar->s2Time) {
+      pCar->bestS2Time = pCar->s2Time;
+    }
+    pCar->s3Time = 0;
+    pCar->totalLapsTime += pCar->s2Time;
+    pCar->lastSegmentTS = pEvent->timestamp;
+    pCar->segments++;
+    break;
+  case event_S3:
+    pCar->s3Time = pEvent->timestamp - pCar->lastSegmentTS;
+    if (pCar->bestS3Time == 0 || pCar->bestS3Time > pCar->s3Time) {
+      pCar->bestS3Time = pCar->s3Time;
+    }
+    pCar->lastLapTime = pEvent->timestamp - pCar->startLapTimestamp;
+    if (pCar->bestLapTime == 0 || pCar->bestLapTime > pCar->lastLapTime) {
+      pCar->bestLapTime = pCar->lastLapTime;
+      pCar->bestLap = pCar->currentLap;
+    }
+    pCar->s1Time = 0;
+    pCar->currentLap = pEvent->lap + 1;
+    pCar->startLapTimestamp = pEvent->timestamp;
+    pCar->totalLapsTime += pCar->s3Time;
+    pCar->lastSegmentTS = pEvent->timestamp;
+    pCar->segments++;
+    break;
+  case event_OUT:
+    pCar->active = false;
+    break;
+  case event_END:
+    break;
+  case event_PIT_START:
+    break;
+  case event_PIT_END:
+    pCar->pits++;
+    pCar->pitTime = pEvent->timestamp - pCar->lastEventTS;
+    pCar->totalPitsTime += pCar->pitTime;
+    break;
+  }
+
+  pCar->lastEvent = pEvent->event;
+  pCar->lastEventTS = pEvent->timestamp;
+  pThreadCtx->pLiveRace->dirtyCars |= 1u << pEvent->car;
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int startListening(Context *pCtx, AcquireThreadCtx *pThreadCtx) {
+  struct sockaddr_in serverAddr;
+  const char *pListenAddress;
+  int optionValue;
+  int code;
+
+  pListenAddress = pCtx->pListenAddress != NULL ? pCtx->pListenAddress : DEFAULT_LISTEN_ADDRESS;
+
+  memset(&serverAddr, 0, sizeof(serverAddr));
+  serverAddr.sin_port = htons(pCtx->listenPort);
+  serverAddr.sin_family = AF_INET;
+  serverAddr.sin_addr.s_addr = inet_addr(pListenAddress);
+  if (serverAddr.sin_addr.s_addr == INADDR_NONE) {
+    logger(log_ERROR, "illegal listening address '%s'\n", pListenAddress);
+    return RETURN_KO;
+  }
+
+  pThreadCtx->serverSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (pThreadCtx->serverSocket == INVALID_SOCKET) {
+    logger(log_ERROR, "unable to allocate a new socket, code=%d\n", WSAGetLastError());
+    return RETURN_KO;
+  }
+
+  optionValue = 1;
+  code = setsockopt(pThreadCtx->serverSocket, SOL_SOCKET, SO_REUSEADDR, (const char *)&optionValue,
+                    sizeof(optionValue));
+  if (code == SOCKET_ERROR) {
+    logger(log_ERROR, "unable to set socket option SO_REUSEADDR, code=%d\n", WSAGetLastError());
+    goto startListeningException;
+  }
+
+  if (bind(pThreadCtx->serverSocket, (struct sockaddr *)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
+    logger(log_ERROR, "unable to bind listening address '%s:%d', code=%d\n", pListenAddress, pCtx->listenPort,
+           WSAGetLastError());
+    goto startListeningException;
+  }
+
+  if (listen(pThreadCtx->serverSocket, 1) == SOCKET_ERROR) {
+    logger(log_ERROR, "unable to start listening on address '%s:%d', code=%d\n", pListenAddress, pCtx->listenPort,
+           WSAGetLastError());
+    goto startListeningException;
+  }
+
+  logger(log_INFO, "listening for race events on %s:%d\n", pListenAddress, pCtx->listenPort);
+
+  return RETURN_OK;
+
+startListeningException:
+  closesocket(pThreadCtx->serverSocket);
+  pThreadCtx->serverSocket = INVALID_SOCKET;
+
+  return RETURN_KO;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int readFully(socket_t socket, void *pBuffer, int size) {
+  uint8_t *pRecvBuffer;
+  int bytesRead;
+  int code;
+
+  bytesRead = 0;
+  pRecvBuffer = (uint8_t *)pBuffer;
+
+  while (bytesRead < size) {
+    code = recv(socket, (char *)pRecvBuffer, size - bytesRead, 0);
+    if (code > 0) {
+      bytesRead += code;
+      pRecvBuffer += code;
+    } else if (code == 0) {
+      return 0;
+    } else {
+      return -1;
+    }
+  }
+
+  return bytesRead;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void *acquireData(void *pThreadArg) {
+  struct sockaddr_in clientAddr;
+  AcquireThreadCtx *pThreadCtx;
+  socklen_t clientAddrLength;
+  socket_t clientSocket;
+  LiveRace *pLiveRace;
+  RaceType expectedType;
+  EventRace event;
+  bool aborted;
+  int code;
+
+  pThreadCtx = (AcquireThreadCtx *)pThreadArg;
+  pLiveRace = pThreadCtx->pLiveRace;
+  expectedType = pThreadCtx->pCtx->pGrandPrix[pThreadCtx->pCtx->currentGP].nextStep;
+
+  clientAddrLength = sizeof(clientAddr);
+  clientSocket = accept(pThreadCtx->serverSocket, (struct sockaddr *)&clientAddr, &clientAddrLength);
+  // published under the mutex, so that requestAbort() either shuts it down or is seen here
+  pthread_mutex_lock(&pLiveRace->mutex);
+  aborted = pLiveRace->aborted;
+  if (!aborted) {
+    pThreadCtx->clientSocket = clientSocket;
+  }
+  pthread_mutex_unlock(&pLiveRace->mutex);
+  if (clientSocket == INVALID_SOCKET) {
+    if (!aborted) {
+      logger(log_ERROR, "unable to accept a new connection, code=%d\n", WSAGetLastError());
+      pThreadCtx->returnCode = RETURN_KO;
+    }
+    goto acquireDataExit;
+  }
+  if (aborted) {
+    closesocket(clientSocket);
+    goto acquireDataExit;
+  }
+
+  logger(log_INFO, "race events are received from %s\n", inet_ntoa(clientAddr.sin_addr));
+
+  while (true) {
+    code = readFully(clientSocket, &event, sizeof(event));
+    if (code <= 0) {
+      break;
+    }
+
+    if (event.car < 0 || event.car >= MAX_DRIVERS) {
+      logger(log_ERROR, "an event for illegal car %d was received\n", event.car);
+      continue;
+    }
+    if (event.type != expectedType) {
+      logger(log_ERROR, "an event for race '%s' was received while capturing race '%s'\n",
+             raceTypeToString(event.type), raceTypeToString(expectedType));
+      continue;
+    }
+
+    pthread_mutex_lock(&pLiveRace->mutex);
+    processEvent(pThreadCtx, &event);
+    pLiveRace->events++;
+    if (pLiveRace->pendingSinceUs == 0) {
+      pLiveRace->pendingSinceUs = monotonicMicros();
+    }
+    pthread_cond_signal(&pLiveRace->changed);
+    pthread_mutex_unlock(&pLiveRace->mutex);
+  }
+
+  // reset before the close, requestAbort() must not shut down a descriptor number reused meanwhile
+  pthread_mutex_lock(&pLiveRace->mutex);
+  pThreadCtx->clientSocket = INVALID_SOCKET;
+  pthread_mutex_unlock(&pLiveRace->mutex);
+  closesocket(clientSocket);
+
+acquireDataExit:
+  pthread_mutex_lock(&pLiveRace->mutex);
+  pLiveRace->finished = true;
+  pthread_cond_signal(&pLiveRace->changed);
+  pthread_mutex_unlock(&pLiveRace->mutex);
+
+  pThreadCtx->threadStillAlive = false;
+
+  return pThreadArg;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void updateRenderStats(RenderStats *pStats, uint64_t startUs, uint64_t endUs, uint64_t pendingSinceUs) {
+  uint32_t frameTime;
+  uint32_t latency;
+
+  frameTime = (uint32_t)(endUs - startUs);
+  pStats->frames++;
+  pStats->lastFrameTimeUs = frameTime;
+  pStats->totalFrameTimeUs += frameTime;
+  if (frameTime > pStats->maxFrameTimeUs) {
+    pStats->maxFrameTimeUs = frameTime;
+  }
+
+  if (pendingSinceUs != 0) {
+    latency = (uint32_t)(endUs - pendingSinceUs);
+    pStats->latencies++;
+    pStats->lastLatencyUs = latency;
+    pStats->totalLatencyUs += latency;
+    if (latency > pStats->maxLatencyUs) {
+      pStats->maxLatencyUs = latency;
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void requestAbort(RenderThreadCtx *pRenderCtx) {
+  AcquireThreadCtx *pAcquireCtx;
+
+  pAcquireCtx = pRenderCtx->pAcquireCtx;
+  pthread_mutex_lock(&pRenderCtx->pLiveRace->mutex);
+  pRenderCtx->pLiveRace->aborted = true;
+
+  // wakes up the acquisition thread blocked in accept() or recv(), the client socket is still open under the mutex
+  shutdown(pAcquireCtx->serverSocket, SHUT_RDWR);
+  if (pAcquireCtx->clientSocket != INVALID_SOCKET) {
+    shutdown(pAcquireCtx->clientSocket, SHUT_RDWR);
+  }
+  pthread_mutex_unlock(&pRenderCtx->pLiveRace->mutex);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void *renderLeaderBoard(void *pThreadArg) {
+  RenderThreadCtx *pRenderCtx;
+  LeaderBoard *pLeaderBoard;
+  struct timespec deadline;
+  uint64_t pendingSinceUs;
+  uint64_t nextFrameUs;
+  uint64_t frameUs;
+  uint64_t startUs;
+  LiveOutput *pOutput;
+  LiveRace *pLiveRace;
+  Context *pCtx;
+  int code;
+
+  pRenderCtx = (RenderThreadCtx *)pThreadArg;
+  pCtx = pRenderCtx->pCtx;
+  pLiveRace = pRenderCtx->pLiveRace;
+  pLeaderBoard = pRenderCtx->pLeaderBoard;
+  pOutput = pRenderCtx->pOutput;
+  frameUs = 1000000 / pCtx->targetFps;
+  nextFrameUs = 0;
+
+  pthread_mutex_lock(&pLiveRace->mutex);
+  while (true) {
+    // sleeps until the acquisition thread reports a change: an idle board costs no CPU
+    while (pLiveRace->dirtyCars == 0 && !pLeaderBoard->fullRedraw && !pLiveRace->finished) {
+      if (pOutput->pQuitRequested == NULL) {
+        pthread_cond_wait(&pLiveRace->changed, &pLiveRace->mutex);
+        continue;
+      }
+
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_nsec += QUIT_POLL_INTERVAL_MS * 1000000L;
+      if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+      }
+      code = pthread_cond_timedwait(&pLiveRace->changed, &pLiveRace->mutex, &deadline);
+      if (code != 0 && !pLiveRace->aborted) {
+        pthread_mutex_unlock(&pLiveRace->mutex);
+        if (pOutput->pQuitRequested(pCtx, pOutput->pUserData)) {
+          requestAbort(pRenderCtx);
+        }
+        pthread_mutex_lock(&pLiveRace->mutex);
+      }
+    }
+    if (pLiveRace->dirtyCars == 0 && !pLeaderBoard->fullRedraw) {
+      break;
+    }
+
+    // too early for the next frame: let the events of the burst pile up and draw them all at once
+    startUs = monotonicMicros();
+    if (startUs < nextFrameUs && !pLiveRace->finished) {
+      pthread_mutex_unlock(&pLiveRace->mutex);
+      usleep((useconds_t)(nextFrameUs - startUs));
+      pthread_mutex_lock(&pLiveRace->mutex);
+    }
+
+    memcpy(pLeaderBoard->pCars, pLiveRace->pCars, sizeof(pLiveRace->pCars));
+    pLeaderBoard->dirtyCars |= pLiveRace->dirtyCars;
+    pendingSinceUs = pLiveRace->pendingSinceUs;
+    pLiveRace->dirtyCars = 0;
+    pLiveRace->pendingSinceUs = 0;
+    pthread_mutex_unlock(&pLiveRace->mutex);
+
+    startUs = monotonicMicros();
+    pOutput->pDrawFrame(pCtx, pLeaderBoard, pOutput->pUserData);
+    updateRenderStats(&pLeaderBoard->stats, startUs, monotonicMicros(), pendingSinceUs);
+    nextFrameUs = startUs + frameUs;
+
+    if (pOutput->pQuitRequested != NULL && pOutput->pQuitRequested(pCtx, pOutput->pUserData)) {
+      requestAbort(pRenderCtx);
+    }
+
+    pthread_mutex_lock(&pLiveRace->mutex);
+  }
+  pthread_mutex_unlock(&pLiveRace->mutex);
+
+  return pThreadArg;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int captureSession(Context *pCtx, LeaderBoard *pLeaderBoard, LiveOutput *pOutput) {
+  AcquireThreadCtx acquireThreadCtx;
+  RenderThreadCtx renderThreadCtx;
+  pthread_t acquireThreadId;
+  pthread_t renderThreadId;
+  RenderStats *pStats;
+  LiveRace liveRace;
+  int returnCode;
+  int code;
+  int i;
+
+  memset(&liveRace, 0, sizeof(liveRace));
+  for (i = 0; i < MAX_DRIVERS; i++) {
+    liveRace.pCars[i].cardId = i;
+    liveRace.pCars[i].active = true;
+  }
+  pthread_mutex_init(&liveRace.mutex, NULL);
+  pthread_cond_init(&liveRace.changed, NULL);
+
+  pLeaderBoard->grandPrixId = pCtx->currentGP;
+  pLeaderBoard->type = pCtx->pGrandPrix[pCtx->currentGP].nextStep;
+  pLeaderBoard->raceStartTime = time(NULL);
+  pLeaderBoard->cars = MAX_DRIVERS;
+  pLeaderBoard->lastEventTimestamp = 0;
+  pLeaderBoard->dirtyCars = 0;
+  pLeaderBoard->fullRedraw = true;
+  pLeaderBoard->events = 0;
+  memset(&pLeaderBoard->stats, 0, sizeof(pLeaderBoard->stats));
+  memcpy(pLeaderBoard->pCars, liveRace.pCars, sizeof(liveRace.pCars));
+  for (i = 0; i < MAX_DRIVERS; i++) {
+    pLeaderBoard->pSortIndices[i] = i;
+  }
+
+  memset(&acquireThreadCtx, 0, sizeof(acquireThreadCtx));
+  acquireThreadCtx.pCtx = pCtx;
+  acquireThreadCtx.pCarStatus = liveRace.pCars;
+  acquireThreadCtx.pLiveRace = &liveRace;
+  acquireThreadCtx.serverSocket = INVALID_SOCKET;
+  acquireThreadCtx.clientSocket = INVALID_SOCKET;
+  acquireThreadCtx.threadStillAlive = true;
+  acquireThreadCtx.returnCode = RETURN_OK;
+
+  code = startListening(pCtx, &acquireThreadCtx);
+  if (code) {
+    returnCode = code;
+    goto captureSessionExit;
+  }
+
+  renderThreadCtx.pCtx = pCtx;
+  renderThreadCtx.pLiveRace = &liveRace;
+  renderThreadCtx.pLeaderBoard = pLeaderBoard;
+  renderThreadCtx.pAcquireCtx = &acquireThreadCtx;
+  renderThreadCtx.pOutput = pOutput;
+  code = pthread_create(&renderThreadId, NULL, renderLeaderBoard, &renderThreadCtx);
+  if (code) {
+    logger(log_ERROR, "unable to create new thread to render the leaderboard, code=%d\n", code);
+    returnCode = RETURN_KO;
+    goto captureSessionExit1;
+  }
+
+  code = pthread_create(&acquireThreadId, NULL, acquireData, &acquireThreadCtx);
+  if (code) {
+    logger(log_ERROR, "unable to create new thread to capture data, code=%d\n", code);
+    pthread_mutex_lock(&liveRace.mutex);
+    liveRace.finished = true;
+    liveRace.aborted = true;
+    pthread_cond_signal(&liveRace.changed);
+    pthread_mutex_unlock(&liveRace.mutex);
+    pthread_join(renderThreadId, NULL);
+    returnCode = RETURN_KO;
+    goto captureSessionExit1;
+  }
+
+  pthread_join(acquireThreadId, NULL);
+  pthread_join(renderThreadId, NULL);
+
+  // the last frame may have been skipped by the output, the final order is computed on the final state
+  memcpy(pLeaderBoard->pCars, liveRace.pCars, sizeof(liveRace.pCars));
+  sortLeaderBoard(pLeaderBoard);
+  pLeaderBoard->events = liveRace.events;
+
+  pStats = &pLeaderBoard->stats;
+  logger(log_INFO, "%d events rendered in %d frames, frame time avg=%uus max=%uus, latency avg=%uus max=%uus\n",
+         liveRace.events, pStats->frames,
+         pStats->frames > 0 ? (unsigned int)(pStats->totalFrameTimeUs / pStats->frames) : 0,
+         pStats->maxFrameTimeUs, pStats->latencies > 0 ? (unsigned int)(pStats->totalLatencyUs / pStats->latencies) : 0,
+         pStats->maxLatencyUs);
+
+  if (liveRace.aborted) {
+    logger(log_WARN, "capture of race '%s' was aborted\n", raceTypeToString(pLeaderBoard->type));
+    returnCode = RETURN_KO;
+  } else if (liveRace.events == 0) {
+    logger(log_WARN, "no event was received for race '%s'\n", raceTypeToString(pLeaderBoard->type));
+    returnCode = RETURN_KO;
+  } else {
+    returnCode = acquireThreadCtx.returnCode;
+  }
+
+captureSessionExit1:
+  closesocket(acquireThreadCtx.serverSocket);
+
+captureSessionExit:
+  pthread_cond_destroy(&liveRace.changed);
+  pthread_mutex_destroy(&liveRace.mutex);
+
+  return returnCode;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,306 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <dirent.h>
+
+#include "catalog.h"
+#include "historic.h"
+#include "util.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static int compareSeason(const void *pA, const void *pB) {
+  return ((Season *)pA)->year - ((Season *)pB)->year;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Maps every GrandPrix.<year>.bin of the working directory, with the driver numbers and the calendar it was stored with
+static int openSeasons(Catalog *pCatalog, uint32_t calendarCrc) {
+  HistoricHeader header;
+  struct dirent *pEntry;
+  Season *pSeason;
+  DIR *pDirectory;
+  char pSuffix[8];
+  int number;
+  int year;
+  int i;
+
+  pDirectory = opendir(".");
+  if (pDirectory == NULL) {
+    logger(log_ERROR, "unable to read the working directory, errno=%d\n", errno);
+    return RETURN_KO;
+  }
+
+  while ((pEntry = readdir(pDirectory)) != NULL) {
+    // "GrandPrix.2024.bin" but neither "GrandPrix.2024.bin.wal" nor "GrandPrix.2024.bin.tmp"
+    if (sscanf(pEntry->d_name, "GrandPrix.%d.%7s", &year, pSuffix) != 2 || strcmp(pSuffix, "bin") != 0) {
+      continue;
+    }
+    if (pCatalog->seasons == CATALOG_MAX_SEASONS) {
+      logger(log_WARN, "more than %d seasons, %s ignored\n", CATALOG_MAX_SEASONS, pEntry->d_name);
+      continue;
+    }
+
+    pSeason = &pCatalog->pSeasons[pCatalog->seasons];
+    if (openHistoricReadOnly(pEntry->d_name, year, &pSeason->pGrandPrix, &header) != RETURN_OK) {
+      continue;
+    }
+    pSeason->year = year;
+    pSeason->hasDrivers = header.calendarCrc != 0;
+    pSeason->hasCalendar = header.calendarCrc == calendarCrc;
+    for (i = 0; i < MAX_DRIVERS; i++) {
+      number = header.pCarNumbers[i];
+      pSeason->pCarNumbers[i] = number < CATALOG_MAX_NUMBER ? number : 0;
+    }
+    if (!pSeason->hasDrivers) {
+      logger(log_WARN, "%s has no recorded driver numbers, run it once with its configuration to index it\n",
+             pEntry->d_name);
+    } else if (!pSeason->hasCalendar) {
+      logger(log_INFO, "%s was run with another calendar, left out of the circuit index\n", pEntry->d_name);
+    }
+    pCatalog->seasons++;
+  }
+  closedir(pDirectory);
+
+  qsort(pCatalog->pSeasons, pCatalog->seasons, sizeof(Season), compareSeason);
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Counting sort of the sessions on a key: pStarts gets the first position of each key, pIndex the session indices.
+// The sessions of key -1 are left out.
+static void buildIndex(Catalog *pCatalog, const int *pKeys, int keys, int *pStarts, int *pIndex) {
+  int i;
+
+  memset(pStarts, 0, sizeof(int) * (keys + 1));
+  for (i = 0; i < pCatalog->sessions; i++) {
+    if (pKeys[i] >= 0) {
+      pStarts[pKeys[i] + 1]++;
+    }
+  }
+  for (i = 0; i < keys; i++) {
+    pStarts[i + 1] += pStarts[i];
+  }
+
+  // pStarts[key] is used as the insertion point, then shifted back by one key
+  for (i = 0; i < pCatalog->sessions; i++) {
+    if (pKeys[i] >= 0) {
+      pIndex[pStarts[pKeys[i]]++] = i;
+    }
+  }
+  memmove(pStarts + 1, pStarts, sizeof(int) * keys);
+  pStarts[0] = 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The carIds of each session are turned into driver numbers with the ones of its season
+static int buildDriverIndex(Catalog *pCatalog) {
+  const SessionRef *pSession;
+  const RaceInfo *pItem;
+  const Season *pSeason;
+  int *pStarts;
+  int number;
+  int total;
+  int i;
+  int j;
+
+  pStarts = pCatalog->pDriverStarts;
+  memset(pStarts, 0, sizeof(pCatalog->pDriverStarts));
+  total = 0;
+  for (i = 0; i < pCatalog->sessions; i++) {
+    pSeason = &pCatalog->pSeasons[pCatalog->pSessions[i].season];
+    if (!pSeason->hasDrivers) {
+      continue;
+    }
+    pItem = pCatalog->pSessions[i].pRace->pItems;
+    for (j = 0; j < MAX_DRIVERS; j++, pItem++) {
+      if (pItem->carId >= 0 && pItem->carId < MAX_DRIVERS) {
+        pStarts[pSeason->pCarNumbers[pItem->carId] + 1]++;
+        total++;
+      }
+    }
+  }
+  for (i = 0; i < CATALOG_MAX_NUMBER; i++) {
+    pStarts[i + 1] += pStarts[i];
+  }
+
+  pCatalog->pByDriver = (ResultRef *)malloc(sizeof(ResultRef) * (total + 1));
+  if (pCatalog->pByDriver == NULL) {
+    logger(log_FATAL, "unable to allocate %d bytes for the driver index.\n", (int)sizeof(ResultRef) * (total + 1));
+    return RETURN_KO;
+  }
+
+  for (i = 0; i < pCatalog->sessions; i++) {
+    pSession = &pCatalog->pSessions[i];
+    pSeason = &pCatalog->pSeasons[pSession->season];
+    if (!pSeason->hasDrivers) {
+      continue;
+    }
+    pItem = pSession->pRace->pItems;
+    for (j = 0; j < MAX_DRIVERS; j++, pItem++) {
+      if (pItem->carId >= 0 && pItem->carId < MAX_DRIVERS) {
+        number = pSeason->pCarNumbers[pItem->carId];
+        pCatalog->pByDriver[pStarts[number]].session = i;
+        pCatalog->pByDriver[pStarts[number]].position = j + 1;
+        pStarts[number]++;
+      }
+    }
+  }
+  memmove(pStarts + 1, pStarts, sizeof(int) * CATALOG_MAX_NUMBER);
+  pStarts[0] = 0;
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int catalogOpen(Context *pCtx, Catalog *pCatalog) {
+  const GrandPrix *pGrandPrix;
+  const Race *pRaces;
+  SessionRef *pSession;
+  int *pKeys;
+  int number;
+  int season;
+  int code;
+  int gp;
+  int i;
+  int j;
+
+  memset(pCatalog, 0, sizeof(Catalog));
+  pKeys = NULL;
+  code = RETURN_KO;
+
+  // the circuits of the current calendar, shared by the seasons run with it
+  for (i = 0; i < MAX_GP; i++) {
+    for (j = 0; j < i; j++) {
+      if (strcmp(pCtx->pCalendar[i].pCircuit, pCtx->pCalendar[j].pCircuit) == 0) {
+        break;
+      }
+    }
+    pCatalog->pCircuits[i] = j;
+  }
+  for (i = 0; i < MAX_DRIVERS; i++) {
+    number = pCtx->pDrivers[i].number;
+    pCatalog->pCarNumbers[i] = number >= 0 && number < CATALOG_MAX_NUMBER ? number : 0;
+  }
+
+  if (openSeasons(pCatalog, historicCalendarCrc(pCtx)) != RETURN_OK) {
+    goto catalogOpenExit;
+  }
+
+  pCatalog->pSessions = (SessionRef *)malloc(sizeof(SessionRef) * (pCatalog->seasons * MAX_GP * RACES_PER_GP + 1));
+  pKeys = (int *)malloc(sizeof(int) * (pCatalog->seasons * MAX_GP * RACES_PER_GP + 1));
+  if (pCatalog->pSessions == NULL || pKeys == NULL) {
+    logger(log_FATAL, "unable to allocate the sessions of %d seasons.\n", pCatalog->seasons);
+    goto catalogOpenExit;
+  }
+
+  // a session is stored once fillHistoric() has set its type
+  for (season = 0; season < pCatalog->seasons; season++) {
+    pGrandPrix = pCatalog->pSeasons[season].pGrandPrix;
+    for (gp = 0; gp < MAX_GP; gp++, pGrandPrix++) {
+      if (pGrandPrix->nextStep == race_ERROR) {
+        break;
+      }
+      pRaces = pGrandPrix->pPractices;
+      for (i = 0; i < RACES_PER_GP; i++) {
+        if (pRaces[i].type <= race_ERROR || pRaces[i].type >= race_FINISHED) {
+          continue;
+        }
+        pSession = &pCatalog->pSessions[pCatalog->sessions++];
+        pSession->season = season;
+        pSession->grandPrixId = gp;
+        pSession->type = pRaces[i].type;
+        pSession->pRace = &pRaces[i];
+      }
+    }
+  }
+
+  pCatalog->pByType = (int *)malloc(sizeof(int) * (pCatalog->sessions + 1));
+  pCatalog->pByCircuit = (int *)malloc(sizeof(int) * (pCatalog->sessions + 1));
+  if (pCatalog->pByType == NULL || pCatalog->pByCircuit == NULL) {
+    logger(log_FATAL, "unable to allocate the indexes of %d sessions.\n", pCatalog->sessions);
+    goto catalogOpenExit;
+  }
+
+  for (i = 0; i < pCatalog->sessions; i++) {
+    pKeys[i] = pCatalog->pSessions[i].type;
+  }
+  buildIndex(pCatalog, pKeys, race_MAX, pCatalog->pTypeStarts, pCatalog->pByType);
+  for (i = 0; i < pCatalog->sessions; i++) {
+    pSession = &pCatalog->pSessions[i];
+    pKeys[i] = pCatalog->pSeasons[pSession->season].hasCalendar ? pCatalog->pCircuits[pSession->grandPrixId] : -1;
+  }
+  buildIndex(pCatalog, pKeys, MAX_GP, pCatalog->pCircuitStarts, pCatalog->pByCircuit);
+
+  code = buildDriverIndex(pCatalog);
+
+catalogOpenExit:
+  free(pKeys);
+  if (code != RETURN_OK) {
+    catalogClose(pCatalog);
+  }
+  return code;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void catalogClose(Catalog *pCatalog) {
+  int i;
+
+  for (i = 0; i < pCatalog->seasons; i++) {
+    closeHistoricReadOnly(pCatalog->pSeasons[i].pGrandPrix);
+  }
+  free(pCatalog->pSessions);
+  free(pCatalog->pByType);
+  free(pCatalog->pByCircuit);
+  free(pCatalog->pByDriver);
+  memset(pCatalog, 0, sizeof(Catalog));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+const int *catalogSessionsByType(const Catalog *pCatalog, RaceType type, int *pCount) {
+  if (type < 0 || type >= race_MAX || pCatalog->pByType == NULL) {
+    *pCount = 0;
+    return NULL;
+  }
+
+  *pCount = pCatalog->pTypeStarts[type + 1] - pCatalog->pTypeStarts[type];
+  return &pCatalog->pByType[pCatalog->pTypeStarts[type]];
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+const int *catalogSessionsByCircuit(const Catalog *pCatalog, int grandPrixId, int *pCount) {
+  int circuit;
+
+  if (grandPrixId < 0 || grandPrixId >= MAX_GP || pCatalog->pByCircuit == NULL) {
+    *pCount = 0;
+    return NULL;
+  }
+
+  circuit = pCatalog->pCircuits[grandPrixId];
+  *pCount = pCatalog->pCircuitStarts[circuit + 1] - pCatalog->pCircuitStarts[circuit];
+  return &pCatalog->pByCircuit[pCatalog->pCircuitStarts[circuit]];
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+const ResultRef *catalogResultsByDriver(const Catalog *pCatalog, int number, int *pCount) {
+  if (number < 0 || number >= CATALOG_MAX_NUMBER || pCatalog->pByDriver == NULL) {
+    *pCount = 0;
+    return NULL;
+  }
+
+  *pCount = pCatalog->pDriverStarts[number + 1] - pCatalog->pDriverStarts[number];
+  return &pCatalog->pByDriver[pCatalog->pDriverStarts[number]];
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
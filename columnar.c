@@ -0,0 +1,291 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifndef WIN64
+#include <sys/mman.h>
+#endif
+
+#include "columnar.h"
+#include "catalog.h"
+#include "util.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define ALIGN_COLUMN(size) (((size) + COLUMNS_ALIGNMENT - 1) & ~(size_t)(COLUMNS_ALIGNMENT - 1))
+
+#ifdef WIN64
+#define allocateBlock(size) _aligned_malloc(size, COLUMNS_ALIGNMENT)
+#define freeBlock(pBlock) _aligned_free(pBlock)
+#else
+#define allocateBlock(size) aligned_alloc(COLUMNS_ALIGNMENT, size)
+#define freeBlock(pBlock) free(pBlock)
+#endif
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Sets the column pointers inside pBlock, or only computes the size when pBlock is NULL
+static size_t layoutColumns(ResultColumns *pColumns, char *pBlock) {
+  uint8_t **ppBytes[] = {&pColumns->pGrandPrixId, &pColumns->pType, &pColumns->pPosition, &pColumns->pCarId};
+  uint32_t **ppWords[] = {&pColumns->pRaceTime, &pColumns->pBestLapTime, &pColumns->pBestS1, &pColumns->pBestS2,
+                          &pColumns->pBestS3,   &pColumns->pPits,        &pColumns->pPitsTime};
+  size_t offset;
+  size_t i;
+
+  offset = 0;
+  for (i = 0; i < sizeof(ppBytes) / sizeof(ppBytes[0]); i++) {
+    if (pBlock != NULL) {
+      *ppBytes[i] = (uint8_t *)(pBlock + offset);
+    }
+    offset += ALIGN_COLUMN(pColumns->rows * sizeof(uint8_t));
+  }
+  for (i = 0; i < sizeof(ppWords) / sizeof(ppWords[0]); i++) {
+    if (pBlock != NULL) {
+      *ppWords[i] = (uint32_t *)(pBlock + offset);
+    }
+    offset += ALIGN_COLUMN(pColumns->rows * sizeof(uint32_t));
+  }
+
+  return offset;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void indexGrandPrix(ResultColumns *pColumns) {
+  int gp;
+  int i;
+
+  i = 0;
+  for (gp = 0; gp < MAX_GP; gp++) {
+    pColumns->pGrandPrixStarts[gp] = i;
+    while (i < pColumns->rows && pColumns->pGrandPrixId[i] == gp) {
+      i++;
+    }
+  }
+  pColumns->pGrandPrixStarts[MAX_GP] = pColumns->rows;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int buildResultColumns(const GrandPrix *pGrandPrix, int year, ResultColumns *pColumns) {
+  const RaceInfo *pItem;
+  const Race *pRaces;
+  int row;
+  int gp;
+  int i;
+  int j;
+
+  memset(pColumns, 0, sizeof(ResultColumns));
+  pColumns->year = year;
+
+  // a session is stored once fillHistoric() has set its type
+  for (gp = 0; gp < MAX_GP; gp++) {
+    pRaces = pGrandPrix[gp].pPractices;
+    for (i = 0; i < RACES_PER_GP; i++) {
+      if (pRaces[i].type > race_ERROR && pRaces[i].type < race_FINISHED) {
+        pColumns->rows += MAX_DRIVERS;
+      }
+    }
+  }
+
+  pColumns->blockSize = layoutColumns(pColumns, NULL);
+  pColumns->pBlock = allocateBlock(pColumns->blockSize + COLUMNS_ALIGNMENT);
+  if (pColumns->pBlock == NULL) {
+    logger(log_FATAL, "unable to allocate %d bytes for result columns.\n", (int)pColumns->blockSize);
+    return RETURN_KO;
+  }
+  layoutColumns(pColumns, (char *)pColumns->pBlock);
+
+  row = 0;
+  for (gp = 0; gp < MAX_GP; gp++) {
+    pRaces = pGrandPrix[gp].pPractices;
+    for (i = 0; i < RACES_PER_GP; i++) {
+      if (pRaces[i].type <= race_ERROR || pRaces[i].type >= race_FINISHED) {
+        continue;
+      }
+      pItem = pRaces[i].pItems;
+      for (j = 0; j < MAX_DRIVERS; j++, pItem++, row++) {
+        pColumns->pGrandPrixId[row] = gp;
+        pColumns->pType[row] = pRaces[i].type;
+        pColumns->pPosition[row] = j + 1;
+        pColumns->pCarId[row] = pItem->carId;
+        pColumns->pRaceTime[row] = pItem->raceTime;
+        pColumns->pBestLapTime[row] = pItem->bestLapTime;
+        pColumns->pBestS1[row] = pItem->bestS1;
+        pColumns->pBestS2[row] = pItem->bestS2;
+        pColumns->pBestS3[row] = pItem->bestS3;
+        pColumns->pPits[row] = pItem->pits;
+        pColumns->pPitsTime[row] = pItem->pitsTime;
+      }
+    }
+  }
+  indexGrandPrix(pColumns);
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static uint32_t columnsHeaderCrc(const ColumnsHeader *pHeader) {
+  ColumnsHeader header;
+
+  header = *pHeader;
+  header.crc = 0;
+
+  return crc32Update(0, &header, sizeof(header));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int saveResultColumns(const ResultColumns *pColumns, const char *pFileName) {
+  ColumnsHeader header;
+  FILE *pFile;
+  int code;
+
+  memset(&header, 0, sizeof(header));
+  header.magic = COLUMNS_MAGIC;
+  header.version = COLUMNS_VERSION;
+  header.year = pColumns->year;
+  header.rows = pColumns->rows;
+  header.blockSize = pColumns->blockSize;
+  header.crc = columnsHeaderCrc(&header);
+
+  pFile = fopen(pFileName, "wb");
+  if (pFile == NULL) {
+    logger(log_ERROR, "unable to open file %s, errno=%d\n", pFileName, errno);
+    return RETURN_KO;
+  }
+
+  code = RETURN_OK;
+  if (fwrite(&header, sizeof(header), 1, pFile) != 1 ||
+      (pColumns->blockSize > 0 && fwrite(pColumns->pBlock, pColumns->blockSize, 1, pFile) != 1)) {
+    logger(log_ERROR, "an error has occurred while writing to file %s, errno=%d\n", pFileName, errno);
+    code = RETURN_KO;
+  }
+  if (fclose(pFile) != 0) {
+    code = RETURN_KO;
+  }
+
+  return code;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int mapResultColumns(const char *pFileName, ResultColumns *pColumns) {
+  ColumnsHeader header;
+  struct stat status;
+  void *pMapping;
+  int fileHandle;
+
+  memset(pColumns, 0, sizeof(ResultColumns));
+  fileHandle = open(pFileName, O_BINARY | O_RDONLY);
+  if (fileHandle == -1) {
+    logger(log_ERROR, "unable to open file %s, errno=%d\n", pFileName, errno);
+    return RETURN_KO;
+  }
+
+  if (read(fileHandle, &header, sizeof(header)) != sizeof(header) || header.magic != COLUMNS_MAGIC ||
+      header.version != COLUMNS_VERSION || header.crc != columnsHeaderCrc(&header)) {
+    logger(log_ERROR, "file %s is not a version %d columns file\n", pFileName, COLUMNS_VERSION);
+    goto mapResultColumnsError;
+  }
+  pColumns->rows = header.rows;
+  pColumns->year = header.year;
+  pColumns->blockSize = layoutColumns(pColumns, NULL);
+  if (pColumns->blockSize != header.blockSize || fstat(fileHandle, &status) == -1 ||
+      status.st_size != (off_t)(sizeof(header) + header.blockSize)) {
+    logger(log_ERROR, "file %s has an invalid size\n", pFileName);
+    goto mapResultColumnsError;
+  }
+
+#ifdef WIN64
+  pMapping = allocateBlock(status.st_size);
+  if (pMapping == NULL || lseek(fileHandle, 0, SEEK_SET) == -1 ||
+      read(fileHandle, pMapping, status.st_size) != status.st_size) {
+    logger(log_ERROR, "an error has occurred while reading file %s\n", pFileName);
+    freeBlock(pMapping);
+    goto mapResultColumnsError;
+  }
+#else
+  // the header is one alignment unit, so the columns stay aligned in the mapping
+  pMapping = mmap(NULL, status.st_size, PROT_READ, MAP_SHARED, fileHandle, 0);
+  if (pMapping == MAP_FAILED) {
+    logger(log_ERROR, "unable to map file %s, errno=%d\n", pFileName, errno);
+    goto mapResultColumnsError;
+  }
+  pColumns->mapped = true;
+#endif
+  close(fileHandle);
+
+  pColumns->pBlock = pMapping;
+  layoutColumns(pColumns, (char *)pMapping + sizeof(header));
+  indexGrandPrix(pColumns);
+
+  return RETURN_OK;
+
+mapResultColumnsError:
+  close(fileHandle);
+  memset(pColumns, 0, sizeof(ResultColumns));
+  return RETURN_KO;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void freeResultColumns(ResultColumns *pColumns) {
+#ifndef WIN64
+  if (pColumns->mapped) {
+    munmap(pColumns->pBlock, sizeof(ColumnsHeader) + pColumns->blockSize);
+  } else
+#endif
+  {
+    freeBlock(pColumns->pBlock);
+  }
+  memset(pColumns, 0, sizeof(ResultColumns));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The loops below have no branch so that the compiler can vectorize them
+void columnMinPerGrandPrix(const ResultColumns *pColumns, const uint32_t *pMetric, RaceType type,
+                           uint32_t pMin[MAX_GP]) {
+  const uint8_t *pType;
+  uint32_t value;
+  uint32_t min;
+  int gp;
+  int i;
+
+  pType = pColumns->pType;
+  for (gp = 0; gp < MAX_GP; gp++) {
+    min = UINT32_MAX;
+    for (i = pColumns->pGrandPrixStarts[gp]; i < pColumns->pGrandPrixStarts[gp + 1]; i++) {
+      value = (type == race_ERROR || pType[i] == type) && pMetric[i] != 0 ? pMetric[i] : UINT32_MAX;
+      min = value < min ? value : min;
+    }
+    pMin[gp] = min == UINT32_MAX ? 0 : min;
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void columnSumPerGrandPrix(const ResultColumns *pColumns, const uint32_t *pMetric, RaceType type,
+                           uint64_t pSum[MAX_GP]) {
+  const uint8_t *pType;
+  uint64_t sum;
+  int gp;
+  int i;
+
+  pType = pColumns->pType;
+  for (gp = 0; gp < MAX_GP; gp++) {
+    sum = 0;
+    for (i = pColumns->pGrandPrixStarts[gp]; i < pColumns->pGrandPrixStarts[gp + 1]; i++) {
+      sum += (type == race_ERROR || pType[i] == type) ? pMetric[i] : 0;
+    }
+    pSum[gp] = sum;
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -1,19 +1,81 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#ifndef WIN64
+#include <sys/mman.h>
+#endif
 
 #include "csvParser.h"
 
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Outcome of the parsing of a row of the buffer
+typedef enum enumCsvRowStatus {
+  csvRow_READY,
+  csvRow_END,
+  csvRow_PARTIAL, // the buffer ends inside the row, parsed again from its start once the next chunk is read
+  csvRow_ERROR
+} CsvRowStatus;
+
+// Part of the buffer parsed by one thread of csvParserGetBatches()
+typedef struct CsvChunk {
+  pthread_t threadId;
+  bool threaded;
+  CsvParser *pCsvParser;
+  size_t start; // offsets in the buffer of the parser
+  size_t end;
+  size_t quotes; // found by the counting pass between the evenly spaced offsets
+  size_t newLines;
+  int line; // line of the first row
+  int endLine;
+  bool last;
+  bool delimitOnly; // the quoted fields are unescaped by a second pass, once the cuts are known to be right
+  bool exact;       // the last row delimited ends at end, so the next chunk starts on a row
+  CsvRowBatch batch;
+  int rowsCapacity;
+  int fieldsCapacity;
+  char *pErrorMessage;
+} CsvChunk;
+
+typedef void *(*CsvChunkFunction)(void *pChunk);
+
 CsvRow *_csvParserGetRow(CsvParser *pCsvParser);
+bool _csvParserGrowScratch(CsvParser *pCsvParser);
+bool _csvParserGrowFields(CsvParser *pCsvParser);
+CsvRow *_csvParserAllocateRow(CsvParser *pCsvParser, int fields, size_t textSize);
 int _csvParserDelimiterIsAccepted(const char *pDelimiter);
 void _csvParserSetErrorMessage(CsvParser *pCsvParser, const char *pErrorMessage);
+void _csvParserSetSystemError(CsvParser *pCsvParser, const char *pAction);
+bool _csvParserMapFile(CsvParser *pCsvParser);
+void _csvParserUnmapFile(CsvParser *pCsvParser);
+bool _csvParserGrowSlices(CsvParser *pCsvParser);
+CsvRowStatus _csvParserParseSlices(CsvParser *pCsvParser, CsvSliceRow *pRow);
+CsvRowStatus _csvParserIndexSlices(CsvParser *pCsvParser, CsvSliceRow *pRow);
+CsvRowStatus _csvParserReadSliceHeader(CsvParser *pCsvParser);
+CsvRowStatus _csvParserNextSlices(CsvParser *pCsvParser, CsvSliceRow *pRow);
+int _csvParserForEachChunk(CsvParser *pCsvParser, CsvRowCallback callback, void *pUser);
+void _csvParserBufferString(CsvParser *pCsvParser);
+bool _csvParserHasBuffer(CsvParser *pCsvParser);
+int _csvParserChunks(CsvParser *pCsvParser, int threads);
+void _csvParserRunChunks(CsvChunk *pChunks, int chunks, CsvChunkFunction function);
+void *_csvParserCountChunk(void *pArgument);
+void *_csvParserDelimitChunk(void *pArgument);
+void *_csvParserUnquoteChunk(void *pArgument);
+void _csvParserSplitChunks(CsvParser *pCsvParser, CsvChunk *pChunks, int chunks);
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -28,6 +90,7 @@ CsvParser *csvParserCreate(const char *pFilePath, const char *pDelimiter, bool i
   }
   pCsvParser->isFirstLineHeader = isFirstLineHeader;
   pCsvParser->pErrorMessage = NULL;
+  pCsvParser->reachedEnd = false;
   if (pDelimiter == NULL) {
     pCsvParser->delimiter = ',';
   } else if (_csvParserDelimiterIsAccepted(pDelimiter)) {
@@ -40,6 +103,31 @@ CsvParser *csvParserCreate(const char *pFilePath, const char *pDelimiter, bool i
   pCsvParser->fromString = 0;
   pCsvParser->pCsvString = NULL;
   pCsvParser->csvStringIter = 0;
+  pCsvParser->pBuffer = NULL;
+  pCsvParser->bufferSize = 0;
+  pCsvParser->bufferIter = 0;
+  pCsvParser->mapped = false;
+  pCsvParser->moreInput = false;
+  pCsvParser->delimitOnly = false;
+  pCsvParser->chunkSize = CSV_CHUNK_SIZE;
+  pCsvParser->line = 1;
+  pCsvParser->pSlices = NULL;
+  pCsvParser->slicesCapacity = 0;
+  pCsvParser->sliceHeader.pFields = NULL;
+  pCsvParser->sliceHeader.fields = 0;
+  pCsvParser->sliceHeader.line = 0;
+  // without vector instructions, the byte per byte parsing is faster than indexing the buffer first
+  pCsvParser->structuralIndex = csvScanKernel() != csvScan_SCALAR;
+  csvScanInit(&pCsvParser->scan);
+  pCsvParser->pStructurals = NULL;
+  pCsvParser->structuralBase = 0;
+  pCsvParser->structuralCount = 0;
+  pCsvParser->structuralIter = 0;
+  pCsvParser->pScratch = NULL;
+  pCsvParser->scratchSize = 0;
+  pCsvParser->pFieldOffsets = NULL;
+  pCsvParser->fieldCapacity = 0;
+  pCsvParser->pArena = NULL;
 
   return pCsvParser;
 }
@@ -59,6 +147,29 @@ CsvParser *csvParserCreateFromString(const char *pCsvString, const char *pDelimi
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+CsvParser *csvParserCreateFromMapping(const char *pFilePath, const char *pDelimiter, bool isFirstLineHeader) {
+  CsvParser *pCsvParser;
+
+  pCsvParser = csvParserCreate(pFilePath, pDelimiter, isFirstLineHeader);
+  if (pFilePath != NULL) {
+    _csvParserMapFile(pCsvParser);
+  }
+  return pCsvParser;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+CsvParser *csvParserCreateFromBuffer(char *pBuffer, size_t size, const char *pDelimiter, bool isFirstLineHeader) {
+  CsvParser *pCsvParser;
+
+  pCsvParser = csvParserCreate(NULL, pDelimiter, isFirstLineHeader);
+  pCsvParser->pBuffer = pBuffer;
+  pCsvParser->bufferSize = size;
+  return pCsvParser;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
 void csvParserDestroy(CsvParser *pCsvParser) {
   if (pCsvParser == NULL) {
     return;
@@ -78,19 +189,75 @@ void csvParserDestroy(CsvParser *pCsvParser) {
   if (pCsvParser->pCsvString != NULL) {
     free(pCsvParser->pCsvString);
   }
+  if (pCsvParser->mapped) {
+    _csvParserUnmapFile(pCsvParser);
+  }
+  free(pCsvParser->pSlices);
+  free(pCsvParser->sliceHeader.pFields);
+  free(pCsvParser->pStructurals);
+  free(pCsvParser->pScratch);
+  free(pCsvParser->pFieldOffsets);
   free(pCsvParser);
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void csvParserDestroyRow(const CsvRow *pCsvRow) {
-  int i;
+  if (!pCsvRow->inArena) {
+    free((void *)pCsvRow);
+  }
+}
 
-  for (i = 0; i < pCsvRow->fields; i++) {
-    free(pCsvRow->ppFields[i]);
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void csvArenaInit(CsvArena *pArena, size_t blockSize) {
+  pArena->pBlocks = NULL;
+  pArena->blockSize = blockSize == 0 ? CSV_ARENA_BLOCK_SIZE : blockSize;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void *csvArenaAlloc(CsvArena *pArena, size_t size) {
+  CsvArenaBlock *pBlock;
+  size_t blockSize;
+  void *pData;
+
+  // the allocations stay aligned on the pointers and the sizes of the rows
+  size = (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+  pBlock = pArena->pBlocks;
+  if (pBlock == NULL || pBlock->used + size > pBlock->size) {
+    // a row larger than a block gets its own one
+    blockSize = size > pArena->blockSize ? size : pArena->blockSize;
+    pBlock = (CsvArenaBlock *)malloc(sizeof(CsvArenaBlock) + blockSize);
+    if (pBlock == NULL) {
+      return NULL;
+    }
+    pBlock->pNext = pArena->pBlocks;
+    pBlock->size = blockSize;
+    pBlock->used = 0;
+    pArena->pBlocks = pBlock;
+  }
+  pData = (char *)(pBlock + 1) + pBlock->used;
+  pBlock->used += size;
+  return pData;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void csvArenaFree(CsvArena *pArena) {
+  CsvArenaBlock *pBlock;
+
+  while (pArena->pBlocks != NULL) {
+    pBlock = pArena->pBlocks;
+    pArena->pBlocks = pBlock->pNext;
+    free(pBlock);
   }
-  free(pCsvRow->ppFields);
-  free((void *)pCsvRow);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void csvParserSetArena(CsvParser *pCsvParser, CsvArena *pArena) {
+  pCsvParser->pArena = pArena;
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
@@ -129,11 +296,293 @@ const char **csvParserGetFields(const CsvRow *pCsvRow) {
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-CsvRow *_csvParserGetRow(CsvParser *pCsvParser) {
-  int numRowRealloc = 0;
-  int acceptedFields = 64;
-  int acceptedCharsInField = 64;
+bool csvParserGetSlices(CsvParser *pCsvParser, CsvSliceRow *pRow) {
+  return _csvParserNextSlices(pCsvParser, pRow) == csvRow_READY;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void csvParserUseStructuralIndex(CsvParser *pCsvParser, bool enabled) {
+  pCsvParser->structuralIndex = enabled && pCsvParser->scan.invalid == SIZE_MAX;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+const CsvSliceRow *csvParserGetSliceHeader(CsvParser *pCsvParser) {
+  if (!pCsvParser->isFirstLineHeader) {
+    _csvParserSetErrorMessage(pCsvParser, "Cannot supply header, as current CsvParser object does not support header");
+    return NULL;
+  }
+  if (pCsvParser->sliceHeader.pFields == NULL && _csvParserReadSliceHeader(pCsvParser) != csvRow_READY) {
+    return NULL;
+  }
+  return &pCsvParser->sliceHeader;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void csvParserSetChunkSize(CsvParser *pCsvParser, size_t chunkSize) {
+  pCsvParser->chunkSize = chunkSize == 0 ? CSV_CHUNK_SIZE : chunkSize;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int csvParserForEach(CsvParser *pCsvParser, CsvRowCallback callback, void *pUser) {
+  CsvRowStatus status;
+  CsvSliceRow row;
+  int rows;
+
+  if (pCsvParser->pFilePath != NULL && !pCsvParser->mapped) {
+    return _csvParserForEachChunk(pCsvParser, callback, pUser);
+  }
+
+  // the whole text is already in memory
+  _csvParserBufferString(pCsvParser);
+  rows = 0;
+  while ((status = _csvParserNextSlices(pCsvParser, &row)) == csvRow_READY) {
+    rows++;
+    if (!callback(&row, pUser)) {
+      break;
+    }
+  }
+  return status == csvRow_ERROR ? -1 : rows;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The file is read in chunks of chunkSize bytes: the rows complete in a chunk are handed to the callback, the last one
+// is moved to the front and completed by the next read. The chunk only grows for a row longer than itself.
+int _csvParserForEachChunk(CsvParser *pCsvParser, CsvRowCallback callback, void *pUser) {
+  CsvRowStatus status;
+  CsvSliceRow row;
+  size_t capacity;
+  size_t kept;
+  ssize_t bytes;
+  char *pChunk;
+  int fileHandle;
+  int rows;
+
+  fileHandle = open(pCsvParser->pFilePath, O_BINARY | O_RDONLY);
+  if (fileHandle == -1) {
+    _csvParserSetSystemError(pCsvParser, "opening");
+    return -1;
+  }
+  capacity = pCsvParser->chunkSize;
+  pChunk = (char *)malloc(capacity);
+  if (pChunk == NULL) {
+    _csvParserSetErrorMessage(pCsvParser, "Unable to allocate the chunk of the CSV file");
+    close(fileHandle);
+    return -1;
+  }
+  // a window of separators indexed before may be smaller than the chunks
+  free(pCsvParser->pStructurals);
+  pCsvParser->pStructurals = NULL;
+  pCsvParser->pBuffer = pChunk;
+  pCsvParser->bufferSize = 0;
+  pCsvParser->bufferIter = 0;
+  rows = 0;
+
+  do {
+    kept = pCsvParser->bufferSize - pCsvParser->bufferIter;
+    memmove(pChunk, pChunk + pCsvParser->bufferIter, kept);
+    if (kept == capacity) {
+      capacity *= 2;
+      pChunk = (char *)realloc(pChunk, capacity);
+      if (pChunk == NULL) {
+        _csvParserSetErrorMessage(pCsvParser, "Unable to allocate the chunk of the CSV file");
+        free(pCsvParser->pBuffer);
+        rows = -1;
+        goto csvParserForEachChunkExit;
+      }
+    }
+    bytes = read(fileHandle, pChunk + kept, capacity - kept);
+    if (bytes == -1) {
+      _csvParserSetSystemError(pCsvParser, "reading");
+      free(pChunk);
+      rows = -1;
+      goto csvParserForEachChunkExit;
+    }
+    // until a read returns nothing, the last row of the chunk may go on in the file
+    pCsvParser->moreInput = bytes > 0;
+    pCsvParser->pBuffer = pChunk;
+    pCsvParser->bufferSize = kept + bytes;
+    pCsvParser->bufferIter = 0;
+    csvScanInit(&pCsvParser->scan);
+    pCsvParser->structuralBase = 0;
+    pCsvParser->structuralCount = 0;
+    pCsvParser->structuralIter = 0;
+
+    while ((status = _csvParserNextSlices(pCsvParser, &row)) == csvRow_READY) {
+      rows++;
+      if (!callback(&row, pUser)) {
+        break;
+      }
+    }
+  } while (status != csvRow_READY && status != csvRow_ERROR && pCsvParser->moreInput);
+  if (status == csvRow_ERROR) {
+    rows = -1;
+  }
+  free(pChunk);
+
+csvParserForEachChunkExit:
+  close(fileHandle);
+  pCsvParser->pBuffer = NULL;
+  pCsvParser->bufferSize = 0;
+  pCsvParser->bufferIter = 0;
+  pCsvParser->moreInput = false;
+  return rows;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+CsvRowBatch *csvParserGetBatches(CsvParser *pCsvParser, int threads, int *pBatches) {
+  CsvRowBatch *pResult;
+  CsvChunk *pChunks;
+  CsvRowStatus status;
+  int endLine;
+  int chunks;
+  int i;
+
+  *pBatches = 0;
+  if (!_csvParserHasBuffer(pCsvParser)) {
+    return NULL;
+  }
+  if (pCsvParser->isFirstLineHeader && pCsvParser->sliceHeader.pFields == NULL) {
+    status = _csvParserReadSliceHeader(pCsvParser);
+    if (status == csvRow_ERROR) {
+      return NULL;
+    }
+  }
+
+  chunks = _csvParserChunks(pCsvParser, threads);
+  pChunks = (CsvChunk *)calloc(chunks, sizeof(CsvChunk));
+  pResult = (CsvRowBatch *)calloc(chunks, sizeof(CsvRowBatch));
+  if (pChunks == NULL || pResult == NULL) {
+    _csvParserSetErrorMessage(pCsvParser, "Unable to allocate the chunks of the parallel parsing");
+    free(pChunks);
+    free(pResult);
+    return NULL;
+  }
+
+  if (chunks > 1) {
+    // the rows are only delimited first: when a chunk does not end on a row, a quote broke the parity, and the buffer
+    // is parsed again by one thread from its start, still untouched
+    _csvParserSplitChunks(pCsvParser, pChunks, chunks);
+    endLine = pChunks[chunks - 1].endLine;
+    _csvParserRunChunks(pChunks, chunks, _csvParserDelimitChunk);
+    i = 0;
+    while (i < chunks - 1 && pChunks[i].exact && pChunks[i].pErrorMessage == NULL) {
+      i++;
+    }
+    if (i == chunks - 1) {
+      _csvParserRunChunks(pChunks, chunks, _csvParserUnquoteChunk);
+      pChunks[chunks - 1].endLine = endLine;
+    } else {
+      for (i = 0; i < chunks; i++) {
+        free(pChunks[i].batch.pRows);
+        free(pChunks[i].batch.pFields);
+        free(pChunks[i].pErrorMessage);
+      }
+      memset(pChunks, 0, chunks * sizeof(CsvChunk));
+      chunks = 1;
+    }
+  }
+  if (chunks == 1) {
+    pChunks[0].pCsvParser = pCsvParser;
+    pChunks[0].start = pCsvParser->bufferIter;
+    pChunks[0].end = pCsvParser->bufferSize;
+    pChunks[0].line = pCsvParser->line;
+    pChunks[0].last = true;
+    _csvParserDelimitChunk(&pChunks[0]);
+  }
+
+  for (i = 0; i < chunks; i++) {
+    if (pChunks[i].pErrorMessage != NULL && pResult != NULL) {
+      _csvParserSetErrorMessage(pCsvParser, pChunks[i].pErrorMessage);
+      csvParserFreeBatches(pResult, 0);
+      pResult = NULL;
+    }
+  }
+  for (i = 0; i < chunks; i++) {
+    if (pResult != NULL) {
+      pResult[i] = pChunks[i].batch;
+    } else {
+      free(pChunks[i].batch.pRows);
+      free(pChunks[i].batch.pFields);
+    }
+    free(pChunks[i].pErrorMessage);
+  }
+  if (pResult != NULL) {
+    pCsvParser->bufferIter = pCsvParser->bufferSize;
+    pCsvParser->line = pChunks[chunks - 1].endLine;
+    *pBatches = chunks;
+  }
+  free(pChunks);
+  return pResult;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void csvParserFreeBatches(CsvRowBatch *pBatches, int batches) {
+  int i;
+
+  if (pBatches == NULL) {
+    return;
+  }
+  for (i = 0; i < batches; i++) {
+    free(pBatches[i].pRows);
+    free(pBatches[i].pFields);
+  }
+  free(pBatches);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int csvParserForEachParallel(CsvParser *pCsvParser, int threads, CsvRowCallback callback, void *pUser) {
+  CsvRowBatch *pBatches;
+  CsvRowStatus status;
+  CsvSliceRow row;
+  int batches;
+  int rows;
+  int b;
+  int r;
+
+  if (!_csvParserHasBuffer(pCsvParser)) {
+    return -1;
+  }
+  rows = 0;
+  if (_csvParserChunks(pCsvParser, threads) == 1) {
+    // the rows of a single chunk are handed as they are parsed, without any batch
+    while ((status = _csvParserNextSlices(pCsvParser, &row)) == csvRow_READY) {
+      rows++;
+      if (!callback(&row, pUser)) {
+        break;
+      }
+    }
+    return status == csvRow_ERROR ? -1 : rows;
+  }
 
+  pBatches = csvParserGetBatches(pCsvParser, threads, &batches);
+  if (pBatches == NULL) {
+    return -1;
+  }
+  for (b = 0; b < batches; b++) {
+    for (r = 0; r < pBatches[b].rows; r++) {
+      rows++;
+      if (!callback(&pBatches[b].pRows[r], pUser)) {
+        goto csvParserForEachParallelExit;
+      }
+    }
+  }
+
+csvParserForEachParallelExit:
+  csvParserFreeBatches(pBatches, batches);
+  return rows;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+CsvRow *_csvParserGetRow(CsvParser *pCsvParser) {
   if (pCsvParser->pFilePath == NULL && (!pCsvParser->fromString)) {
     _csvParserSetErrorMessage(pCsvParser, "Supplied CSV file path is NULL");
     return NULL;
@@ -161,11 +610,8 @@ CsvRow *_csvParserGetRow(CsvParser *pCsvParser) {
     }
   }
 
-  CsvRow *pCsvRow = (CsvRow *)malloc(sizeof(CsvRow));
-  pCsvRow->ppFields = (char **)malloc(acceptedFields * sizeof(char *));
-  pCsvRow->fields = 0;
   int fieldIter = 0;
-  char *currField = (char *)malloc(acceptedCharsInField);
+  size_t fieldStart = 0;
   int insideComplexField = 0;
   int currFieldCharIter = 0;
   int seriesOfQuotesLength = 0;
@@ -185,8 +631,7 @@ CsvRow *_csvParserGetRow(CsvParser *pCsvParser) {
     if (endOfFileIndicator) {
       if (currFieldCharIter == 0 && fieldIter == 0) {
         _csvParserSetErrorMessage(pCsvParser, "Reached EOF");
-        free(currField);
-        csvParserDestroyRow(pCsvRow);
+        pCsvParser->reachedEnd = true;
         return NULL;
       }
       currChar = '\n';
@@ -210,32 +655,26 @@ CsvRow *_csvParserGetRow(CsvParser *pCsvParser) {
     } else {
       seriesOfQuotesLength = 0;
     }
+    // room for one more character and the terminating NUL
+    if (fieldStart + currFieldCharIter + 2 > pCsvParser->scratchSize && !_csvParserGrowScratch(pCsvParser)) {
+      return NULL;
+    }
     if (isEndOfFile || ((currChar == pCsvParser->delimiter || currChar == '\n') && !insideComplexField)) {
-      currField[isLastCharQuote ? currFieldCharIter - 1 : currFieldCharIter] = 0;
-      pCsvRow->ppFields[fieldIter] = (char *)malloc(currFieldCharIter + 1);
-      strcpy(pCsvRow->ppFields[fieldIter], currField);
-      free(currField);
-      pCsvRow->fields++;
-      if (currChar == '\n') {
-        return pCsvRow;
+      if (fieldIter == pCsvParser->fieldCapacity && !_csvParserGrowFields(pCsvParser)) {
+        return NULL;
       }
-      if (pCsvRow->fields != 0 && pCsvRow->fields % acceptedFields == 0) {
-        pCsvRow->ppFields =
-            (char **)realloc(pCsvRow->ppFields, ((numRowRealloc + 2) * acceptedFields) * sizeof(char *));
-        numRowRealloc++;
+      pCsvParser->pFieldOffsets[fieldIter] = (int)fieldStart;
+      fieldStart += isLastCharQuote ? currFieldCharIter - 1 : currFieldCharIter;
+      pCsvParser->pScratch[fieldStart++] = 0;
+      fieldIter++;
+      if (currChar == '\n') {
+        return _csvParserAllocateRow(pCsvParser, fieldIter, fieldStart);
       }
-      acceptedCharsInField = 64;
-      currField = (char *)malloc(acceptedCharsInField);
       currFieldCharIter = 0;
-      fieldIter++;
       insideComplexField = 0;
     } else {
-      currField[currFieldCharIter] = currChar;
+      pCsvParser->pScratch[fieldStart + currFieldCharIter] = currChar;
       currFieldCharIter++;
-      if (currFieldCharIter == acceptedCharsInField - 1) {
-        acceptedCharsInField *= 2;
-        currField = (char *)realloc(currField, acceptedCharsInField);
-      }
     }
     isLastCharQuote = (currChar == '\"');
   }
@@ -243,6 +682,828 @@ CsvRow *_csvParserGetRow(CsvParser *pCsvParser) {
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+bool _csvParserGrowScratch(CsvParser *pCsvParser) {
+  size_t size;
+  char *pScratch;
+
+  size = pCsvParser->scratchSize == 0 ? 256 : pCsvParser->scratchSize * 2;
+  pScratch = (char *)realloc(pCsvParser->pScratch, size);
+  if (pScratch == NULL) {
+    _csvParserSetErrorMessage(pCsvParser, "Unable to allocate the fields of a row");
+    return false;
+  }
+  pCsvParser->pScratch = pScratch;
+  pCsvParser->scratchSize = size;
+  return true;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool _csvParserGrowFields(CsvParser *pCsvParser) {
+  int capacity;
+  int *pOffsets;
+
+  capacity = pCsvParser->fieldCapacity == 0 ? 64 : pCsvParser->fieldCapacity * 2;
+  pOffsets = (int *)realloc(pCsvParser->pFieldOffsets, capacity * sizeof(int));
+  if (pOffsets == NULL) {
+    _csvParserSetErrorMessage(pCsvParser, "Unable to allocate the fields of a row");
+    return false;
+  }
+  pCsvParser->pFieldOffsets = pOffsets;
+  pCsvParser->fieldCapacity = capacity;
+  return true;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Copies the textSize bytes of fields gathered in the scratch buffer in a single allocation
+CsvRow *_csvParserAllocateRow(CsvParser *pCsvParser, int fields, size_t textSize) {
+  CsvRow *pCsvRow;
+  size_t size;
+  char *pText;
+  int i;
+
+  size = sizeof(CsvRow) + fields * sizeof(char *) + textSize;
+  if (pCsvParser->pArena != NULL) {
+    pCsvRow = (CsvRow *)csvArenaAlloc(pCsvParser->pArena, size);
+  } else {
+    pCsvRow = (CsvRow *)malloc(size);
+  }
+  if (pCsvRow == NULL) {
+    _csvParserSetErrorMessage(pCsvParser, "Unable to allocate a row");
+    return NULL;
+  }
+
+  pCsvRow->ppFields = (char **)(pCsvRow + 1);
+  pCsvRow->fields = fields;
+  pCsvRow->inArena = pCsvParser->pArena != NULL;
+  pText = (char *)(pCsvRow->ppFields + fields);
+  memcpy(pText, pCsvParser->pScratch, textSize);
+  for (i = 0; i < fields; i++) {
+    pCsvRow->ppFields[i] = pText + pCsvParser->pFieldOffsets[i];
+  }
+  return pCsvRow;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Indexes the next window of the buffer: 1 when separators were found, 0 after the last one, -1 when the index stopped
+// on a quote inside a field
+static int _csvParserIndexWindow(CsvParser *pCsvParser) {
+  size_t size;
+
+  pCsvParser->structuralIter = 0;
+  pCsvParser->structuralCount = 0;
+  while (pCsvParser->structuralCount == 0) {
+    if (pCsvParser->scan.scanned >= pCsvParser->bufferSize) {
+      return 0;
+    }
+    if (pCsvParser->scan.invalid != SIZE_MAX) {
+      return -1;
+    }
+    if (pCsvParser->pStructurals == NULL) {
+      // the chunks of csvParserForEach() may grow, a whole window is indexed for them
+      size = pCsvParser->bufferSize < CSV_SCAN_WINDOW && !pCsvParser->moreInput ? pCsvParser->bufferSize
+                                                                                 : CSV_SCAN_WINDOW;
+      pCsvParser->pStructurals = (uint32_t *)malloc(size * sizeof(uint32_t));
+      if (pCsvParser->pStructurals == NULL) {
+        return -1;
+      }
+    }
+    pCsvParser->structuralBase = pCsvParser->scan.scanned;
+    pCsvParser->structuralCount = csvScanIndex(&pCsvParser->scan, pCsvParser->pBuffer, pCsvParser->bufferSize,
+                                               pCsvParser->delimiter, pCsvParser->pStructurals);
+  }
+  return 1;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Drops the quotes of a delimited field and unescapes its "" in place. The text following the closing quote is kept
+// with that quote, as the row parser does.
+static inline void _csvParserUnquote(CsvSlice *pField, int *pLine) {
+  char *pCursor;
+  char *pQuote;
+  char *pWrite;
+  char *pEnd;
+  int quotes;
+
+  pCursor = pField->pData + 1;
+  pEnd = pField->pData + pField->length;
+  pField->pData = pCursor;
+
+  while ((pQuote = (char *)memchr(pCursor, '\n', pEnd - pCursor)) != NULL) {
+    (*pLine)++;
+    pCursor = pQuote + 1;
+  }
+
+  // the content is moved back only once a "" has been met: the mapping is copy-on-write, its pages are only touched
+  // when the content has to move
+  pCursor = pWrite = pField->pData;
+  while (true) {
+    pQuote = (char *)memchr(pCursor, '\"', pEnd - pCursor);
+    if (pQuote == NULL) {
+      pQuote = pEnd;
+    }
+    if (pWrite != pCursor) {
+      memmove(pWrite, pCursor, pQuote - pCursor);
+    }
+    pWrite += pQuote - pCursor;
+    if (pQuote + 1 < pEnd && pQuote[1] == '\"') {
+      *pWrite++ = '\"';
+      pCursor = pQuote + 2;
+      continue;
+    }
+    pCursor = pQuote == pEnd ? pEnd : pQuote + 1;
+    break;
+  }
+  // text after the closing quote, read as the row parser does: the '\r' are skipped, a quote is kept unless it ends
+  // the field, and the second quote of a series stands for the first one
+  if (pCursor < pEnd) {
+    *pWrite++ = '\"';
+    quotes = 1;
+    for (; pCursor < pEnd; pCursor++) {
+      if (*pCursor == '\r') {
+        continue;
+      }
+      quotes = *pCursor == '\"' ? quotes + 1 : 0;
+      if (quotes > 0 && quotes % 2 == 0) {
+        pWrite--;
+      }
+      *pWrite++ = *pCursor;
+    }
+    if (quotes > 0) {
+      pWrite--;
+    }
+  }
+  pField->length = (int)(pWrite - pField->pData);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Common checks of the row parsers, csvRow_READY when a row can be read
+static inline CsvRowStatus _csvParserCheckSlices(CsvParser *pCsvParser) {
+  if (pCsvParser->pBuffer == NULL && pCsvParser->pErrorMessage != NULL) {
+    // the mapping failed
+    return csvRow_ERROR;
+  }
+  if (pCsvParser->delimiter == '\0') {
+    _csvParserSetErrorMessage(pCsvParser, "Supplied delimiter is not supported");
+    return csvRow_ERROR;
+  }
+  if (pCsvParser->bufferIter >= pCsvParser->bufferSize) {
+    if (!pCsvParser->moreInput) {
+      _csvParserSetErrorMessage(pCsvParser, "Reached EOF");
+      pCsvParser->reachedEnd = true;
+    }
+    return csvRow_END;
+  }
+  return csvRow_READY;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool _csvParserGrowSlices(CsvParser *pCsvParser) {
+  CsvSlice *pSlices;
+  int capacity;
+
+  capacity = pCsvParser->slicesCapacity == 0 ? 64 : pCsvParser->slicesCapacity * 2;
+  pSlices = (CsvSlice *)realloc(pCsvParser->pSlices, capacity * sizeof(CsvSlice));
+  if (pSlices == NULL) {
+    _csvParserSetErrorMessage(pCsvParser, "Unable to allocate the fields of a row");
+    return false;
+  }
+  pCsvParser->pSlices = pSlices;
+  pCsvParser->slicesCapacity = capacity;
+  return true;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Once the fields of the row are delimited: drops the '\r' ending the line, unquotes the quoted fields and moves on
+static inline void _csvParserFinishRow(CsvParser *pCsvParser, CsvSliceRow *pRow, int fields, bool quoted,
+                                       bool newLine, char *pNext) {
+  CsvSlice *pField;
+  int line;
+  int i;
+
+  // a quoted field drops all of its '\r' after the closing quote
+  pField = &pCsvParser->pSlices[fields - 1];
+  if (pField->length > 0 && pField->pData[pField->length - 1] == '\r' && pField->pData[0] != '\"') {
+    pField->length--;
+  }
+
+  line = pCsvParser->line;
+  pRow->line = line;
+  for (i = 0; quoted && !pCsvParser->delimitOnly && i < fields; i++) {
+    pField = &pCsvParser->pSlices[i];
+    if (pField->length > 0 && pField->pData[0] == '\"') {
+      _csvParserUnquote(pField, &line);
+    }
+  }
+  pCsvParser->line = line + newLine;
+  pCsvParser->bufferIter = pNext - pCsvParser->pBuffer;
+  pRow->pFields = pCsvParser->pSlices;
+  pRow->fields = fields;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The fields of the row are delimited by the structural index first, without touching the buffer, then unquoted. A row
+// reaching a quote opened inside a field is parsed again by _csvParserParseSlices(), as every following one.
+CsvRowStatus _csvParserIndexSlices(CsvParser *pCsvParser, CsvSliceRow *pRow) {
+  const uint32_t *pIndexEnd;
+  const uint32_t *pIndex;
+  CsvRowStatus status;
+  CsvSlice *pSlices;
+  CsvSlice *pField;
+  char *pCursor;
+  char *pBase;
+  char *pStop;
+  char *pEnd;
+  bool newLine;
+  bool quoted;
+  int capacity;
+  int fields;
+
+  status = _csvParserCheckSlices(pCsvParser);
+  if (status != csvRow_READY) {
+    return status;
+  }
+
+  // the index is read through locals, the parser fields could alias the slices written
+  pCursor = pCsvParser->pBuffer + pCsvParser->bufferIter;
+  pEnd = pCsvParser->pBuffer + pCsvParser->bufferSize;
+  pSlices = pCsvParser->pSlices;
+  capacity = pCsvParser->slicesCapacity;
+  pIndex = pCsvParser->pStructurals + pCsvParser->structuralIter;
+  pIndexEnd = pCsvParser->pStructurals + pCsvParser->structuralCount;
+  pBase = pCsvParser->pBuffer + pCsvParser->structuralBase;
+  fields = 0;
+  newLine = false;
+  quoted = false;
+
+  while (true) {
+    if (fields == capacity) {
+      if (!_csvParserGrowSlices(pCsvParser)) {
+        return csvRow_ERROR;
+      }
+      pSlices = pCsvParser->pSlices;
+      capacity = pCsvParser->slicesCapacity;
+    }
+
+    if (pIndex < pIndexEnd) {
+      pStop = pBase + *pIndex++;
+    } else {
+      switch (_csvParserIndexWindow(pCsvParser)) {
+      case 1:
+        pIndex = pCsvParser->pStructurals;
+        pIndexEnd = pIndex + pCsvParser->structuralCount;
+        pBase = pCsvParser->pBuffer + pCsvParser->structuralBase;
+        pStop = pBase + *pIndex++;
+        break;
+      case 0:
+        pStop = pEnd;
+        break;
+      default:
+        // nothing written to the buffer yet, the row is parsed again from its start
+        pCsvParser->structuralIndex = false;
+        return _csvParserParseSlices(pCsvParser, pRow);
+      }
+    }
+
+    pField = &pSlices[fields++];
+    pField->pData = pCursor;
+    pField->length = (int)(pStop - pCursor);
+    quoted |= pCursor < pStop && *pCursor == '\"';
+    if (pStop == pEnd) {
+      if (pCsvParser->moreInput) {
+        // the index of the window is left to the next chunk
+        return csvRow_PARTIAL;
+      }
+      pCursor = pEnd;
+      break;
+    }
+    pCursor = pStop + 1;
+    if (*pStop == '\n') {
+      newLine = true;
+      break;
+    }
+  }
+  pCsvParser->structuralIter = (int)(pIndex - pCsvParser->pStructurals);
+
+  _csvParserFinishRow(pCsvParser, pRow, fields, quoted, newLine, pCursor);
+  return csvRow_READY;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define CSV_ONES 0x0101010101010101ULL
+#define CSV_HIGHS 0x8080808080808080ULL
+
+// First delimiter or '\n' from pCursor, pEnd if none. Eight bytes are tested at once: a byte of word ^ pattern is
+// zero where the pattern byte is found, and (x - ONES) & ~x & HIGHS sets the high bit of the zero bytes.
+static inline char *_csvParserFindStop(char *pCursor, char *pEnd, char delimiter) {
+  uint64_t delimiters;
+  uint64_t newLines;
+  uint64_t word;
+  uint64_t found;
+
+  delimiters = CSV_ONES * (unsigned char)delimiter;
+  newLines = CSV_ONES * '\n';
+  // the first byte in memory is the lowest one of the word on little-endian processors only
+  while (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ && pEnd - pCursor >= 8) {
+    memcpy(&word, pCursor, 8);
+    found = ((word ^ delimiters) - CSV_ONES) & ~(word ^ delimiters) & CSV_HIGHS;
+    found |= ((word ^ newLines) - CSV_ONES) & ~(word ^ newLines) & CSV_HIGHS;
+    if (found != 0) {
+      // the lowest flagged byte is exact, the borrows only reach the bytes above it
+      return pCursor + (__builtin_ctzll(found) >> 3);
+    }
+    pCursor += 8;
+  }
+  while (pCursor < pEnd && *pCursor != delimiter && *pCursor != '\n') {
+    pCursor++;
+  }
+  return pCursor;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Same rules as _csvParserGetRow(): a field is quoted when it starts with a quote, "" stands for a quote inside it and
+// the text following the closing quote is kept. Only the '\r' ending a line is dropped. As with the index, the whole
+// row is delimited before the buffer is modified, a row cut by the end of a chunk is parsed again from its start.
+CsvRowStatus _csvParserParseSlices(CsvParser *pCsvParser, CsvSliceRow *pRow) {
+  CsvRowStatus status;
+  CsvSlice *pField;
+  char *pCursor;
+  char *pQuote;
+  char *pEnd;
+  char delimiter;
+  bool newLine;
+  bool quoted;
+  int fields;
+
+  status = _csvParserCheckSlices(pCsvParser);
+  if (status != csvRow_READY) {
+    return status;
+  }
+
+  delimiter = pCsvParser->delimiter;
+  pCursor = pCsvParser->pBuffer + pCsvParser->bufferIter;
+  pEnd = pCsvParser->pBuffer + pCsvParser->bufferSize;
+  fields = 0;
+  newLine = false;
+  quoted = false;
+
+  while (true) {
+    if (fields == pCsvParser->slicesCapacity && !_csvParserGrowSlices(pCsvParser)) {
+      return csvRow_ERROR;
+    }
+    pField = &pCsvParser->pSlices[fields++];
+    pField->pData = pCursor;
+
+    if (pCursor < pEnd && *pCursor == '\"') {
+      // the closing quote is the first one not followed by another
+      quoted = true;
+      pQuote = pCursor + 1;
+      while ((pQuote = (char *)memchr(pQuote, '\"', pEnd - pQuote)) != NULL && pQuote + 1 < pEnd &&
+             pQuote[1] == '\"') {
+        pQuote += 2;
+      }
+      pCursor = pQuote == NULL ? pEnd : pQuote + 1;
+    }
+    pCursor = _csvParserFindStop(pCursor, pEnd, delimiter);
+    pField->length = (int)(pCursor - pField->pData);
+
+    if (pCursor == pEnd) {
+      if (pCsvParser->moreInput) {
+        return csvRow_PARTIAL;
+      }
+      break;
+    }
+    if (*pCursor++ == '\n') {
+      newLine = true;
+      break;
+    }
+  }
+
+  _csvParserFinishRow(pCsvParser, pRow, fields, quoted, newLine, pCursor);
+  return csvRow_READY;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The header is kept for the whole parsing: its slices and their text are copied in one allocation, out of the buffer
+// that the next chunks overwrite
+CsvRowStatus _csvParserReadSliceHeader(CsvParser *pCsvParser) {
+  CsvRowStatus status;
+  CsvSliceRow header;
+  size_t textSize;
+  char *pText;
+  int i;
+
+  status = pCsvParser->structuralIndex ? _csvParserIndexSlices(pCsvParser, &header)
+                                       : _csvParserParseSlices(pCsvParser, &header);
+  if (status != csvRow_READY) {
+    return status;
+  }
+  textSize = 0;
+  for (i = 0; i < header.fields; i++) {
+    textSize += header.pFields[i].length;
+  }
+  pCsvParser->sliceHeader.pFields = (CsvSlice *)malloc(header.fields * sizeof(CsvSlice) + textSize);
+  if (pCsvParser->sliceHeader.pFields == NULL) {
+    _csvParserSetErrorMessage(pCsvParser, "Unable to allocate the header");
+    return csvRow_ERROR;
+  }
+  pText = (char *)(pCsvParser->sliceHeader.pFields + header.fields);
+  for (i = 0; i < header.fields; i++) {
+    memcpy(pText, header.pFields[i].pData, header.pFields[i].length);
+    pCsvParser->sliceHeader.pFields[i].pData = pText;
+    pCsvParser->sliceHeader.pFields[i].length = header.pFields[i].length;
+    pText += header.pFields[i].length;
+  }
+  pCsvParser->sliceHeader.fields = header.fields;
+  pCsvParser->sliceHeader.line = header.line;
+  return csvRow_READY;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The next row of the buffer, after the header
+CsvRowStatus _csvParserNextSlices(CsvParser *pCsvParser, CsvSliceRow *pRow) {
+  CsvRowStatus status;
+
+  if (pCsvParser->isFirstLineHeader && pCsvParser->sliceHeader.pFields == NULL) {
+    status = _csvParserReadSliceHeader(pCsvParser);
+    if (status != csvRow_READY) {
+      return status;
+    }
+  }
+  if (pCsvParser->structuralIndex) {
+    return _csvParserIndexSlices(pCsvParser, pRow);
+  }
+  return _csvParserParseSlices(pCsvParser, pRow);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _csvParserBufferString(CsvParser *pCsvParser) {
+  if (pCsvParser->fromString && pCsvParser->pBuffer == NULL && pCsvParser->pCsvString != NULL) {
+    pCsvParser->pBuffer = pCsvParser->pCsvString;
+    pCsvParser->bufferSize = strlen(pCsvParser->pCsvString);
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The parallel parsing needs the whole text in memory
+bool _csvParserHasBuffer(CsvParser *pCsvParser) {
+  _csvParserBufferString(pCsvParser);
+  if (pCsvParser->pFilePath != NULL && !pCsvParser->mapped) {
+    if (pCsvParser->pErrorMessage == NULL) {
+      _csvParserSetErrorMessage(pCsvParser, "Parallel parsing needs a mapped file or a buffer");
+    }
+    return false;
+  }
+  return true;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// One chunk per thread, but a chunk too small does not pay for its thread
+int _csvParserChunks(CsvParser *pCsvParser, int threads) {
+  size_t size;
+
+  if (threads < 1) {
+#ifdef _SC_NPROCESSORS_ONLN
+    threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#else
+    threads = 1;
+#endif
+  }
+  size = pCsvParser->bufferSize > pCsvParser->bufferIter ? pCsvParser->bufferSize - pCsvParser->bufferIter : 0;
+  if (size / CSV_PARALLEL_MIN_CHUNK < (size_t)threads) {
+    threads = (int)(size / CSV_PARALLEL_MIN_CHUNK);
+  }
+  return threads < 1 ? 1 : threads;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The first chunk is handled by the calling thread, as any chunk whose thread cannot be created
+void _csvParserRunChunks(CsvChunk *pChunks, int chunks, CsvChunkFunction function) {
+  int i;
+
+  for (i = 1; i < chunks; i++) {
+    pChunks[i].threaded = pthread_create(&pChunks[i].threadId, NULL, function, &pChunks[i]) == 0;
+  }
+  function(&pChunks[0]);
+  for (i = 1; i < chunks; i++) {
+    if (pChunks[i].threaded) {
+      pthread_join(pChunks[i].threadId, NULL);
+    } else {
+      function(&pChunks[i]);
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void *_csvParserCountChunk(void *pArgument) {
+  CsvBlockMasks masks;
+  CsvChunk *pChunk;
+  const char *pCursor;
+  const char *pEnd;
+  size_t newLines;
+  size_t quotes;
+
+  pChunk = (CsvChunk *)pArgument;
+  pCursor = pChunk->pCsvParser->pBuffer + pChunk->start;
+  pEnd = pChunk->pCsvParser->pBuffer + pChunk->end;
+  quotes = 0;
+  newLines = 0;
+  // the masks of the structural index, counted a block at a time
+  for (; pEnd - pCursor >= CSV_SCAN_BLOCK; pCursor += CSV_SCAN_BLOCK) {
+    csvScanClassify(pCursor, pChunk->pCsvParser->delimiter, &masks);
+    quotes += __builtin_popcountll(masks.quotes);
+    newLines += __builtin_popcountll(masks.newLines);
+  }
+  for (; pCursor < pEnd; pCursor++) {
+    quotes += *pCursor == '\"';
+    newLines += *pCursor == '\n';
+  }
+  pChunk->quotes = quotes;
+  pChunk->newLines = newLines;
+  return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The buffer is cut at evenly spaced offsets, then each cut is moved after the next newline outside the quotes: the
+// quotes counted before an offset tell whether it is inside a quoted field. The counts of the newlines give the line of
+// the first row of each chunk.
+void _csvParserSplitChunks(CsvParser *pCsvParser, CsvChunk *pChunks, int chunks) {
+  const char *pBuffer;
+  size_t newLines;
+  size_t offset;
+  size_t start;
+  size_t size;
+  bool inQuotes;
+  bool parity;
+  int line;
+  int i;
+
+  pBuffer = pCsvParser->pBuffer;
+  start = pCsvParser->bufferIter;
+  size = pCsvParser->bufferSize - start;
+  for (i = 0; i < chunks; i++) {
+    pChunks[i].pCsvParser = pCsvParser;
+    pChunks[i].start = start + size / chunks * i;
+    pChunks[i].end = i == chunks - 1 ? pCsvParser->bufferSize : start + size / chunks * (i + 1);
+  }
+  _csvParserRunChunks(pChunks, chunks, _csvParserCountChunk);
+
+  parity = false;
+  newLines = 0;
+  line = pCsvParser->line;
+  pChunks[0].line = line;
+  for (i = 1; i < chunks; i++) {
+    // the parity of the quotes before the evenly spaced offset, not the one left by the scan of the previous cut
+    parity ^= pChunks[i - 1].quotes & 1;
+    inQuotes = parity;
+    newLines += pChunks[i - 1].newLines;
+    line = pCsvParser->line + (int)newLines;
+    for (offset = pChunks[i].start; offset < pCsvParser->bufferSize; offset++) {
+      if (pBuffer[offset] == '\"') {
+        inQuotes = !inQuotes;
+      } else if (pBuffer[offset] == '\n') {
+        line++;
+        if (!inQuotes) {
+          offset++;
+          break;
+        }
+      }
+    }
+    // a row longer than a chunk leaves the previous one empty
+    if (offset < pChunks[i - 1].start) {
+      offset = pChunks[i - 1].start;
+      line = pChunks[i - 1].line;
+    }
+    pChunks[i - 1].end = offset;
+    pChunks[i].start = offset;
+    pChunks[i].line = line;
+  }
+  for (i = 0; i < chunks; i++) {
+    pChunks[i].last = i == chunks - 1;
+    pChunks[i].delimitOnly = true;
+  }
+  pChunks[chunks - 1].endLine = pCsvParser->line + (int)(newLines + pChunks[chunks - 1].newLines);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The rows of the chunk are delimited by a parser of its own, without touching the buffer
+void *_csvParserDelimitChunk(void *pArgument) {
+  CsvChunk *pChunk;
+  CsvParser *pCsvParser;
+  CsvRowStatus status;
+  CsvRowBatch *pBatch;
+  CsvSliceRow row;
+  void *pGrown;
+  int capacity;
+  int i;
+
+  pChunk = (CsvChunk *)pArgument;
+  pBatch = &pChunk->batch;
+  pCsvParser = csvParserCreateFromBuffer(pChunk->pCsvParser->pBuffer + pChunk->start, pChunk->end - pChunk->start,
+                                         NULL, false);
+  pCsvParser->delimiter = pChunk->pCsvParser->delimiter;
+  pCsvParser->structuralIndex = pChunk->pCsvParser->structuralIndex;
+  pCsvParser->moreInput = !pChunk->last;
+  pCsvParser->delimitOnly = pChunk->delimitOnly;
+  pCsvParser->line = pChunk->line;
+
+  while ((status = _csvParserNextSlices(pCsvParser, &row)) == csvRow_READY) {
+    if (pBatch->rows == pChunk->rowsCapacity) {
+      capacity = pChunk->rowsCapacity == 0 ? 1024 : pChunk->rowsCapacity * 2;
+      pGrown = realloc(pBatch->pRows, capacity * sizeof(CsvSliceRow));
+      if (pGrown == NULL) {
+        break;
+      }
+      pBatch->pRows = (CsvSliceRow *)pGrown;
+      pChunk->rowsCapacity = capacity;
+    }
+    if (pBatch->fields + row.fields > pChunk->fieldsCapacity) {
+      capacity = pChunk->fieldsCapacity == 0 ? 4096 : pChunk->fieldsCapacity * 2;
+      while (pBatch->fields + row.fields > capacity) {
+        capacity *= 2;
+      }
+      pGrown = realloc(pBatch->pFields, capacity * sizeof(CsvSlice));
+      if (pGrown == NULL) {
+        break;
+      }
+      pBatch->pFields = (CsvSlice *)pGrown;
+      pChunk->fieldsCapacity = capacity;
+    }
+    // the fields may still move, the pointers are set once the chunk is done
+    memcpy(pBatch->pFields + pBatch->fields, row.pFields, row.fields * sizeof(CsvSlice));
+    pBatch->pRows[pBatch->rows].pFields = NULL;
+    pBatch->pRows[pBatch->rows].fields = row.fields;
+    pBatch->pRows[pBatch->rows].line = row.line;
+    pBatch->rows++;
+    pBatch->fields += row.fields;
+  }
+
+  if (status == csvRow_READY) {
+    pChunk->pErrorMessage = strdup("Unable to allocate the rows of a chunk");
+  } else if (status == csvRow_ERROR) {
+    pChunk->pErrorMessage = strdup(pCsvParser->pErrorMessage);
+  }
+  pChunk->exact = status == csvRow_END;
+  pChunk->endLine = pCsvParser->line;
+  for (i = 0, capacity = 0; i < pBatch->rows; capacity += pBatch->pRows[i++].fields) {
+    pBatch->pRows[i].pFields = pBatch->pFields + capacity;
+  }
+  csvParserDestroy(pCsvParser);
+  return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Second pass once the cuts are known to be right: the quoted fields are unescaped and the lines numbered
+void *_csvParserUnquoteChunk(void *pArgument) {
+  CsvChunk *pChunk;
+  CsvSliceRow *pRow;
+  CsvSlice *pField;
+  int line;
+  int r;
+  int f;
+
+  pChunk = (CsvChunk *)pArgument;
+  line = pChunk->line;
+  for (r = 0; r < pChunk->batch.rows; r++) {
+    pRow = &pChunk->batch.pRows[r];
+    pRow->line = line;
+    for (f = 0; f < pRow->fields; f++) {
+      pField = &pRow->pFields[f];
+      if (pField->length > 0 && pField->pData[0] == '\"') {
+        _csvParserUnquote(pField, &line);
+      }
+    }
+    line++;
+  }
+  return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef WIN64
+
+// No mmap() with MinGW: the file is read in memory
+bool _csvParserMapFile(CsvParser *pCsvParser) {
+  struct stat status;
+  ssize_t bytes;
+  size_t size;
+  int fileHandle;
+
+  fileHandle = open(pCsvParser->pFilePath, O_BINARY | O_RDONLY);
+  if (fileHandle == -1 || fstat(fileHandle, &status) == -1) {
+    _csvParserSetSystemError(pCsvParser, "opening");
+    if (fileHandle != -1) {
+      close(fileHandle);
+    }
+    return false;
+  }
+  pCsvParser->bufferSize = status.st_size;
+  pCsvParser->pBuffer = (char *)malloc(status.st_size + 1);
+  if (pCsvParser->pBuffer == NULL) {
+    _csvParserSetErrorMessage(pCsvParser, "Unable to allocate the CSV file");
+    close(fileHandle);
+    return false;
+  }
+  for (size = 0; size < pCsvParser->bufferSize; size += bytes) {
+    bytes = read(fileHandle, pCsvParser->pBuffer + size, pCsvParser->bufferSize - size);
+    if (bytes <= 0) {
+      _csvParserSetSystemError(pCsvParser, "reading");
+      free(pCsvParser->pBuffer);
+      pCsvParser->pBuffer = NULL;
+      close(fileHandle);
+      return false;
+    }
+  }
+  close(fileHandle);
+  pCsvParser->mapped = true;
+  return true;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _csvParserUnmapFile(CsvParser *pCsvParser) {
+  free(pCsvParser->pBuffer);
+}
+
+#else
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Copy-on-write mapping: only the pages holding an unescaped field are copied, the file is never modified
+bool _csvParserMapFile(CsvParser *pCsvParser) {
+  struct stat status;
+  void *pMapping;
+  int fileHandle;
+
+  fileHandle = open(pCsvParser->pFilePath, O_BINARY | O_RDONLY);
+  if (fileHandle == -1 || fstat(fileHandle, &status) == -1) {
+    _csvParserSetSystemError(pCsvParser, "opening");
+    if (fileHandle != -1) {
+      close(fileHandle);
+    }
+    return false;
+  }
+  pCsvParser->bufferSize = status.st_size;
+  if (status.st_size == 0) {
+    // mmap() refuses an empty length, there is no row to read anyway
+    close(fileHandle);
+    pCsvParser->mapped = true;
+    return true;
+  }
+
+  pMapping = mmap(NULL, status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_POPULATE, fileHandle, 0);
+  close(fileHandle);
+  if (pMapping == MAP_FAILED) {
+    _csvParserSetSystemError(pCsvParser, "mapping");
+    return false;
+  }
+  madvise(pMapping, status.st_size, MADV_SEQUENTIAL);
+  pCsvParser->pBuffer = (char *)pMapping;
+  pCsvParser->mapped = true;
+  return true;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _csvParserUnmapFile(CsvParser *pCsvParser) {
+  if (pCsvParser->pBuffer != NULL) {
+    munmap(pCsvParser->pBuffer, pCsvParser->bufferSize);
+  }
+}
+
+#endif
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void _csvParserSetSystemError(CsvParser *pCsvParser, const char *pAction) {
+  const char *errStr = strerror(errno);
+  char *errMsg = (char *)malloc(1024 + strlen(errStr) + strlen(pCsvParser->pFilePath));
+  sprintf(errMsg, "Error %s CSV file: %s : %s", pAction, pCsvParser->pFilePath, errStr);
+  _csvParserSetErrorMessage(pCsvParser, errMsg);
+  free(errMsg);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
 int _csvParserDelimiterIsAccepted(const char *pDelimiter) {
   char delimiter;
 
@@ -270,6 +1531,12 @@ const char *csvParserGetErrorMessage(CsvParser *pCsvParser) {
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+bool csvParserReachedEnd(CsvParser *pCsvParser) {
+  return pCsvParser->reachedEnd;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,290 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CSV_SCAN_X86
+#endif
+
+#include "csvScan.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*CsvClassifyFunction)(const char *pBlock, char delimiter, CsvBlockMasks *pMasks);
+
+static pthread_once_t _csvScanOnce = PTHREAD_ONCE_INIT;
+static CsvScanKernel _csvScanKernel;
+static CsvClassifyFunction _csvClassify;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Bit i set when byte i of word equals the byte repeated in pattern: the high bit of each byte is set exactly for the
+// zero bytes of word ^ pattern (without borrow across bytes), then the eight high bits are gathered by a multiply
+static inline uint64_t matchBytes(uint64_t word, uint64_t pattern) {
+  uint64_t zeros;
+
+  word ^= pattern;
+  zeros = ~(((word & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | word | 0x7F7F7F7F7F7F7F7FULL);
+  return ((zeros >> 7) * 0x0102040810204080ULL) >> 56;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Eight bytes at a time in a 64 bits register, the bytes of the word in memory order on little-endian processors only
+static void classifyScalar(const char *pBlock, char delimiter, CsvBlockMasks *pMasks) {
+  uint64_t delimiters;
+  uint64_t quotes;
+  uint64_t newLines;
+  uint64_t word;
+  uint64_t bit;
+  int i;
+
+  pMasks->delimiters = 0;
+  pMasks->quotes = 0;
+  pMasks->newLines = 0;
+  if (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__) {
+    for (i = 0, bit = 1; i < CSV_SCAN_BLOCK; i++, bit <<= 1) {
+      pMasks->delimiters |= pBlock[i] == delimiter ? bit : 0;
+      pMasks->quotes |= pBlock[i] == '\"' ? bit : 0;
+      pMasks->newLines |= pBlock[i] == '\n' ? bit : 0;
+    }
+    return;
+  }
+
+  delimiters = 0x0101010101010101ULL * (unsigned char)delimiter;
+  quotes = 0x0101010101010101ULL * '\"';
+  newLines = 0x0101010101010101ULL * '\n';
+  for (i = 0; i < CSV_SCAN_BLOCK; i += 8) {
+    memcpy(&word, pBlock + i, 8);
+    pMasks->delimiters |= matchBytes(word, delimiters) << i;
+    pMasks->quotes |= matchBytes(word, quotes) << i;
+    pMasks->newLines |= matchBytes(word, newLines) << i;
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef CSV_SCAN_X86
+
+static void classifySse2(const char *pBlock, char delimiter, CsvBlockMasks *pMasks) {
+  __m128i delimiters;
+  __m128i quotes;
+  __m128i newLines;
+  __m128i bytes;
+  int i;
+
+  delimiters = _mm_set1_epi8(delimiter);
+  quotes = _mm_set1_epi8('\"');
+  newLines = _mm_set1_epi8('\n');
+  pMasks->delimiters = 0;
+  pMasks->quotes = 0;
+  pMasks->newLines = 0;
+  for (i = 0; i < CSV_SCAN_BLOCK; i += 16) {
+    bytes = _mm_loadu_si128((const __m128i *)(pBlock + i));
+    pMasks->delimiters |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, delimiters)) << i;
+    pMasks->quotes |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, quotes)) << i;
+    pMasks->newLines |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newLines)) << i;
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+__attribute__((target("avx2"))) static void classifyAvx2(const char *pBlock, char delimiter, CsvBlockMasks *pMasks) {
+  __m256i delimiters;
+  __m256i quotes;
+  __m256i newLines;
+  __m256i low;
+  __m256i high;
+
+  delimiters = _mm256_set1_epi8(delimiter);
+  quotes = _mm256_set1_epi8('\"');
+  newLines = _mm256_set1_epi8('\n');
+  low = _mm256_loadu_si256((const __m256i *)pBlock);
+  high = _mm256_loadu_si256((const __m256i *)(pBlock + 32));
+  pMasks->delimiters = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, delimiters)) |
+                       (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, delimiters)) << 32;
+  pMasks->quotes = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, quotes)) |
+                   (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, quotes)) << 32;
+  pMasks->newLines = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, newLines)) |
+                     (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, newLines)) << 32;
+}
+
+#endif
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static bool kernelSupported(CsvScanKernel kernel) {
+  switch (kernel) {
+  case csvScan_SCALAR:
+    return true;
+#ifdef CSV_SCAN_X86
+  case csvScan_SSE2:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+  case csvScan_AVX2:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+  default:
+    return false;
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void selectKernel(CsvScanKernel kernel) {
+  if (kernel == csvScan_AUTO || !kernelSupported(kernel)) {
+    kernel = kernelSupported(csvScan_AVX2) ? csvScan_AVX2 : kernelSupported(csvScan_SSE2) ? csvScan_SSE2
+                                                                                          : csvScan_SCALAR;
+  }
+
+  _csvScanKernel = kernel;
+  switch (kernel) {
+#ifdef CSV_SCAN_X86
+  case csvScan_AVX2:
+    _csvClassify = classifyAvx2;
+    break;
+  case csvScan_SSE2:
+    _csvClassify = classifySse2;
+    break;
+#endif
+  default:
+    _csvClassify = classifyScalar;
+    break;
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void selectDefaultKernel(void) {
+  selectKernel(csvScan_AUTO);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+CsvScanKernel csvScanSelect(CsvScanKernel kernel) {
+  // the automatic choice is made first, so that a later csvScanClassify() never overrides the forced one
+  pthread_once(&_csvScanOnce, selectDefaultKernel);
+  selectKernel(kernel);
+  return _csvScanKernel;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+CsvScanKernel csvScanKernel(void) {
+  pthread_once(&_csvScanOnce, selectDefaultKernel);
+  return _csvScanKernel;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+const char *csvScanKernelName(CsvScanKernel kernel) {
+  switch (kernel) {
+  case csvScan_SCALAR:
+    return "scalar";
+  case csvScan_SSE2:
+    return "sse2";
+  case csvScan_AVX2:
+    return "avx2";
+  default:
+    return "auto";
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void csvScanInit(CsvScanState *pState) {
+  pState->scanned = 0;
+  pState->invalid = SIZE_MAX;
+  pState->inQuotes = 0;
+  pState->afterStop = 1;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void csvScanClassify(const char *pBlock, char delimiter, CsvBlockMasks *pMasks) {
+  pthread_once(&_csvScanOnce, selectDefaultKernel);
+  _csvClassify(pBlock, delimiter, pMasks);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Bit i of the result is the parity of the bits 0 to i of mask: set from an opening quote to the byte before the
+// closing one. A "" inside a quoted field closes and opens it again, its bytes keep the parity of the field.
+static inline uint64_t prefixXor(uint64_t mask) {
+  mask ^= mask << 1;
+  mask ^= mask << 2;
+  mask ^= mask << 4;
+  mask ^= mask << 8;
+  mask ^= mask << 16;
+  mask ^= mask << 32;
+  return mask;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int csvScanIndex(CsvScanState *pState, const char *pData, size_t size, char delimiter, uint32_t *pIndexes) {
+  char pTail[CSV_SCAN_BLOCK];
+  CsvBlockMasks masks;
+  const char *pBlock;
+  uint64_t separators;
+  uint64_t inside;
+  uint64_t stops;
+  size_t offset;
+  size_t end;
+  int count;
+
+  pthread_once(&_csvScanOnce, selectDefaultKernel);
+  if (pState->invalid != SIZE_MAX) {
+    return 0;
+  }
+
+  count = 0;
+  end = size - pState->scanned > CSV_SCAN_WINDOW ? pState->scanned + CSV_SCAN_WINDOW : size;
+  for (offset = pState->scanned; offset < end; offset += CSV_SCAN_BLOCK) {
+    pBlock = pData + offset;
+    if (end - offset < CSV_SCAN_BLOCK) {
+      // the last block is padded with '\0', which is never a delimiter
+      memset(pTail, 0, sizeof(pTail));
+      memcpy(pTail, pBlock, end - offset);
+      pBlock = pTail;
+    }
+    _csvClassify(pBlock, delimiter, &masks);
+
+    stops = masks.delimiters | masks.newLines;
+    if (masks.quotes == 0 && pState->inQuotes == 0) {
+      // the usual block of a timing file, no quoted field to mask
+      separators = stops;
+    } else {
+      inside = prefixXor(masks.quotes) ^ pState->inQuotes;
+      // a quote opening a region starts a field, or is the second one of a ""
+      if ((masks.quotes & inside & ~((stops | masks.quotes) << 1 | pState->afterStop)) != 0) {
+        pState->invalid = offset;
+        break;
+      }
+      separators = stops & ~inside;
+      pState->inQuotes = (uint64_t)0 - (inside >> 63);
+    }
+    pState->afterStop = (stops | masks.quotes) >> 63;
+
+    while (separators != 0) {
+      pIndexes[count++] = (uint32_t)(offset - pState->scanned) + __builtin_ctzll(separators);
+      separators &= separators - 1;
+    }
+  }
+
+  pState->scanned = offset < end ? offset : end;
+  return count;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
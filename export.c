@@ -0,0 +1,419 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifdef WIN64
+#include <io.h>
+#endif
+
+#include "catalog.h"
+#include "export.h"
+#include "scoring.h"
+#include "standings.h"
+#include "util.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static const char _pCsvHeader[] = "type,year,gp,race,pos,car,number,driver,team,raceTime,pitsTime,pits,bestLapTime,"
+                                  "bestLap,s1,s2,s3,points\n";
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Quoted only when it contains a separator, a quote or an end of line
+static void appendCsvField(ReportBuffer *pBuffer, const char *pText) {
+  const char *pChar;
+
+  if (strpbrk(pText, ",\"\r\n") == NULL) {
+    reportString(pBuffer, pText);
+    return;
+  }
+
+  reportAppend(pBuffer, "\"", 1);
+  for (pChar = pText; *pChar != '\0'; pChar++) {
+    if (*pChar == '"') {
+      reportAppend(pBuffer, "\"", 1);
+    }
+    reportAppend(pBuffer, pChar, 1);
+  }
+  reportAppend(pBuffer, "\"", 1);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void appendJsonString(ReportBuffer *pBuffer, const char *pText) {
+  static const char pHex[] = "0123456789abcdef";
+  char pEscape[6] = {'\\', 'u', '0', '0', 0, 0};
+  const char *pChar;
+
+  reportAppend(pBuffer, "\"", 1);
+  for (pChar = pText; *pChar != '\0'; pChar++) {
+    if (*pChar == '"' || *pChar == '\\') {
+      reportAppend(pBuffer, "\\", 1);
+      reportAppend(pBuffer, pChar, 1);
+    } else if ((unsigned char)*pChar < 0x20) {
+      pEscape[4] = pHex[*pChar >> 4];
+      pEscape[5] = pHex[*pChar & 0xF];
+      reportAppend(pBuffer, pEscape, sizeof(pEscape));
+    } else {
+      reportAppend(pBuffer, pChar, 1);
+    }
+  }
+  reportAppend(pBuffer, "\"", 1);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// "12" or "12.5"
+static void appendPoints(ReportBuffer *pBuffer, int32_t halfPoints) {
+  reportUnsigned(pBuffer, (uint32_t)halfPoints / 2);
+  if (halfPoints & 1) {
+    reportAppend(pBuffer, ".5", 2);
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The number, name and team columns only depend on the carId: they are escaped once for the whole export
+static void formatDrivers(ExportOutput *pOutput) {
+  ReportBuffer *pDrivers;
+  const DriverInfo *pDriver;
+  int carId;
+
+  pDrivers = &pOutput->drivers;
+  for (carId = 0; carId < MAX_DRIVERS; carId++) {
+    pOutput->pDriverStarts[carId] = (int)pDrivers->length;
+    pDriver = &pOutput->pCtx->pDrivers[carId];
+    if (pOutput->format == export_CSV) {
+      reportAppend(pDrivers, ",", 1);
+      reportUnsigned(pDrivers, carId);
+      reportAppend(pDrivers, ",", 1);
+      appendCsvField(pDrivers, pDriver->pNumber);
+      reportAppend(pDrivers, ",", 1);
+      appendCsvField(pDrivers, pDriver->pName);
+      reportAppend(pDrivers, ",", 1);
+      appendCsvField(pDrivers, pDriver->pTeam);
+    } else {
+      reportString(pDrivers, ",\"car\":");
+      reportUnsigned(pDrivers, carId);
+      reportString(pDrivers, ",\"number\":");
+      appendJsonString(pDrivers, pDriver->pNumber);
+      reportString(pDrivers, ",\"driver\":");
+      appendJsonString(pDrivers, pDriver->pName);
+      reportString(pDrivers, ",\"team\":");
+      appendJsonString(pDrivers, pDriver->pTeam);
+    }
+  }
+  pOutput->pDriverStarts[MAX_DRIVERS] = (int)pDrivers->length;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void appendDriver(ExportOutput *pOutput, int carId) {
+  reportAppend(&pOutput->buffer, pOutput->drivers.pData + pOutput->pDriverStarts[carId],
+               pOutput->pDriverStarts[carId + 1] - pOutput->pDriverStarts[carId]);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void flushIfFull(ExportOutput *pOutput) {
+  if (pOutput->buffer.length < EXPORT_FLUSH_SIZE) {
+    return;
+  }
+  pOutput->bytes += pOutput->buffer.length;
+  if (reportFlush(&pOutput->buffer, pOutput->fileHandle) != RETURN_OK && pOutput->code == RETURN_OK) {
+    pOutput->code = RETURN_KO;
+  }
+  // after an error the records are dropped, exportClose() reports it
+  reportReset(&pOutput->buffer);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void appendRecordHeader(ExportOutput *pOutput, ExportRecordType type, int count, int year, int grandPrixId,
+                               RaceType raceType) {
+  ExportRecordHeader header;
+
+  header.magic = EXPORT_RECORD_MAGIC;
+  header.type = (uint16_t)type;
+  header.count = (uint16_t)count;
+  header.year = year;
+  header.grandPrixId = grandPrixId;
+  header.raceType = raceType;
+  reportAppend(&pOutput->buffer, (const char *)&header, sizeof(header));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int exportOpen(ExportOutput *pOutput, Context *pCtx, const char *pPath, ExportFormat format) {
+  memset(pOutput, 0, sizeof(ExportOutput));
+  pOutput->pCtx = pCtx;
+  pOutput->format = format;
+  reportInit(&pOutput->buffer);
+  reportInit(&pOutput->drivers);
+
+  if (strcmp(pPath, "-") == 0) {
+    pOutput->fileHandle = STDOUT_FILENO;
+    pOutput->standardOutput = true;
+  } else {
+    // O_BINARY for all the formats, the text lines end with a single '\n' on every system
+    pOutput->fileHandle = open(pPath, O_CREAT | O_TRUNC | O_WRONLY | O_BINARY, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+    if (pOutput->fileHandle == -1) {
+      logger(log_ERROR, "unable to create file %s, errno=%d\n", pPath, errno);
+      return RETURN_KO;
+    }
+  }
+
+  if (format != export_BINARY) {
+    formatDrivers(pOutput);
+  }
+  if (format == export_CSV) {
+    reportAppend(&pOutput->buffer, _pCsvHeader, sizeof(_pCsvHeader) - 1);
+  }
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void exportRace(ExportOutput *pOutput, int year, int grandPrixId, const Race *pRace) {
+  int32_t pPoints[MAX_DRIVERS];
+  ExportResultRecord record;
+  const RaceInfo *pRaceInfo;
+  ReportBuffer *pBuffer;
+  char pPrefix[128];
+  int prefixLength;
+  int cars;
+  int i;
+
+  if (pRace->type == race_Q2_GP || pRace->type == race_Q2_SPRINT) {
+    cars = MAX_DRIVERS_Q2;
+  } else if (pRace->type == race_Q3_GP || pRace->type == race_Q3_SPRINT) {
+    cars = MAX_DRIVERS_Q3;
+  } else {
+    cars = MAX_DRIVERS_Q1;
+  }
+  racePoints(pOutput->pCtx->pScoring, grandPrixId, pRace, pPoints);
+  pBuffer = &pOutput->buffer;
+  pRaceInfo = pRace->pItems;
+
+  if (pOutput->format == export_BINARY) {
+    appendRecordHeader(pOutput, export_RESULT, cars, year, grandPrixId, (RaceType)pRace->type);
+    for (i = 0; i < cars; i++, pRaceInfo++) {
+      record.position = i + 1;
+      record.carId = pRaceInfo->carId;
+      record.raceTime = pRaceInfo->raceTime;
+      record.pitsTime = pRaceInfo->pitsTime;
+      record.pits = pRaceInfo->pits;
+      record.bestLapTime = pRaceInfo->bestLapTime;
+      record.bestLap = pRaceInfo->bestLap;
+      record.bestS1 = pRaceInfo->bestS1;
+      record.bestS2 = pRaceInfo->bestS2;
+      record.bestS3 = pRaceInfo->bestS3;
+      record.points = pPoints[i];
+      reportAppend(pBuffer, (const char *)&record, sizeof(record));
+    }
+    pOutput->records += cars;
+    flushIfFull(pOutput);
+    return;
+  }
+
+  // the columns shared by every line of the session
+  if (pOutput->format == export_CSV) {
+    prefixLength = snprintf(pPrefix, sizeof(pPrefix), "result,%d,%d,%s,", year, grandPrixId + 1,
+                            raceTypeToString(pRace->type));
+  } else {
+    prefixLength =
+        snprintf(pPrefix, sizeof(pPrefix), "{\"type\":\"result\",\"year\":%d,\"gp\":%d,\"race\":\"%s\",\"pos\":", year,
+                 grandPrixId + 1, raceTypeToString(pRace->type));
+  }
+
+  for (i = 0; i < cars; i++, pRaceInfo++) {
+    reportAppend(pBuffer, pPrefix, prefixLength);
+    reportUnsigned(pBuffer, i + 1);
+    appendDriver(pOutput, pRaceInfo->carId);
+    if (pOutput->format == export_CSV) {
+      reportAppend(pBuffer, ",", 1);
+      reportUnsigned(pBuffer, pRaceInfo->raceTime);
+      reportAppend(pBuffer, ",", 1);
+      reportUnsigned(pBuffer, pRaceInfo->pitsTime);
+      reportAppend(pBuffer, ",", 1);
+      reportUnsigned(pBuffer, pRaceInfo->pits);
+      reportAppend(pBuffer, ",", 1);
+      reportUnsigned(pBuffer, pRaceInfo->bestLapTime);
+      reportAppend(pBuffer, ",", 1);
+      reportUnsigned(pBuffer, pRaceInfo->bestLap + 1);
+      reportAppend(pBuffer, ",", 1);
+      reportUnsigned(pBuffer, pRaceInfo->bestS1);
+      reportAppend(pBuffer, ",", 1);
+      reportUnsigned(pBuffer, pRaceInfo->bestS2);
+      reportAppend(pBuffer, ",", 1);
+      reportUnsigned(pBuffer, pRaceInfo->bestS3);
+      reportAppend(pBuffer, ",", 1);
+      appendPoints(pBuffer, pPoints[i]);
+      reportAppend(pBuffer, "\n", 1);
+    } else {
+      reportString(pBuffer, ",\"raceTime\":");
+      reportUnsigned(pBuffer, pRaceInfo->raceTime);
+      reportString(pBuffer, ",\"pitsTime\":");
+      reportUnsigned(pBuffer, pRaceInfo->pitsTime);
+      reportString(pBuffer, ",\"pits\":");
+      reportUnsigned(pBuffer, pRaceInfo->pits);
+      reportString(pBuffer, ",\"bestLapTime\":");
+      reportUnsigned(pBuffer, pRaceInfo->bestLapTime);
+      reportString(pBuffer, ",\"bestLap\":");
+      reportUnsigned(pBuffer, pRaceInfo->bestLap + 1);
+      reportString(pBuffer, ",\"s1\":");
+      reportUnsigned(pBuffer, pRaceInfo->bestS1);
+      reportString(pBuffer, ",\"s2\":");
+      reportUnsigned(pBuffer, pRaceInfo->bestS2);
+      reportString(pBuffer, ",\"s3\":");
+      reportUnsigned(pBuffer, pRaceInfo->bestS3);
+      reportString(pBuffer, ",\"points\":");
+      appendPoints(pBuffer, pPoints[i]);
+      reportAppend(pBuffer, "}\n", 2);
+    }
+  }
+  pOutput->records += cars;
+  flushIfFull(pOutput);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void exportGrandPrix(ExportOutput *pOutput, int year, const GrandPrix *pGrandPrix) {
+  const Race *pRaces;
+  int i;
+
+  // the sessions are stored one after the other, a session is stored once fillHistoric() has set its type
+  pRaces = pGrandPrix->pPractices;
+  for (i = 0; i < RACES_PER_GP; i++) {
+    if (pRaces[i].type <= race_ERROR || pRaces[i].type >= race_FINISHED) {
+      continue;
+    }
+    exportRace(pOutput, year, pGrandPrix->grandPrixId, &pRaces[i]);
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void exportStandings(ExportOutput *pOutput, int year, const StandingsTable *pTable) {
+  ExportStandingsRecord record;
+  const StandingsTableItem *pItem;
+  ReportBuffer *pBuffer;
+  char pPrefix[64];
+  int prefixLength;
+  int i;
+
+  pBuffer = &pOutput->buffer;
+  pItem = pTable->pItems;
+
+  if (pOutput->format == export_BINARY) {
+    appendRecordHeader(pOutput, export_STANDINGS, MAX_DRIVERS, year, -1, race_ERROR);
+    for (i = 0; i < MAX_DRIVERS; i++, pItem++) {
+      record.position = i + 1;
+      record.carId = pItem->carId;
+      record.points = pItem->points;
+      reportAppend(pBuffer, (const char *)&record, sizeof(record));
+    }
+    pOutput->records += MAX_DRIVERS;
+    flushIfFull(pOutput);
+    return;
+  }
+
+  if (pOutput->format == export_CSV) {
+    prefixLength = snprintf(pPrefix, sizeof(pPrefix), "standings,%d,,,", year);
+  } else {
+    prefixLength = snprintf(pPrefix, sizeof(pPrefix), "{\"type\":\"standings\",\"year\":%d,\"pos\":", year);
+  }
+
+  for (i = 0; i < MAX_DRIVERS; i++, pItem++) {
+    reportAppend(pBuffer, pPrefix, prefixLength);
+    reportUnsigned(pBuffer, i + 1);
+    appendDriver(pOutput, pItem->carId);
+    if (pOutput->format == export_CSV) {
+      reportAppend(pBuffer, ",,,,,,,,,", 9);
+      appendPoints(pBuffer, pItem->points);
+      reportAppend(pBuffer, "\n", 1);
+    } else {
+      reportString(pBuffer, ",\"points\":");
+      appendPoints(pBuffer, pItem->points);
+      reportAppend(pBuffer, "}\n", 2);
+    }
+  }
+  pOutput->records += MAX_DRIVERS;
+  flushIfFull(pOutput);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int exportClose(ExportOutput *pOutput) {
+  int code;
+
+  code = pOutput->code;
+  pOutput->bytes += pOutput->buffer.length;
+  if (reportFlush(&pOutput->buffer, pOutput->fileHandle) != RETURN_OK) {
+    code = RETURN_KO;
+  }
+  if (!pOutput->standardOutput && close(pOutput->fileHandle) == -1) {
+    logger(log_ERROR, "an error has occurred while closing the export, errno=%d\n", errno);
+    code = RETURN_KO;
+  }
+
+  reportFree(&pOutput->buffer);
+  reportFree(&pOutput->drivers);
+
+  return code;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int exportSeasons(Context *pCtx, const char *pPath, ExportFormat format) {
+  StandingsPoints standings;
+  StandingsTable table;
+  ExportOutput output;
+  const GrandPrix *pGrandPrix;
+  Catalog catalog;
+  uint64_t startUs;
+  uint64_t elapsedUs;
+  int season;
+  int code;
+  int gp;
+
+  startUs = monotonicMicros();
+  if (catalogOpen(pCtx, &catalog) != RETURN_OK) {
+    return RETURN_KO;
+  }
+  code = exportOpen(&output, pCtx, pPath, format);
+  if (code) {
+    catalogClose(&catalog);
+    return code;
+  }
+
+  for (season = 0; season < catalog.seasons; season++) {
+    pGrandPrix = catalog.pSeasons[season].pGrandPrix;
+    for (gp = 0; gp < MAX_GP && pGrandPrix[gp].nextStep != race_ERROR; gp++) {
+      exportGrandPrix(&output, catalog.pSeasons[season].year, &pGrandPrix[gp]);
+    }
+  }
+  for (season = 0; season < catalog.seasons; season++) {
+    computeStandings(pCtx->pScoring, catalog.pSeasons[season].pGrandPrix, &standings);
+    rankStandings(&standings, &table);
+    exportStandings(&output, catalog.pSeasons[season].year, &table);
+  }
+
+  code = exportClose(&output);
+  elapsedUs = monotonicMicros() - startUs;
+  if (code == RETURN_OK) {
+    logger(log_INFO, "%llu records of %d seasons exported to %s, %llu bytes in %llu us (%.1f MB/s)\n",
+           (unsigned long long)output.records, catalog.seasons, pPath, (unsigned long long)output.bytes,
+           (unsigned long long)elapsedUs, elapsedUs > 0 ? (double)output.bytes / elapsedUs : 0.0);
+  }
+  catalogClose(&catalog);
+
+  return code;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
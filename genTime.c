@@ -88,10 +88,34 @@ int writeFully(socket_t socket, void *pBuffer, int size) {
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
+//open the connection to grandPrix which is listening for the events
+int connectToServer(ProgramOptions *pParms, socket_t *pSocket) {
+  struct sockaddr_in serverAddr;
+
+  memset(&serverAddr, 0, sizeof(serverAddr));
+  serverAddr.sin_family = AF_INET;
+  serverAddr.sin_port = htons(pParms->serverPort);
+  serverAddr.sin_addr.s_addr = inet_addr(pParms->pServerAddress);
+  if (serverAddr.sin_addr.s_addr == INADDR_NONE) {
+    printf("ERROR: illegal server address '%s'\n", pParms->pServerAddress);
+    return RETURN_KO;
+  }
 
+  *pSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (*pSocket == INVALID_SOCKET) {
+    printf("ERROR: unable to allocate a new socket, code=%d\n", WSAGetLastError());
+    return RETURN_KO;
+  }
 
+  if (connect(*pSocket, (struct sockaddr *)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
+    printf("ERROR: unable to connect to '%s:%d', code=%d\n", pParms->pServerAddress, pParms->serverPort,
+           WSAGetLastError());
+    closesocket(*pSocket);
+    return RETURN_KO;
+  }
 
-/*--------------------------------------------------------------------------------------------------------------------*/
+  return RETURN_OK;
+}
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -114,6 +138,7 @@ int genTimeCore(ProgramOptions *pParms) {
   uint32_t maxRaceTime;
   //non sign int
   uint32_t timestamp;
+  socket_t serverSocket;
   EventRace *pEvents;  //hey this pointeur exist and is of type EventRace
   EventRace *pEvent; //hey this other pointeur exist and is of type EventRace
   bool *pPits;
@@ -355,6 +380,12 @@ int genTimeCore(ProgramOptions *pParms) {
 
 
 
+  code = connectToServer(pParms, &serverSocket);
+  if (code) {
+    returnCode = code;
+    goto genTimeCoreException;
+  }
+
   sleep = 0;
   pEvent = pEvents;
   for (i = 0; i < events; i++) {
@@ -363,6 +394,7 @@ int genTimeCore(ProgramOptions *pParms) {
       sleep = pEvent->timestamp;
     }
 
+    code = writeFully(serverSocket, pEvent, sizeof(EventRace)) != sizeof(EventRace);
     if (code) {
       printf("ERROR: unable to send event %d\n", i);
       break;
@@ -370,6 +402,8 @@ int genTimeCore(ProgramOptions *pParms) {
     pEvent++;
   }
 
+  closesocket(serverSocket);
+
   returnCode = RETURN_OK;
 
 genTimeCoreException:
@@ -9,25 +9,56 @@
 #include <getopt.h>
 #include <time.h>
 #include <assert.h>
+#include <signal.h>
 #ifdef WIN64
 #include <sys\stat.h>
 #endif
 
 #include "grandPrix.h"
+#include "capture.h"
+#include "catalog.h"
+#include "columnar.h"
+#include "export.h"
+#include "headless.h"
+#include "historic.h"
+#include "projection.h"
 #include "saveFile.h"
+#include "schema.h"
+#include "scoring.h"
+#include "standings.h"
 #include "util.h"
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-#define GRANDPRIX_FILENAME "F1_Grand_Prix_2024.csv"
-#define DRIVERS_FILENAME "Drivers.csv"
-
-const int pSprintScores[] = {8, 7, 6, 5, 4, 3, 2, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-const int pGrandPrixScores[] = {25, 20, 15, 10, 8, 6, 5, 3, 2, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-
-/*--------------------------------------------------------------------------------------------------------------------*/
+#define OPTION_FORMAT 256
+#define OPTION_SNAPSHOT 257
+#define OPTION_EXPORT_COLUMNS 258
+#define OPTION_PROJECTION 259
+#define OPTION_SEASONS 260
+#define OPTION_SCORING 261
+#define OPTION_RESCORE 262
+#define OPTION_EXPORT_SEASON 263
+#define OPTION_THREADS 264
+#define OPTION_EXPORT 265
+#define OPTION_EXPORT_FORMAT 266
 
 typedef struct structProgramOptions {//to save option of the program
+  bool headless;
+  const char *pOutputPath;
+  HeadlessFormat outputFormat;
+  int snapshotIntervalMs;
+  const char *pColumnsPath;
+  const char *pProjectionPath;
+  uint64_t projectionSeasons;
+  const char *pScoringName;
+  const char *pRescorePath;
+  const char *pSeasonPath;
+  const char *pExportPath;
+  ExportFormat exportFormat;
+  int threads; // 0 for all the cores
+  const char *pListenAddress;
+  int listenPort;
+  int targetFps;
   int gpYear;
   int speedFactor;
 } ProgramOptions;
@@ -40,53 +71,36 @@ typedef struct structMenuItem {
 typedef struct structDisplayMenuContext {// ??
 } DisplayMenuContext;
 
-typedef struct structCarStatus {
-  int cardId;
-  int currentLap;
-  int segments;
-  EventType lastEvent;
-  uint32_t startLapTimestamp;
-  uint32_t lastEventTS;
-  uint32_t lastLapTime;
-  uint32_t bestLapTime;
-  uint32_t totalLapsTime;
-  uint32_t lastSegmentTS;
-  int bestLap;
-  int bestS1Time;
-  int bestS2Time;
-  int bestS3Time;
-  int s1Time;
-  int s2Time;
-  int s3Time;
-  uint32_t totalPitsTime;
-  int pitTime;
-  int pits;
-  bool active;
-} CarStatus;
-
-typedef struct structLeaderBoard {
-  int grandPrixId;
-  RaceType type;
-  time_t raceStartTime;
-  CarStatus *pCars;
-  int *pSortIndices;
-  int cars;
-  int laps;
-  uint32_t lastEventTimestamp;
-} LeaderBoard;
-
-typedef struct structAcquireThreadCtx {
-  Context *pCtx;
-  CarStatus *pCarStatus;
-  bool threadStillAlive;
-  int returnCode;
-} AcquireThreadCtx;
+static volatile sig_atomic_t _stopRequested = 0;
+
+// clang-format off
+static const struct option pLongOptions[] = {
+  { "headless", no_argument, NULL, 'H' },
+  { "output", required_argument, NULL, 'o' },
+  { "format", required_argument, NULL, OPTION_FORMAT },
+  { "snapshot", required_argument, NULL, OPTION_SNAPSHOT },
+  { "export-columns", required_argument, NULL, OPTION_EXPORT_COLUMNS },
+  { "projection", required_argument, NULL, OPTION_PROJECTION },
+  { "seasons", required_argument, NULL, OPTION_SEASONS },
+  { "scoring", required_argument, NULL, OPTION_SCORING },
+  { "rescore", required_argument, NULL, OPTION_RESCORE },
+  { "export-season", required_argument, NULL, OPTION_EXPORT_SEASON },
+  { "threads", required_argument, NULL, OPTION_THREADS },
+  { "export", required_argument, NULL, OPTION_EXPORT },
+  { "export-format", required_argument, NULL, OPTION_EXPORT_FORMAT },
+  { NULL, 0, NULL, 0 }
+};
+// clang-format on
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 int displayListGPs(Context *pCtx, int choice, void *pUserData);
 int displayListDrivers(Context *pCtx, int choice, void *pUserData);
 int displayStandings(Context *pCtx, int choice, void *pUserData);
+int displayProjection(Context *pCtx, int choice, void *pUserData);
+int displayConstructors(Context *pCtx, int choice, void *pUserData);
+int displayAllSeasons(Context *pCtx, int choice, void *pUserData);
+int displaySeasonAnalytics(Context *pCtx, int choice, void *pUserData);
 int captureEvents(Context *pCtx, int choice, void *pUserData);
 int displayCompletedGPMenu(Context *pCtx, int choice, void *pUserData);
 int displayPilotChange(Context *pCtx, int choice, void *pUserData);
@@ -99,6 +113,10 @@ const static MenuItem pMainMenu[] = {
   { "Afficher liste des pilotes", displayListDrivers },
   { "Afficher des resultats de courses terminees", displayCompletedGPMenu },
   { "Afficher le classement general", displayStandings },
+  { "Afficher le classement des constructeurs", displayConstructors },
+  { "Afficher les chances de titre", displayProjection },
+  { "Afficher les statistiques de toutes les saisons", displayAllSeasons },
+  { "Afficher les meilleurs temps par Grand Prix", displaySeasonAnalytics },
   { "Lancer la capture de l'etape suivante", captureEvents },
   {"Changer les pilotes", displayPilotChange},
 { "Quitter le programme", NULL },
@@ -152,6 +170,23 @@ void printHelp(void) {
   printf("  -l <address>      Specify the listen address. Default: 127.0.0.1\n");
   printf("  -p <port>         Specify the listen port. Default: 1111\n");
   printf("  -y <year>         Specify the GP year. Default: 2025\n");
+  printf("  -f <fps>          Specify the maximum refresh rate of the live leaderboard. Default: %d\n",
+         DEFAULT_TARGET_FPS);
+  printf("  --headless        Capture the next sessions without ncurses, streaming the leaderboard.\n");
+  printf("  -o, --output <path>  Headless output file, '-' for stdout. Default: -\n");
+  printf("  --format <json|binary>  Headless output format. Default: json\n");
+  printf("  --snapshot <ms>   Minimum interval between two headless snapshots. Default: %d\n",
+         DEFAULT_SNAPSHOT_INTERVAL_MS);
+  printf("  --export-columns <path>  Write the results of the season as a columns file and exit.\n");
+  printf("  --projection <path>  Write the probabilities of each final position as a CSV file and exit.\n");
+  printf("  --seasons <count>  Seasons simulated by the projection. Default: %d\n", PROJECTION_DEFAULT_SEASONS);
+  printf("  --scoring <rules>  Scoring rules of %s. Default: the first ones\n", SCORING_FILENAME);
+  printf("  --rescore <path>  Write the standings of the season under every scoring rules as a CSV file and exit.\n");
+  printf("  --export-season <directory>  Update the Grand Prix reports and the standings and exit, or after each\n");
+  printf("                    session with --headless.\n");
+  printf("  --threads <count>  Threads of the projection and the season export. Default: all the cores\n");
+  printf("  --export <path>   Write the results and standings of every stored season and exit, '-' for stdout.\n");
+  printf("  --export-format <csv|ndjson|binary>  Format of --export. Default: ndjson\n");
   printf("  -h, -?            Display this help message.\n");
   printf("\nExample:\n");
   printf("  ./program -l 192.168.1.1 -p 8080 -y 2024\n");
@@ -160,129 +195,95 @@ void printHelp(void) {
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 int readConfiguration(Context *pCtx) {
-  CsvParser *pCsvParser;
-  CsvRow **ppCsvRowArray;
-  CsvRow *pCsvRow;
-  int i;
+  int records;
 
-  ppCsvRowArray = malloc(sizeof(CsvRow *) * MAX_GP);
-  if (ppCsvRowArray == NULL) {
-    logger(log_FATAL, "unable to allocate %d bytes for GrandPrix table.\n", sizeof(CsvRow *) * MAX_GP);
-    return RETURN_KO;
-  }
+  // the strings are kept until the end, packed in a few blocks
+  csvArenaInit(&pCtx->grandPrixArena, 0);
+  csvArenaInit(&pCtx->driversArena, 0);
 
-  pCsvParser = csvParserCreate(GRANDPRIX_FILENAME, NULL, true);
-  if (pCsvParser == NULL) {
-    logger(log_ERROR, "unable to create new parser for '%s'.\n", GRANDPRIX_FILENAME);
+  if (schemaLoad(&grandPrixSchema, GRANDPRIX_FILENAME, pCtx->pCalendar, MAX_GP, &records, &pCtx->grandPrixArena) !=
+      RETURN_OK) {
     return RETURN_KO;
   }
-
-  for (i = 0; i < MAX_GP; i++) {
-    pCsvRow = csvParserGetRow(pCsvParser);
-    if (pCsvRow == NULL) {
-      logger(log_ERROR, "file %s contains not enough lines (%d < %d).\n", GRANDPRIX_FILENAME, i, MAX_GP);
-      return RETURN_KO;
-    }
-    ppCsvRowArray[i] = pCsvRow;
-  }
-  pCtx->ppCsvGrandPrix = ppCsvRowArray;
-
-  csvParserDestroy(pCsvParser);
-
-  ppCsvRowArray = malloc(sizeof(CsvRow *) * MAX_DRIVERS);
-  if (ppCsvRowArray == NULL) {
-    logger(log_FATAL, "unable to allocate %d bytes for Drivers table.\n", sizeof(CsvRow *) * MAX_DRIVERS);
+  if (records < MAX_GP) {
+    logger(log_ERROR, "file %s contains not enough lines (%d < %d).\n", GRANDPRIX_FILENAME, records, MAX_GP);
     return RETURN_KO;
   }
 
-  pCsvParser = csvParserCreate(DRIVERS_FILENAME, NULL, false);
-  if (pCsvParser == NULL) {
-    logger(log_ERROR, "unable to create new parser for '%s'.\n", DRIVERS_FILENAME);
+  if (schemaLoad(&driversSchema, DRIVERS_FILENAME, pCtx->pDrivers, MAX_DRIVERS, &records, &pCtx->driversArena) !=
+      RETURN_OK) {
     return RETURN_KO;
   }
-
-  for (i = 0; i < MAX_DRIVERS; i++) {
-    pCsvRow = csvParserGetRow(pCsvParser);
-    if (pCsvRow == NULL) {
-      logger(log_ERROR, "file %s contains not enough lines (%d < %d).\n", DRIVERS_FILENAME, i, MAX_DRIVERS);
-      return RETURN_KO;
-    }
-    ppCsvRowArray[i] = pCsvRow;
+  if (records < MAX_DRIVERS) {
+    logger(log_ERROR, "file %s contains not enough lines (%d < %d).\n", DRIVERS_FILENAME, records, MAX_DRIVERS);
+    return RETURN_KO;
   }
-  pCtx->ppCsvDrivers = ppCsvRowArray;
-
-  csvParserDestroy(pCsvParser);
+  internTeams(pCtx);
 
   return RETURN_OK;
 }
 
-
-
-
-int captureEvents(Context *pCtx, int choice, void *pUserData) {
-  return 0;
-}
-
-
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void freeConfiguration(Context *pCtx) {
-  free((void *)pCtx->ppCsvGrandPrix);
-  free((void *)pCtx->ppCsvDrivers);
+  csvArenaFree(&pCtx->grandPrixArena);
+  csvArenaFree(&pCtx->driversArena);
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void initializeGP(Context *pCtx, int grandPrixId, GrandPrix *pGrandPrix) {
   pGrandPrix->grandPrixId = grandPrixId;
-  pGrandPrix->specialGP = strcasecmp(pCtx->ppCsvGrandPrix[grandPrixId]->ppFields[3], "True") == 0;
+  pGrandPrix->specialGP = pCtx->pCalendar[grandPrixId].isSprint;
   pGrandPrix->nextStep = race_P1;
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-int compareStandingsTableItem(const void *pA, const void *pB) {
-  int compare;
-
-  compare = ((StandingsTableItem *)pB)->points - ((StandingsTableItem *)pA)->points;
-  if (compare == 0) {
-    compare = ((StandingsTableItem *)pA)->carId - ((StandingsTableItem *)pB)->carId;
-  }
-  return compare;
-}
-
-
-
 int readHistoric(Context *pCtx) {
   char pFileName[PATH_MAX];
+#ifndef NDEBUG
+  StandingsPoints standings;
+#endif
   GrandPrix *pGrandPrix;
-  int fileHandle;
   int code;
   int i;
 
-  pGrandPrix = (GrandPrix *)calloc(MAX_GP, sizeof(GrandPrix));
-  if (pGrandPrix == NULL) {
-    logger(log_FATAL, "unable to allocate %d bytes for GrandPrix table.\n", sizeof(GrandPrix *) * MAX_GP);
-    return RETURN_KO;
+  sprintf(pFileName, "GrandPrix.%d.bin", pCtx->gpYear);
+  code = openHistoric(pCtx, pFileName);
+  if (code) {
+    return code;
   }
 
-  sprintf(pFileName, "GrandPrix.%d.bin", pCtx->gpYear);
-  fileHandle = open(pFileName, O_CREAT | O_BINARY | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
-  if (fileHandle == -1) {
-    logger(log_ERROR, "unable to open file %s, errno=%d\n", pFileName, errno);
-    return RETURN_KO;
+  // the stored standings are used as they are, unless they were computed with other rules or never computed
+  if (pCtx->pStandings->rules != pCtx->pScoring->crc) {
+    logger(log_INFO, "standings of %d computed with the '%s' rules\n", pCtx->gpYear, pCtx->pScoring->pName);
+    computeStandings(pCtx->pScoring, pCtx->pGrandPrix, pCtx->pStandings);
+    saveHistoricStandings(pCtx);
+  }
+#ifndef NDEBUG
+  // the updates by delta are checked by testStandings, and once more at each start of a debug build
+  computeStandings(pCtx->pScoring, pCtx->pGrandPrix, &standings);
+  if (!sameStandings(pCtx->pStandings, &standings)) {
+    logger(log_WARN, "stored standings of %d differ from the results, recomputed\n", pCtx->gpYear);
+    memcpy(pCtx->pStandings, &standings, sizeof(StandingsPoints));
+    saveHistoricStandings(pCtx);
   }
+#endif
+  rankStandings(pCtx->pStandings, &pCtx->standingsTable);
+  computeConstructorPoints(pCtx);
+  rankConstructors(pCtx);
 
   for (i = 0; i < MAX_GP; i++) {
-    code = read(fileHandle, &pGrandPrix[i], sizeof(GrandPrix));
-    if (code == 0) {
+    pCtx->pGrandPrixVersions[i] = grandPrixVersion(&pCtx->pGrandPrix[i]);
+  }
+
+  // the records are used in order, the first one never initialized ends the season
+  pGrandPrix = pCtx->pGrandPrix;
+  for (i = 0; i < MAX_GP; i++) {
+    if (pGrandPrix[i].nextStep == race_ERROR) {
       break;
     }
-    if (code != sizeof(GrandPrix)) {
-      close(fileHandle);
-      logger(log_ERROR, "an error has occurred while reading file %s\n", pFileName);
-      return RETURN_KO;
-    }
   }
 
   if (i == 0) {
@@ -302,25 +303,13 @@ int readHistoric(Context *pCtx) {
     }
   }
 
-  pCtx->pGrandPrix = pGrandPrix;
-  pCtx->gpHistoricHandle = fileHandle;
-
   return RETURN_OK;
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 int saveHistoric(Context *pCtx) {
-  int code;
-
-  lseek(pCtx->gpHistoricHandle, pCtx->currentGP * sizeof(GrandPrix), SEEK_SET);
-  code = write(pCtx->gpHistoricHandle, &pCtx->pGrandPrix[pCtx->currentGP], sizeof(GrandPrix));
-  if (code != (int)sizeof(GrandPrix)) {
-    logger(log_ERROR, "an error has occurred while writing to historic file\n");
-    return RETURN_KO;
-  }
-
-  return RETURN_OK;
+  return syncHistoric(pCtx, pCtx->currentGP);
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
@@ -361,7 +350,7 @@ int fillHistoric(Context *pCtx, LeaderBoard *pLeaderBoard) {
 
   currentGP = pCtx->currentGP;
   pGrandPrix = &pCtx->pGrandPrix[currentGP];
-  specialGP = strcasecmp(pCtx->ppCsvGrandPrix[currentGP]->ppFields[3], "True") == 0;
+  specialGP = pCtx->pCalendar[currentGP].isSprint;
   switch (pGrandPrix->nextStep) {
   case race_P1:
     fillHistoricRace(&pGrandPrix->pPractices[0], race_P1, pLeaderBoard);
@@ -389,6 +378,7 @@ int fillHistoric(Context *pCtx, LeaderBoard *pLeaderBoard) {
     break;
   case race_SPRINT:
     fillHistoricRace(&pGrandPrix->sprint, race_SPRINT, pLeaderBoard);
+    addRaceToStandings(pCtx, currentGP, &pGrandPrix->sprint);
     pGrandPrix->nextStep = race_Q1_GP;
     break;
   case race_Q1_GP:
@@ -405,11 +395,13 @@ int fillHistoric(Context *pCtx, LeaderBoard *pLeaderBoard) {
     break;
   case race_GP:
     fillHistoricRace(&pGrandPrix->final, race_GP, pLeaderBoard);
+    addRaceToStandings(pCtx, currentGP, &pGrandPrix->final);
     pGrandPrix->nextStep = race_FINISHED;
     break;
   default:
     break;
   }
+  pCtx->pGrandPrixVersions[currentGP] = grandPrixVersion(pGrandPrix);
 
   return RETURN_OK;
 }
@@ -417,22 +409,23 @@ int fillHistoric(Context *pCtx, LeaderBoard *pLeaderBoard) {
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 void freeHistoric(Context *pCtx) {
-  free(pCtx->pGrandPrix);
-  close(pCtx->gpHistoricHandle);
+  closeHistoric(pCtx);
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 int displayRace(Context *pCtx, int grandPrixId, Race *pRace) {
+  int32_t pPoints[MAX_DRIVERS];
   char pFormat[32];
   WINDOW *pWindow;
   RaceInfo *pRaceInfo;
   uint32_t previousTime;
-  char **ppFields;
+  const GrandPrixInfo *pGrandPrixInfo;
+  const DriverInfo *pDriver;
   int carId;
   int i;
 
-  ppFields = pCtx->ppCsvGrandPrix[grandPrixId]->ppFields;
+  pGrandPrixInfo = &pCtx->pCalendar[grandPrixId];
   pWindow = pCtx->pWindow;
 
   werase(pWindow);
@@ -442,16 +435,19 @@ int displayRace(Context *pCtx, int grandPrixId, Race *pRace) {
     wattroff(pWindow, COLOR_PAIR(3));
   } else {
     wattron(pWindow, A_BOLD);
-    mvwprintw(pWindow, 1, 20, "%d %s/%s - %s", pCtx->gpYear, ppFields[0], ppFields[1], raceTypeToString(pRace->type));
+    mvwprintw(pWindow, 1, 20, "%d %s/%s - %s", pCtx->gpYear, pGrandPrixInfo->pName, pGrandPrixInfo->pCircuit,
+              raceTypeToString(pRace->type));
     mvwprintw(pWindow, 2, 1,
               "Pos   Number     Driver                      Team                        Time         Gap    Points");
     wattroff(pWindow, A_BOLD);
 
+    racePoints(pCtx->pScoring, grandPrixId, pRace, pPoints);
     pRaceInfo = (RaceInfo *)pRace->pItems;
     for (i = 0; i < MAX_DRIVERS; i++) {
       carId = pRaceInfo->carId;
-      ppFields = pCtx->ppCsvDrivers[carId]->ppFields;
-      mvwprintw(pWindow, i + 3, 1, "%3d  %5s    %-20.20s   %-30.30s", i + 1, ppFields[0], ppFields[1], ppFields[2]);
+      pDriver = &pCtx->pDrivers[carId];
+      mvwprintw(pWindow, i + 3, 1, "%3d  %5s    %-20.20s   %-30.30s", i + 1, pDriver->pNumber, pDriver->pName,
+                pDriver->pTeam);
       if (pRaceInfo->raceTime > 0) {
         mvwprintw(pWindow, i + 3, 70, "%10s", timestampToHour(pRaceInfo->raceTime, pFormat, sizeof(pFormat)));
         if (i == 0) {
@@ -460,7 +456,7 @@ int displayRace(Context *pCtx, int grandPrixId, Race *pRace) {
           mvwprintw(pWindow, i + 3, 83, "%10s",
                     milliToGap(pRaceInfo->raceTime - previousTime, pFormat, sizeof(pFormat)));
         }
-        mvwprintw(pWindow, i + 3, 94, "%4d", pGrandPrixScores[i]);
+        mvwprintw(pWindow, i + 3, 94, "%4s", pointsToString(pPoints[i], pFormat, sizeof(pFormat)));
       }
       pRaceInfo++;
     }
@@ -477,12 +473,13 @@ int displayQualification(Context *pCtx, int grandPrixId, Race *pQualification) {
   WINDOW *pWindow;
   RaceInfo *pRaceInfo;
   uint32_t previousTime;
-  char **ppFields;
+  const GrandPrixInfo *pGrandPrixInfo;
+  const DriverInfo *pDriver;
   int drivers;
   int carId;
   int i;
 
-  ppFields = pCtx->ppCsvGrandPrix[grandPrixId]->ppFields;
+  pGrandPrixInfo = &pCtx->pCalendar[grandPrixId];
   pWindow = pCtx->pWindow;
   previousTime = 0;
 
@@ -493,7 +490,7 @@ int displayQualification(Context *pCtx, int grandPrixId, Race *pQualification) {
     wattroff(pWindow, COLOR_PAIR(3));
   } else {
     wattron(pWindow, A_BOLD);
-    mvwprintw(pWindow, 1, 20, "%d %s/%s - %s", pCtx->gpYear, ppFields[0], ppFields[1],
+    mvwprintw(pWindow, 1, 20, "%d %s/%s - %s", pCtx->gpYear, pGrandPrixInfo->pName, pGrandPrixInfo->pCircuit,
               raceTypeToString(pQualification->type));
     mvwprintw(pWindow, 2, 1,
               "Pos   Number     Driver                      Team               Best time    Gap     Laps");
@@ -513,8 +510,9 @@ int displayQualification(Context *pCtx, int grandPrixId, Race *pQualification) {
     pRaceInfo = (RaceInfo *)pQualification->pItems;
     for (i = 0; i < drivers; i++) {
       carId = pRaceInfo->carId;
-      ppFields = pCtx->ppCsvDrivers[carId]->ppFields;
-      mvwprintw(pWindow, i + 3, 1, "%3d  %5s    %-20.20s   %-30.30s", i + 1, ppFields[0], ppFields[1], ppFields[2]);
+      pDriver = &pCtx->pDrivers[carId];
+      mvwprintw(pWindow, i + 3, 1, "%3d  %5s    %-20.20s   %-30.30s", i + 1, pDriver->pNumber, pDriver->pName,
+                pDriver->pTeam);
       if (pRaceInfo->raceTime > 0) {
         mvwprintw(pWindow, i + 3, 64, "%10s", timestampToMinute(pRaceInfo->bestLapTime, pFormat, sizeof(pFormat)));
         if (i == 0) {
@@ -540,11 +538,12 @@ int displayPractice(Context *pCtx, int grandPrixId, Race *pPractice) {
   WINDOW *pWindow;
   RaceInfo *pRaceInfo;
   uint32_t previousTime;
-  char **ppFields;
+  const GrandPrixInfo *pGrandPrixInfo;
+  const DriverInfo *pDriver;
   int carId;
   int i;
 
-  ppFields = pCtx->ppCsvGrandPrix[grandPrixId]->ppFields;
+  pGrandPrixInfo = &pCtx->pCalendar[grandPrixId];
   pWindow = pCtx->pWindow;
   previousTime = 0;
 
@@ -555,7 +554,7 @@ int displayPractice(Context *pCtx, int grandPrixId, Race *pPractice) {
     wattroff(pWindow, COLOR_PAIR(3));
   } else {
     wattron(pWindow, A_BOLD);
-    mvwprintw(pWindow, 1, 20, "%d %s/%s - %s", pCtx->gpYear, ppFields[0], ppFields[1],
+    mvwprintw(pWindow, 1, 20, "%d %s/%s - %s", pCtx->gpYear, pGrandPrixInfo->pName, pGrandPrixInfo->pCircuit,
               raceTypeToString(pPractice->type));
     mvwprintw(pWindow, 2, 1,
               "Pos   Number     Driver                      Team               Best time    Gap     Laps");
@@ -564,8 +563,9 @@ int displayPractice(Context *pCtx, int grandPrixId, Race *pPractice) {
     pRaceInfo = (RaceInfo *)pPractice->pItems;
     for (i = 0; i < MAX_DRIVERS; i++) {
       carId = pRaceInfo->carId;
-      ppFields = pCtx->ppCsvDrivers[carId]->ppFields;
-      mvwprintw(pWindow, i + 3, 1, "%3d  %5s    %-20.20s   %-30.30s", i + 1, ppFields[0], ppFields[1], ppFields[2]);
+      pDriver = &pCtx->pDrivers[carId];
+      mvwprintw(pWindow, i + 3, 1, "%3d  %5s    %-20.20s   %-30.30s", i + 1, pDriver->pNumber, pDriver->pName,
+                pDriver->pTeam);
       if (pRaceInfo->bestLapTime > 0) {
         mvwprintw(pWindow, i + 3, 64, "%10s", timestampToMinute(pRaceInfo->bestLapTime, pFormat, sizeof(pFormat)));
         if (i == 0) {
@@ -590,11 +590,12 @@ int displayStartingGrid(Context *pCtx, int grandPrixId, Race *pQualification) {
   char pFormat[32];
   WINDOW *pWindow;
   RaceInfo *pRaceInfo;
-  char **ppFields;
+  const GrandPrixInfo *pGrandPrixInfo;
+  const DriverInfo *pDriver;
   int carId;
   int i;
 
-  ppFields = pCtx->ppCsvGrandPrix[grandPrixId]->ppFields;
+  pGrandPrixInfo = &pCtx->pCalendar[grandPrixId];
   pWindow = pCtx->pWindow;
 
   werase(pWindow);
@@ -604,7 +605,8 @@ int displayStartingGrid(Context *pCtx, int grandPrixId, Race *pQualification) {
     wattroff(pWindow, COLOR_PAIR(3));
   } else {
     wattron(pWindow, A_BOLD);
-    mvwprintw(pWindow, 1, 15, "%d %s/%s - Grille de depart", pCtx->gpYear, ppFields[0], ppFields[1]);
+    mvwprintw(pWindow, 1, 15, "%d %s/%s - Grille de depart", pCtx->gpYear, pGrandPrixInfo->pName,
+              pGrandPrixInfo->pCircuit);
     mvwprintw(pWindow, 2, 1, "Pos   Number     Driver                      Team                       Best time");
     wattroff(pWindow, A_BOLD);
 
@@ -617,9 +619,9 @@ int displayStartingGrid(Context *pCtx, int grandPrixId, Race *pQualification) {
         pRaceInfo = (RaceInfo *)&pQualification[0].pItems[15];
       }
       carId = pRaceInfo->carId;
-      ppFields = pCtx->ppCsvDrivers[carId]->ppFields;
-      mvwprintw(pWindow, i + 3, 1, "%3d  %5s    %-20.20s   %-30.30s    %10s", i + 1, ppFields[0], ppFields[1],
-                ppFields[2], timestampToMinute(pRaceInfo->bestLapTime, pFormat, sizeof(pFormat)));
+      pDriver = &pCtx->pDrivers[carId];
+      mvwprintw(pWindow, i + 3, 1, "%3d  %5s    %-20.20s   %-30.30s    %10s", i + 1, pDriver->pNumber, pDriver->pName,
+                pDriver->pTeam, timestampToMinute(pRaceInfo->bestLapTime, pFormat, sizeof(pFormat)));
       pRaceInfo++;
     }
   }
@@ -632,61 +634,287 @@ int displayStartingGrid(Context *pCtx, int grandPrixId, Race *pQualification) {
 
 int displayStandings(Context *pCtx, int choice, void *pUserData) {
   StandingsTableItem *pStandingsTableItem;
-  RaceInfo *pSprintInfo;
-  RaceInfo *pGrandPrixInfo;
-  GrandPrix *pGrandPrix;
+  char pPoints[16];
   WINDOW *pWindow;
-  char **ppFields;
+  const DriverInfo *pDriver;
   int carId;
-  int car;
   int i;
 
-  pGrandPrix = pCtx->pGrandPrix;
+  pWindow = pCtx->pWindow;
+  werase(pWindow);
+
+  wattron(pWindow, A_BOLD);
+  mvwprintw(pWindow, 1, 25, "%d - Classement des pilotes", pCtx->gpYear);
+  mvwprintw(pWindow, 2, 1, "Pos   Number     Driver                      Team                   Total points");
+  wattroff(pWindow, A_BOLD);
+
   pStandingsTableItem = (StandingsTableItem *)pCtx->standingsTable.pItems;
   for (i = 0; i < MAX_DRIVERS; i++) {
-    pStandingsTableItem->carId = i;
-    pStandingsTableItem->points = 0;
+    carId = pStandingsTableItem->carId;
+    pDriver = &pCtx->pDrivers[carId];
+    mvwprintw(pWindow, i + 3, 1, "%3d  %5s    %-20.20s   %-30.30s   %5s", i + 1, pDriver->pNumber, pDriver->pName,
+              pDriver->pTeam, pointsToString(pStandingsTableItem->points, pPoints, sizeof(pPoints)));
     pStandingsTableItem++;
   }
+  wrefresh(pWindow);
+
+  wgetch(pWindow);
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int displayConstructors(Context *pCtx, int choice, void *pUserData) {
+  ConstructorsTableItem *pConstructorsTableItem;
+  char pPoints[16];
+  WINDOW *pWindow;
+  int i;
+
+  pWindow = pCtx->pWindow;
+  werase(pWindow);
+
+  wattron(pWindow, A_BOLD);
+  mvwprintw(pWindow, 1, 25, "%d - Classement des constructeurs", pCtx->gpYear);
+  mvwprintw(pWindow, 2, 1, "Pos   Team                                      Total points");
+  wattroff(pWindow, A_BOLD);
+
+  pConstructorsTableItem = pCtx->constructorsTable.pItems;
+  for (i = 0; i < pCtx->constructorsTable.teams; i++) {
+    mvwprintw(pWindow, i + 3, 1, "%3d   %-40.40s   %5s", i + 1, pCtx->ppTeamNames[pConstructorsTableItem->teamId],
+              pointsToString(pConstructorsTableItem->points, pPoints, sizeof(pPoints)));
+    pConstructorsTableItem++;
+  }
+  wrefresh(pWindow);
+
+  wgetch(pWindow);
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int displayProjection(Context *pCtx, int choice, void *pUserData) {
+  StandingsTableItem *pStandingsTableItem;
+  ProjectionModel model;
+  Projection projection;
+  FormModel formModel;
+  char pPoints[16];
+  WINDOW *pWindow;
+  const DriverInfo *pDriver;
+  double *pProbabilities;
+  double top3;
+  int likely;
+  int carId;
+  int i;
+  int j;
+
+  pWindow = pCtx->pWindow;
+  werase(pWindow);
+  mvwprintw(pWindow, 1, 25, "%d - Simulation de %d saisons...", pCtx->gpYear, PROJECTION_DEFAULT_SEASONS);
+  wrefresh(pWindow);
+
+  buildFormModel(pCtx->pGrandPrix, &formModel, &model);
+  if (projectChampionship(pCtx, &model, PROJECTION_DEFAULT_SEASONS, 0, (uint64_t)time(NULL), &projection) !=
+      RETURN_OK) {
+    return RETURN_KO;
+  }
+
+  werase(pWindow);
+  wattron(pWindow, A_BOLD);
+  mvwprintw(pWindow, 1, 25, "%d - Chances de titre, %d sprints et %d Grands Prix restants", pCtx->gpYear,
+            projection.remainingSprints, projection.remainingGrandsPrix);
+  mvwprintw(pWindow, 2, 1,
+            "Pos   Number     Driver                 Points     Titre    Top 3   Position la plus probable");
+  wattroff(pWindow, A_BOLD);
 
   pStandingsTableItem = (StandingsTableItem *)pCtx->standingsTable.pItems;
-  for (i = 0; i < MAX_GP; i++) {
-    if (pGrandPrix->specialGP && pGrandPrix->nextStep > race_SPRINT) {
-      pSprintInfo = (RaceInfo *)pGrandPrix->sprint.pItems;
-      for (car = 0; car < MAX_DRIVERS; car++) {
-        pStandingsTableItem[pSprintInfo->carId].points += pSprintScores[car];
-        pSprintInfo++;
+  for (i = 0; i < MAX_DRIVERS; i++) {
+    carId = pStandingsTableItem->carId;
+    pDriver = &pCtx->pDrivers[carId];
+    pProbabilities = projection.pProbabilities[carId];
+    top3 = pProbabilities[0] + pProbabilities[1] + pProbabilities[2];
+    likely = 0;
+    for (j = 1; j < MAX_DRIVERS; j++) {
+      if (pProbabilities[j] > pProbabilities[likely]) {
+        likely = j;
       }
     }
-    if (pGrandPrix->nextStep > race_GP) {
-      pGrandPrixInfo = (RaceInfo *)pGrandPrix->final.pItems;
-      for (car = 0; car < MAX_DRIVERS; car++) {
-        pStandingsTableItem[pGrandPrixInfo->carId].points += pGrandPrixScores[car];
-        pGrandPrixInfo++;
+    mvwprintw(pWindow, i + 3, 1, "%3d  %5s    %-20.20s   %5s   %6.2f%%  %6.2f%%   %3d (%5.2f%%)", i + 1,
+              pDriver->pNumber, pDriver->pName, pointsToString(pStandingsTableItem->points, pPoints, sizeof(pPoints)),
+              pProbabilities[0] * 100, top3 * 100, likely + 1, pProbabilities[likely] * 100);
+    pStandingsTableItem++;
+  }
+  mvwprintw(pWindow, MAX_DRIVERS + 3, 1, "%llu saisons, %d threads, %llu us", (unsigned long long)projection.seasons,
+            projection.threads, (unsigned long long)projection.elapsedUs);
+  wrefresh(pWindow);
+
+  wgetch(pWindow);
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int displayAllSeasons(Context *pCtx, int choice, void *pUserData) {
+  const ResultRef *pResults;
+  const SessionRef *pSession;
+  const SessionRef *pLastWin;
+  WINDOW *pWindow;
+  Catalog catalog;
+  const DriverInfo *pDriver;
+  const int *pSessions;
+  uint64_t startUs;
+  uint64_t queryUs;
+  int grandsPrix;
+  int sprintWins;
+  int sessions;
+  int podiums;
+  int results;
+  int sprints;
+  int number;
+  int poles;
+  int wins;
+  int i;
+  int j;
+
+  startUs = monotonicMicros();
+  if (catalogOpen(pCtx, &catalog) != RETURN_OK) {
+    return RETURN_KO;
+  }
+  queryUs = monotonicMicros();
+
+  pWindow = pCtx->pWindow;
+  werase(pWindow);
+
+  wattron(pWindow, A_BOLD);
+  if (catalog.seasons == 0) {
+    mvwprintw(pWindow, 1, 25, "Aucune saison enregistree");
+  } else {
+    mvwprintw(pWindow, 1, 25, "%d-%d - Statistiques de %d saison(s), %d sessions", catalog.pSeasons[0].year,
+              catalog.pSeasons[catalog.seasons - 1].year, catalog.seasons, catalog.sessions);
+  }
+  mvwprintw(pWindow, 2, 1, "Number     Driver                   Poles   Victoires   Podiums   Victoires Sprint");
+  wattroff(pWindow, A_BOLD);
+
+  // every count is a walk of the driver index, whatever the number of seasons
+  for (i = 0; i < MAX_DRIVERS; i++) {
+    pDriver = &pCtx->pDrivers[i];
+    number = catalog.pCarNumbers[i];
+    pResults = catalogResultsByDriver(&catalog, number, &results);
+    poles = 0;
+    wins = 0;
+    podiums = 0;
+    sprintWins = 0;
+    for (j = 0; j < results; j++, pResults++) {
+      pSession = &catalog.pSessions[pResults->session];
+      if (pSession->type == race_Q3_GP && pResults->position == 1) {
+        poles++;
+      } else if (pSession->type == race_GP && pResults->position <= 3) {
+        podiums++;
+        wins += pResults->position == 1;
+      } else if (pSession->type == race_SPRINT && pResults->position == 1) {
+        sprintWins++;
       }
     }
-    pGrandPrix++;
+    mvwprintw(pWindow, i + 3, 1, "%5s     %-20.20s   %8d   %8d   %8d   %8d", pDriver->pNumber, pDriver->pName, poles,
+              wins, podiums, sprintWins);
   }
-  qsort(&pCtx->standingsTable.pItems, MAX_DRIVERS, sizeof(StandingsTableItem), compareStandingsTableItem);
+
+  catalogSessionsByType(&catalog, race_GP, &grandsPrix);
+  catalogSessionsByType(&catalog, race_SPRINT, &sprints);
+  mvwprintw(pWindow, MAX_DRIVERS + 4, 1, "%d Grand(s) Prix et %d sprint(s) enregistres", grandsPrix, sprints);
+
+  // the sessions of a circuit are in year order, the last Grand Prix gives the last winner
+  pSessions = catalogSessionsByCircuit(&catalog, pCtx->currentGP, &sessions);
+  grandsPrix = 0;
+  pLastWin = NULL;
+  for (j = 0; j < sessions; j++) {
+    pSession = &catalog.pSessions[pSessions[j]];
+    if (pSession->type == race_GP) {
+      grandsPrix++;
+      pLastWin = pSession;
+    }
+  }
+  if (pLastWin != NULL && catalog.pSeasons[pLastWin->season].hasDrivers &&
+      (uint32_t)pLastWin->pRace->pItems[0].carId < MAX_DRIVERS) {
+    mvwprintw(pWindow, MAX_DRIVERS + 5, 1, "%s: %d Grand(s) Prix, dernier vainqueur #%d en %d",
+              pCtx->pCalendar[pCtx->currentGP].pCircuit, grandsPrix,
+              catalog.pSeasons[pLastWin->season].pCarNumbers[pLastWin->pRace->pItems[0].carId],
+              catalog.pSeasons[pLastWin->season].year);
+  } else {
+    mvwprintw(pWindow, MAX_DRIVERS + 5, 1, "%s: %d Grand(s) Prix", pCtx->pCalendar[pCtx->currentGP].pCircuit,
+              grandsPrix);
+  }
+  queryUs = monotonicMicros() - queryUs;
+  mvwprintw(pWindow, MAX_DRIVERS + 6, 1, "Chargement et index: %llu us, requetes: %llu us",
+            (unsigned long long)(monotonicMicros() - startUs - queryUs), (unsigned long long)queryUs);
+  wrefresh(pWindow);
+
+  catalogClose(&catalog);
+  wgetch(pWindow);
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int displaySeasonAnalytics(Context *pCtx, int choice, void *pUserData) {
+  uint32_t pBestLap[MAX_GP];
+  uint32_t pBestS1[MAX_GP];
+  uint32_t pBestS2[MAX_GP];
+  uint32_t pBestS3[MAX_GP];
+  uint64_t pPitsTime[MAX_GP];
+  uint64_t pPits[MAX_GP];
+  ResultColumns columns;
+  char pFormat[32];
+  WINDOW *pWindow;
+  uint64_t startUs;
+  int gp;
+
+  startUs = monotonicMicros();
+  if (buildResultColumns(pCtx->pGrandPrix, pCtx->gpYear, &columns) != RETURN_OK) {
+    return RETURN_KO;
+  }
+  columnMinPerGrandPrix(&columns, columns.pBestLapTime, race_ERROR, pBestLap);
+  columnMinPerGrandPrix(&columns, columns.pBestS1, race_ERROR, pBestS1);
+  columnMinPerGrandPrix(&columns, columns.pBestS2, race_ERROR, pBestS2);
+  columnMinPerGrandPrix(&columns, columns.pBestS3, race_ERROR, pBestS3);
+  columnSumPerGrandPrix(&columns, columns.pPitsTime, race_ERROR, pPitsTime);
+  columnSumPerGrandPrix(&columns, columns.pPits, race_ERROR, pPits);
 
   pWindow = pCtx->pWindow;
   werase(pWindow);
 
   wattron(pWindow, A_BOLD);
-  mvwprintw(pWindow, 1, 25, "%d - Classement des pilotes", pCtx->gpYear);
-  mvwprintw(pWindow, 2, 1, "Pos   Number     Driver                      Team                   Total points");
+  mvwprintw(pWindow, 1, 25, "%d - Meilleurs temps par Grand Prix, toutes sessions", pCtx->gpYear);
+  mvwprintw(pWindow, 2, 1, "      Name                    Best lap    Best S1    Best S2    Best S3   Arret moyen");
   wattroff(pWindow, A_BOLD);
 
-  pStandingsTableItem = (StandingsTableItem *)pCtx->standingsTable.pItems;
-  for (i = 0; i < MAX_DRIVERS; i++) {
-    carId = pStandingsTableItem->carId;
-    ppFields = pCtx->ppCsvDrivers[carId]->ppFields;
-    mvwprintw(pWindow, i + 3, 1, "%3d  %5s    %-20.20s   %-30.30s   %5d", i + 1, ppFields[0], ppFields[1], ppFields[2],
-              pStandingsTableItem->points);
-    pStandingsTableItem++;
+  for (gp = 0; gp < MAX_GP; gp++) {
+    mvwprintw(pWindow, gp + 3, 1, "%3d  %-20.20s", gp + 1, pCtx->pCalendar[gp].pName);
+    if (pBestLap[gp] > 0) {
+      mvwprintw(pWindow, gp + 3, 28, "%10s", timestampToMinute(pBestLap[gp], pFormat, sizeof(pFormat)));
+    }
+    if (pBestS1[gp] > 0) {
+      mvwprintw(pWindow, gp + 3, 40, "%9s", timestampToSecond(pBestS1[gp], pFormat, sizeof(pFormat)));
+    }
+    if (pBestS2[gp] > 0) {
+      mvwprintw(pWindow, gp + 3, 51, "%9s", timestampToSecond(pBestS2[gp], pFormat, sizeof(pFormat)));
+    }
+    if (pBestS3[gp] > 0) {
+      mvwprintw(pWindow, gp + 3, 62, "%9s", timestampToSecond(pBestS3[gp], pFormat, sizeof(pFormat)));
+    }
+    if (pPits[gp] > 0) {
+      mvwprintw(pWindow, gp + 3, 76, "%9s",
+                timestampToSecond((uint32_t)(pPitsTime[gp] / pPits[gp]), pFormat, sizeof(pFormat)));
+    }
   }
+  mvwprintw(pWindow, MAX_GP + 3, 1, "%d lignes, %llu us", columns.rows,
+            (unsigned long long)(monotonicMicros() - startUs));
   wrefresh(pWindow);
 
+  freeResultColumns(&columns);
   wgetch(pWindow);
 
   return RETURN_OK;
@@ -696,7 +924,7 @@ int displayStandings(Context *pCtx, int choice, void *pUserData) {
 
 int displayListGPs(Context *pCtx, int choice, void *pUserData) {
   WINDOW *pWindow;
-  char **ppFields;
+  const GrandPrixInfo *pGrandPrixInfo;
   bool specialGP;
   int i;
 
@@ -709,10 +937,10 @@ int displayListGPs(Context *pCtx, int choice, void *pUserData) {
   wattroff(pWindow, A_BOLD);
 
   for (i = 0; i < MAX_GP; i++) {
-    ppFields = pCtx->ppCsvGrandPrix[i]->ppFields;
-    specialGP = strcasecmp(ppFields[3], "True") == 0;
-    mvwprintw(pWindow, i + 3, 1, "%3d  %-20.20s   %-30.30s   %5s %c", i + 1, ppFields[0], ppFields[1], ppFields[2],
-              specialGP ? '*' : ' ');
+    pGrandPrixInfo = &pCtx->pCalendar[i];
+    specialGP = pGrandPrixInfo->isSprint;
+    mvwprintw(pWindow, i + 3, 1, "%3d  %-20.20s   %-30.30s   %5d %c", i + 1, pGrandPrixInfo->pName,
+              pGrandPrixInfo->pCircuit, pGrandPrixInfo->laps, specialGP ? '*' : ' ');
   }
   wrefresh(pWindow);
 
@@ -725,7 +953,7 @@ int displayListGPs(Context *pCtx, int choice, void *pUserData) {
 
 int displayListDrivers(Context *pCtx, int choice, void *pUserData) {
   WINDOW *pWindow;
-  char **ppFields;
+  const DriverInfo *pDriver;
   int i;
 
   pWindow = pCtx->pWindow;
@@ -737,8 +965,8 @@ int displayListDrivers(Context *pCtx, int choice, void *pUserData) {
   wattroff(pWindow, A_BOLD);
 
   for (i = 0; i < MAX_DRIVERS; i++) {
-    ppFields = pCtx->ppCsvDrivers[i]->ppFields;
-    mvwprintw(pWindow, i + 3, 1, "%5s     %-30.30s   %-30.30s", ppFields[0], ppFields[1], ppFields[2]);
+    pDriver = &pCtx->pDrivers[i];
+    mvwprintw(pWindow, i + 3, 1, "%5s     %-30.30s   %-30.30s", pDriver->pNumber, pDriver->pName, pDriver->pTeam);
   }
   wrefresh(pWindow);
 
@@ -952,7 +1180,7 @@ int displayRaceResult(Context *pCtx, int grandPrixId) {
 int displayCompletedGPMenu(Context *pCtx, int choice, void *pUserData) {
   MenuItem *pMenuItems;
   char *pMenuLabel;
-  char **ppFields;
+  const GrandPrixInfo *pGrandPrixInfo;
   size_t length;
   int gps;
   int gp;
@@ -966,14 +1194,14 @@ int displayCompletedGPMenu(Context *pCtx, int choice, void *pUserData) {
   }
 
   for (i = 0; i < gps; i++) {
-    ppFields = pCtx->ppCsvGrandPrix[i]->ppFields;
-    length = strlen(ppFields[0]) + strlen(ppFields[1]) + 2;
+    pGrandPrixInfo = &pCtx->pCalendar[i];
+    length = strlen(pGrandPrixInfo->pName) + strlen(pGrandPrixInfo->pCircuit) + 2;
     pMenuLabel = (char *)malloc(length);
     if (pMenuLabel == NULL) {
       logger(log_FATAL, "unable to allocate %d bytes for GP menu item.\n", length);
       goto displayAllGPMenuExit;
     }
-    sprintf(pMenuLabel, "%s/%s", ppFields[0], ppFields[1]);
+    sprintf(pMenuLabel, "%s/%s", pGrandPrixInfo->pName, pGrandPrixInfo->pCircuit);
 
     pMenuItems[i].pItem = pMenuLabel;
     pMenuItems[i].pMenuAction = NULL;
@@ -1020,31 +1248,31 @@ int displayPilotChange(Context *pCtx, int choice, void *pUserData) {
 
     case 0: {
 
-      CsvParser *pCsvParser = csvParserCreate("Drivers_Crash.csv", NULL, false);
-      if (pCsvParser == NULL) {
+      DriverInfo pDrivers[MAX_DRIVERS];
+      CsvArena arena;
+      int drivers;
+      csvArenaInit(&arena, 0);
+
+      if (schemaLoad(&driversSchema, "Drivers_Crash.csv", pDrivers, MAX_DRIVERS, &drivers, &arena) != RETURN_OK) {
         logger(log_ERROR, "impossible de charger les pilotes Crash Bandicoot\n");
+        csvArenaFree(&arena);
         break;
       }
 
-      CsvRow **ppCsvRowArray = malloc(sizeof(CsvRow *) * MAX_DRIVERS);
-      if (ppCsvRowArray == NULL) {
-        logger(log_FATAL, "allocation échouée pour les pilotes Crash Bandicoot\n");
+      // les pilotes en place sont gardés si le fichier est incomplet
+      if (drivers < MAX_DRIVERS) {
+        logger(log_ERROR, "le fichier Crash Bandicoot contient moins de %d lignes\n", MAX_DRIVERS);
+        csvArenaFree(&arena);
         break;
       }
 
-      for (int i = 0; i < MAX_DRIVERS; i++) {
-        CsvRow *pCsvRow = csvParserGetRow(pCsvParser);
-        if (pCsvRow == NULL) {
-          logger(log_ERROR, "le fichier Crash Bandicoot contient moins de %d lignes\n", MAX_DRIVERS);
-          break;
-        }
-        ppCsvRowArray[i] = pCsvRow;
-      }
-
-      csvParserDestroy(pCsvParser);
-
-      free((void *)pCtx->ppCsvDrivers); // libère l'ancien tableau
-      pCtx->ppCsvDrivers = ppCsvRowArray;
+      // libère, d'un coup, les textes des anciens pilotes
+      memcpy(pCtx->pDrivers, pDrivers, sizeof(pDrivers));
+      csvArenaFree(&pCtx->driversArena);
+      pCtx->driversArena = arena;
+      internTeams(pCtx);
+      computeConstructorPoints(pCtx);
+      rankConstructors(pCtx);
 
       break;
     }
@@ -1066,251 +1294,419 @@ int displayPilotChange(Context *pCtx, int choice, void *pUserData) {
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-#ifdef WIN64
-int compareCarStatus(void *pUserData, const void *pLeft, const void *pRight) {
-#else
-int compareCarStatus(const void *pLeft, const void *pRight, void *pUserData) {
-#endif
-  CarStatus *pCarStatus;
-  CarStatus *pCarA;
-  CarStatus *pCarB;
-  int compare;
-
-  pCarStatus = (CarStatus *)pUserData;
-  pCarA = &pCarStatus[*(int *)pLeft];
-  pCarB = &pCarStatus[*(int *)pRight];
-
-  if (pCarA->active && pCarB->active) {
-    compare = pCarB->segments - pCarA->segments;
-    if (compare == 0) {
-      compare = pCarA->totalLapsTime - pCarB->totalLapsTime;
-      if (compare == 0) {
-        compare = pCarA->cardId - pCarB->cardId;
-      }
-    }
-    return compare;
-  }
+void makeLeaderBoardRow(LeaderBoardRow *pRow, int car, CarStatus *pCar) {
+  pRow->car = car;
+  pRow->active = pCar->active;
+  pRow->lastEvent = pCar->lastEvent;
+  pRow->currentLap = pCar->currentLap;
+  pRow->s1Time = pCar->s1Time;
+  pRow->s2Time = pCar->s2Time;
+  pRow->s3Time = pCar->s3Time;
+  pRow->bestLapTime = pCar->bestLapTime;
+  pRow->bestLap = pCar->bestLap;
+  pRow->pits = pCar->pits;
+  pRow->totalLapsTime = pCar->totalLapsTime;
+}
 
-  if (!pCarA->active && !pCarB->active) {
-    return pCarA->cardId - pCarB->cardId;
-  }
-  return pCarA->active ? -1 : 1;
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool sameLeaderBoardRow(const LeaderBoardRow *pA, const LeaderBoardRow *pB) {
+  return pA->car == pB->car && pA->active == pB->active && pA->lastEvent == pB->lastEvent &&
+         pA->currentLap == pB->currentLap && pA->s1Time == pB->s1Time && pA->s2Time == pB->s2Time &&
+         pA->s3Time == pB->s3Time && pA->bestLapTime == pB->bestLapTime && pA->bestLap == pB->bestLap &&
+         pA->pits == pB->pits && pA->totalLapsTime == pB->totalLapsTime;
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-#ifdef WIN64
-int compareCarStatusBestLap(void *pUserData, const void *pLeft, const void *pRight) {
-#else
-int compareCarStatusBestLap(const void *pLeft, const void *pRight, void *pUserData) {
-#endif
-  CarStatus *pCarStatus;
-  CarStatus *pCarA;
-  CarStatus *pCarB;
-
-  pCarStatus = (CarStatus *)pUserData;
-  pCarA = &pCarStatus[*(int *)pLeft];
-  pCarB = &pCarStatus[*(int *)pRight];
-
-  if (pCarA->active && pCarB->active) {
-    if (pCarA->bestLapTime == 0) {
-      if (pCarB->bestLapTime == 0) {
-        return pCarA->cardId - pCarB->cardId;
-      }
-      return 1;
-    }
+void displayLeaderBoardRow(Context *pCtx, WINDOW *pWindow, int position, LeaderBoardRow *pRow, CarStatus *pCar,
+                           bool bestLap) {
+  char pDisplay[32];
+  EventType event;
+  int line;
 
-    if (pCarB->bestLapTime == 0) {
-      return -1;
-    }
+  line = position + 3;
+  wmove(pWindow, line, 1);
+  wclrtoeol(pWindow);
+  mvwprintw(pWindow, line, 1, "%3d", position + 1);
+
+  if (pRow->active == false) {
+    wattron(pWindow, COLOR_PAIR(3));
+    mvwprintw(pWindow, line, 6, "%-20.20s", pCtx->pDrivers[pCar->cardId].pName);
+    wattroff(pWindow, COLOR_PAIR(3));
+    return;
+  }
+
+  event = pRow->lastEvent;
+  if (event == event_PIT_START) {
+    wattron(pWindow, COLOR_PAIR(4));
+  }
+
+  wattron(pWindow, A_BOLD);
+  mvwprintw(pWindow, line, 6, "%-20.20s", pCtx->pDrivers[pCar->cardId].pName);
+  wattroff(pWindow, A_BOLD);
+
+  if (event == event_END) {
+    mvwprintw(pWindow, line, 29, "  *");
+  } else {
+    mvwprintw(pWindow, line, 29, "%3d", pRow->currentLap + 1);
+  }
+
+  if (event == event_START || event == event_S3) {
+    wattron(pWindow, COLOR_PAIR(2));
+  }
+  mvwprintw(pWindow, line, 35, "%9s", timestampToSecond(pRow->s1Time, pDisplay, sizeof(pDisplay)));
+  if (event == event_START || event == event_S3) {
+    wattroff(pWindow, COLOR_PAIR(2));
+  }
+  if (event == event_S1) {
+    wattron(pWindow, COLOR_PAIR(2));
+  }
+  mvwprintw(pWindow, line, 45, "%9s", timestampToSecond(pRow->s2Time, pDisplay, sizeof(pDisplay)));
+  if (event == event_S1) {
+    wattroff(pWindow, COLOR_PAIR(2));
+  }
+  if (event == event_S2 || event == event_PIT_END) {
+    wattron(pWindow, COLOR_PAIR(2));
+  }
+  mvwprintw(pWindow, line, 55, "%9s", timestampToSecond(pRow->s3Time, pDisplay, sizeof(pDisplay)));
+  if (event == event_S2 || event == event_PIT_END) {
+    wattroff(pWindow, COLOR_PAIR(2));
+  }
 
-    return pCarA->bestLapTime - pCarB->bestLapTime;
+  mvwprintw(pWindow, line, 69, "%10s", timestampToMinute(pRow->bestLapTime, pDisplay, sizeof(pDisplay)));
+  if (bestLap) {
+    mvwprintw(pWindow, line, 84, "%5d", pRow->bestLap + 1);
+  } else {
+    mvwprintw(pWindow, line, 80, "%5d  %15s", pRow->pits,
+              timestampToHour(pRow->totalLapsTime, pDisplay, sizeof(pDisplay)));
   }
 
-  if (!pCarA->active && !pCarB->active) {
-    return pCarA->cardId - pCarB->cardId;
+  if (event == event_PIT_START) {
+    wattroff(pWindow, COLOR_PAIR(4));
   }
-  return pCarA->active ? -1 : 1;
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 int displayLeaderBoard(Context *pCtx, WINDOW *pWindow, LeaderBoard *pLeaderBoard) {
-
-  char pDisplay[32];
+  LeaderBoardRow row;
+  LeaderBoardRow *pRow;
+  RenderStats *pStats;
+  uint32_t dirtyCars;
   int *pSortIndices;
-  EventType event;
   CarStatus *pCars;
-  CarStatus *pCar;
   bool bestLap;
+  int redrawn;
+  int car;
   int i;
 
+  // nothing has changed since the last draw: the screen is already up to date
+  dirtyCars = pLeaderBoard->dirtyCars;
+  if (dirtyCars == 0 && !pLeaderBoard->fullRedraw) {
+    return RETURN_OK;
+  }
+
   pCars = pLeaderBoard->pCars;
   pSortIndices = pLeaderBoard->pSortIndices;
   bestLap = pLeaderBoard->type != race_SPRINT && pLeaderBoard->type != race_GP;
-#ifdef WIN64
-  if (bestLap) {
-    qsort_s(pSortIndices, pLeaderBoard->cars, sizeof(int), compareCarStatusBestLap, pCars);
-  } else {
-    qsort_s(pSortIndices, pLeaderBoard->cars, sizeof(int), compareCarStatus, pCars);
-  }
-#else
-  if (bestLap) {
-    qsort_r(pSortIndices, pLeaderBoard->cars, sizeof(int), compareCarStatusBestLap, pCars);
-  } else {
-    qsort_r(pSortIndices, pLeaderBoard->cars, sizeof(int), compareCarStatus, pCars);
-  }
-#endif
+  sortLeaderBoard(pLeaderBoard);
 
-  wattron(pWindow, A_BOLD);
-  mvwprintw(pWindow, 1, 1, "Pos  Car's name             Lap #    S1 time   S2 time   S3 time   Best lap time   %s",
-            bestLap ? "Best lap" : "Pits   Total time");
-  wattroff(pWindow, A_BOLD);
+  if (pLeaderBoard->fullRedraw) {
+    wattron(pWindow, A_BOLD);
+    mvwprintw(pWindow, 1, 1, "Pos  Car's name             Lap #    S1 time   S2 time   S3 time   Best lap time   %s",
+              bestLap ? "Best lap" : "Pits   Total time");
+    wattroff(pWindow, A_BOLD);
+    for (i = 0; i < MAX_DRIVERS; i++) {
+      pLeaderBoard->pRows[i].car = -1;
+    }
+  }
 
+  // only rows whose car moved or whose displayed cells changed are sent to the terminal
+  redrawn = 0;
   for (i = 0; i < pLeaderBoard->cars; i++) {
-    mvwprintw(pWindow, i + 3, 1, "%3d", i + 1);
-
-    pCar = &pCars[pSortIndices[i]];
-    if (pCar->active == false) {
-      wattron(pWindow, COLOR_PAIR(3));
-      mvwprintw(pWindow, i + 3, 6, "%-20.20s", pCtx->ppCsvDrivers[pCar->cardId]->ppFields[1]);
-      wattroff(pWindow, COLOR_PAIR(3));
+    car = pSortIndices[i];
+    pRow = &pLeaderBoard->pRows[i];
+    if (pRow->car == car && (dirtyCars & (1u << car)) == 0) {
       continue;
     }
 
-    event = pCar->lastEvent;
-    if (event == event_PIT_START) {
-      wattron(pWindow, COLOR_PAIR(4));
+    makeLeaderBoardRow(&row, car, &pCars[car]);
+    if (sameLeaderBoardRow(pRow, &row)) {
+      continue;
     }
 
-    wattron(pWindow, A_BOLD);
-    mvwprintw(pWindow, i + 3, 6, "%-20.20s", pCtx->ppCsvDrivers[pCar->cardId]->ppFields[1]);
-    wattroff(pWindow, A_BOLD);
+    *pRow = row;
+    displayLeaderBoardRow(pCtx, pWindow, i, pRow, &pCars[car], bestLap);
+    redrawn++;
+  }
 
-    if (event == event_END) {
-      mvwprintw(pWindow, i + 3, 29, "  *");
-    } else {
-      mvwprintw(pWindow, i + 3, 29, "%3d", pCar->currentLap + 1);
-    }
+  pLeaderBoard->dirtyCars = 0;
+  pLeaderBoard->fullRedraw = false;
 
-    if (event == event_START || event == event_S3) {
-      wattron(pWindow, COLOR_PAIR(2));
-    }
-    mvwprintw(pWindow, i + 3, 35, "%9s", timestampToSecond(pCar->s1Time, pDisplay, sizeof(pDisplay)));
-    if (event == event_START || event == event_S3) {
-      wattroff(pWindow, COLOR_PAIR(2));
-    }
-    if (event == event_S1) {
-      wattron(pWindow, COLOR_PAIR(2));
-    }
-    mvwprintw(pWindow, i + 3, 45, "%9s", timestampToSecond(pCar->s2Time, pDisplay, sizeof(pDisplay)));
-    if (event == event_S1) {
-      wattroff(pWindow, COLOR_PAIR(2));
-    }
-    if (event == event_S2 || event == event_PIT_END) {
-      wattron(pWindow, COLOR_PAIR(2));
-    }
-    mvwprintw(pWindow, i + 3, 55, "%9s", timestampToSecond(pCar->s3Time, pDisplay, sizeof(pDisplay)));
-    if (event == event_S2 || event == event_PIT_END) {
-      wattroff(pWindow, COLOR_PAIR(2));
-    }
+  if (redrawn > 0) {
+    pStats = &pLeaderBoard->stats;
+    mvwprintw(pWindow, 24, 1, "Frame: %6.2f ms   Latence: %7.2f ms (max %7.2f ms)", pStats->lastFrameTimeUs / 1000.0,
+              pStats->lastLatencyUs / 1000.0, pStats->maxLatencyUs / 1000.0);
+    wrefresh(pWindow);
+  }
 
-    mvwprintw(pWindow, i + 3, 69, "%10s", timestampToMinute(pCar->bestLapTime, pDisplay, sizeof(pDisplay)));
-    if (bestLap) {
-      mvwprintw(pWindow, i + 3, 84, "%5d", pCar->bestLap + 1);
-    } else {
-      mvwprintw(pWindow, i + 3, 80, "%5d  %15s", pCar->pits,
-                timestampToHour(pCar->totalLapsTime, pDisplay, sizeof(pDisplay)));
-    }
+  return RETURN_OK;
+}
 
-    if (event == event_PIT_START) {
-      wattroff(pWindow, COLOR_PAIR(4));
-    }
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int drawLeaderBoardFrame(Context *pCtx, LeaderBoard *pLeaderBoard, void *pUserData) {
+  return displayLeaderBoard(pCtx, pCtx->pWindow, pLeaderBoard);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool leaderBoardQuitRequested(Context *pCtx, void *pUserData) {
+  int key;
+
+  key = wgetch(pCtx->pWindow);
+
+  return key == 'q' || key == 'Q';
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int storeSession(Context *pCtx, LeaderBoard *pLeaderBoard) {
+  GrandPrix *pGrandPrix;
+  int code;
+
+  code = fillHistoric(pCtx, pLeaderBoard);
+  if (code) {
+    return code;
+  }
+
+  code = saveHistoric(pCtx);
+  if (code) {
+    return code;
+  }
+
+  // a failed export is caught up by the next one, the session is stored anyway
+  if (pCtx->pReportDirectory != NULL) {
+    saveSeasonReports(pCtx, pCtx->pReportDirectory, pCtx->reportThreads, false);
+  }
+
+  pGrandPrix = &pCtx->pGrandPrix[pCtx->currentGP];
+  if (pGrandPrix->nextStep == race_FINISHED && pCtx->currentGP + 1 < MAX_GP) {
+    pCtx->currentGP++;
+    initializeGP(pCtx, pCtx->currentGP, &pCtx->pGrandPrix[pCtx->currentGP]);
   }
-  wrefresh(pWindow);
 
   return RETURN_OK;
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-int processEvent(AcquireThreadCtx *pThreadCtx, EventRace *pEvent) {
-  CarStatus *pCar;
+int captureEvents(Context *pCtx, int choice, void *pUserData) {
+  CarStatus pCars[MAX_DRIVERS];
+  int pSortIndices[MAX_DRIVERS];
+  LeaderBoard leaderBoard;
+  GrandPrix *pGrandPrix;
+  LiveOutput output;
+  WINDOW *pWindow;
+  const GrandPrixInfo *pGrandPrixInfo;
+  int code;
 
-  assert(pEvent->car >= 0 && pEvent->car < MAX_DRIVERS);
+  pWindow = pCtx->pWindow;
+  pGrandPrix = &pCtx->pGrandPrix[pCtx->currentGP];
+  pGrandPrixInfo = &pCtx->pCalendar[pCtx->currentGP];
 
-  pCar = &pThreadCtx->pCarStatus[pEvent->car];
-  if (pCar->active == false) {
+  werase(pWindow);
+  if (pGrandPrix->nextStep == race_FINISHED) {
+    wattron(pWindow, COLOR_PAIR(3));
+    mvwprintw(pWindow, 10, 20, "Le championnat %d est termine", pCtx->gpYear);
+    wattroff(pWindow, COLOR_PAIR(3));
+    wrefresh(pWindow);
+    wgetch(pWindow);
     return RETURN_OK;
   }
 
-  switch (pEvent->event) {
-  case event_ERROR:
-    logger(log_ERROR, "an illegal event was received\n");
-    return RETURN_KO;
-  case event_START:
-    pCar->currentLap = 0;
-    break;
-  case event_S1:
-    pCar->s1Time = pEvent->timestamp - pCar->lastSegmentTS;
-    if (pCar->bestS1Time == 0 || pCar->bestS1Time > pCar->s1Time) {
-      pCar->bestS1Time = pCar->s1Time;
-    }
-    pCar->s2Time = 0;
-    pCar->totalLapsTime += pCar->s1Time;
-    pCar->pitTime = 0;
-    pCar->lastSegmentTS = pEvent->timestamp;
-    pCar->segments++;
-    break;
-  case event_S2:
-    pCar->s2Time = pEvent->timestamp - pCar->lastSegmentTS;
-    if (pCar->bestS2Time == 0 || pCar->bestS2Time > pCar->s2Time) {
-      pCar->bestS2Time = pCar->s2Time;
+  mvwprintw(pWindow, 25, 1, "%d %s/%s - %s: en attente des evenements sur le port %d ('q' pour quitter)",
+            pCtx->gpYear, pGrandPrixInfo->pName, pGrandPrixInfo->pCircuit, raceTypeToString(pGrandPrix->nextStep),
+            pCtx->listenPort);
+  wrefresh(pWindow);
+
+  memset(&leaderBoard, 0, sizeof(leaderBoard));
+  leaderBoard.pCars = pCars;
+  leaderBoard.pSortIndices = pSortIndices;
+
+  output.pDrawFrame = drawLeaderBoardFrame;
+  output.pQuitRequested = leaderBoardQuitRequested;
+  output.pUserData = NULL;
+
+  nodelay(pWindow, TRUE);
+  code = captureSession(pCtx, &leaderBoard, &output);
+  nodelay(pWindow, FALSE);
+
+  wmove(pWindow, 25, 1);
+  wclrtoeol(pWindow);
+  if (code == RETURN_OK) {
+    code = storeSession(pCtx, &leaderBoard);
+  }
+  if (code == RETURN_OK) {
+    mvwprintw(pWindow, 25, 1, "Les resultats de '%s' ont ete enregistres", raceTypeToString(leaderBoard.type));
+  } else {
+    wattron(pWindow, COLOR_PAIR(3));
+    mvwprintw(pWindow, 25, 1, "La capture de '%s' n'a pas abouti (voir stdout.log)",
+              raceTypeToString(leaderBoard.type));
+    wattroff(pWindow, COLOR_PAIR(3));
+  }
+  wrefresh(pWindow);
+  wgetch(pWindow);
+
+  return code;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void onStopSignal(int signalNumber) {
+  _stopRequested = 1;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool headlessQuitRequested(Context *pCtx, void *pUserData) {
+  return _stopRequested != 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int grandPrixHeadless(Context *pCtx, ProgramOptions *pOptions) {
+  CarStatus pCars[MAX_DRIVERS];
+  int pSortIndices[MAX_DRIVERS];
+  HeadlessOutput headlessOutput;
+  LeaderBoard leaderBoard;
+  LiveOutput output;
+  int code;
+
+  code = headlessOpen(&headlessOutput, pOptions->pOutputPath, pOptions->outputFormat, pOptions->snapshotIntervalMs);
+  if (code) {
+    return code;
+  }
+
+  signal(SIGINT, onStopSignal);
+  signal(SIGTERM, onStopSignal);
+
+  output.pDrawFrame = headlessDrawFrame;
+  output.pQuitRequested = headlessQuitRequested;
+  output.pUserData = &headlessOutput;
+
+  // captures the sessions one after the other until the season is over or the process is stopped
+  code = RETURN_OK;
+  while (!_stopRequested && pCtx->pGrandPrix[pCtx->currentGP].nextStep != race_FINISHED) {
+    memset(&leaderBoard, 0, sizeof(leaderBoard));
+    leaderBoard.pCars = pCars;
+    leaderBoard.pSortIndices = pSortIndices;
+
+    headlessStartSession(&headlessOutput);
+    code = captureSession(pCtx, &leaderBoard, &output);
+    if (code) {
+      break;
     }
-    pCar->s3Time = 0;
-    pCar->totalLapsTime += pCar->s2Time;
-    pCar->lastSegmentTS = pEvent->timestamp;
-    pCar->segments++;
-    break;
-  case event_S3:
-    pCar->s3Time = pEvent->timestamp - pCar->lastSegmentTS;
-    if (pCar->bestS3Time == 0 || pCar->bestS3Time > pCar->s3Time) {
-      pCar->bestS3Time = pCar->s3Time;
+    code = headlessEndSession(pCtx, &leaderBoard, &headlessOutput);
+    if (code) {
+      break;
     }
-    pCar->lastLapTime = pEvent->timestamp - pCar->startLapTimestamp;
-    if (pCar->bestLapTime == 0 || pCar->bestLapTime > pCar->lastLapTime) {
-      pCar->bestLapTime = pCar->lastLapTime;
-      pCar->bestLap = pCar->currentLap;
+    code = storeSession(pCtx, &leaderBoard);
+    if (code) {
+      break;
     }
-    pCar->s1Time = 0;
-    pCar->currentLap = pEvent->lap + 1;
-    pCar->startLapTimestamp = pEvent->timestamp;
-    pCar->totalLapsTime += pCar->s3Time;
-    pCar->lastSegmentTS = pEvent->timestamp;
-    pCar->segments++;
-    break;
-  case event_OUT:
-    pCar->active = false;
-    break;
-  case event_END:
-    break;
-  case event_PIT_START:
-    break;
-  case event_PIT_END:
-    pCar->pits++;
-    pCar->pitTime = pEvent->timestamp - pCar->lastEventTS;
-    pCar->totalPitsTime += pCar->pitTime;
-    break;
   }
 
-  pCar->lastEvent = pEvent->event;
-  pCar->lastEventTS = pEvent->timestamp;
+  headlessClose(&headlessOutput);
 
-  return RETURN_OK;
+  return _stopRequested ? RETURN_OK : code;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int exportColumns(Context *pCtx, const char *pFileName) {
+  ResultColumns columns;
+  int code;
+
+  code = buildResultColumns(pCtx->pGrandPrix, pCtx->gpYear, &columns);
+  if (code) {
+    return code;
+  }
+
+  code = saveResultColumns(&columns, pFileName);
+  if (code == RETURN_OK) {
+    logger(log_INFO, "%d results of %d written to %s\n", columns.rows, pCtx->gpYear, pFileName);
+  }
+  freeResultColumns(&columns);
+
+  return code;
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+int exportProjection(Context *pCtx, const char *pFileName, uint64_t seasons, int threads) {
+  ProjectionModel model;
+  Projection projection;
+  FormModel formModel;
+  int code;
+
+  buildFormModel(pCtx->pGrandPrix, &formModel, &model);
+  code = projectChampionship(pCtx, &model, seasons, threads, (uint64_t)time(NULL), &projection);
+  if (code) {
+    return code;
+  }
+
+  return saveProjection(pCtx, &projection, pFileName);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Scores the stored results of the season under every rule set of Scoring.csv, one column per rule set
+int exportRescoring(Context *pCtx, const char *pFileName) {
+  StandingsPoints *pStandings;
+  char pPoints[16];
+  const DriverInfo *pDriver;
+  FILE *pFile;
+  int carId;
+  int rules;
+
+  pStandings = (StandingsPoints *)malloc(sizeof(StandingsPoints) * pCtx->ruleSets);
+  if (pStandings == NULL) {
+    logger(log_FATAL, "unable to allocate the standings of %d rule sets.\n", pCtx->ruleSets);
+    return RETURN_KO;
+  }
+  for (rules = 0; rules < pCtx->ruleSets; rules++) {
+    computeStandings(&pCtx->pRuleSets[rules], pCtx->pGrandPrix, &pStandings[rules]);
+  }
+
+  pFile = fopen(pFileName, "w");
+  if (pFile == NULL) {
+    logger(log_ERROR, "unable to create file %s, errno=%d\n", pFileName, errno);
+    free(pStandings);
+    return RETURN_KO;
+  }
+
+  fprintf(pFile, "Number,Driver,Team");
+  for (rules = 0; rules < pCtx->ruleSets; rules++) {
+    fprintf(pFile, ",%s", pCtx->pRuleSets[rules].pName);
+  }
+  fprintf(pFile, "\n");
+  for (carId = 0; carId < MAX_DRIVERS; carId++) {
+    pDriver = &pCtx->pDrivers[carId];
+    fprintf(pFile, "%s,%s,%s", pDriver->pNumber, pDriver->pName, pDriver->pTeam);
+    for (rules = 0; rules < pCtx->ruleSets; rules++) {
+      fprintf(pFile, ",%s", pointsToString(pStandings[rules].pPoints[carId], pPoints, sizeof(pPoints)));
+    }
+    fprintf(pFile, "\n");
+  }
+  fclose(pFile);
+  free(pStandings);
+
+  logger(log_INFO, "season %d scored under %d rule sets in %s\n", pCtx->gpYear, pCtx->ruleSets, pFileName);
+
+  return RETURN_OK;
+}
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -1319,20 +1715,67 @@ int grandPrixCore(ProgramOptions *pOptions) {
   Context ctx;
   int code;
 
+  memset(&ctx, 0, sizeof(ctx));
   code = readConfiguration(&ctx);
   if (code) {
     return code;
   }
   ctx.speedFactor = pOptions->speedFactor;
   ctx.gpYear = pOptions->gpYear;
+  ctx.pListenAddress = pOptions->pListenAddress;
+  ctx.listenPort = pOptions->listenPort;
+  ctx.targetFps = pOptions->targetFps;
+
+  code = loadScoringRules(&ctx, SCORING_FILENAME, pOptions->pScoringName);
+  if (code) {
+    return code;
+  }
 
   code = readHistoric(&ctx);
   if (code) {
     return code;
   }
 
-  //code = startListening(&ctx, pOptions);
+#ifdef WIN64
+  WSADATA info;
 
+  if (WSAStartup(MAKEWORD(1, 1), &info) != 0) {
+    logger(log_ERROR, "unable to initialize Windows Socket API, code=%d\n", WSAGetLastError());
+    return RETURN_KO;
+  }
+#endif
+
+  if (pOptions->pColumnsPath != NULL) {
+    code = exportColumns(&ctx, pOptions->pColumnsPath);
+    goto grandPrixCoreExit;
+  }
+
+  if (pOptions->pRescorePath != NULL) {
+    code = exportRescoring(&ctx, pOptions->pRescorePath);
+    goto grandPrixCoreExit;
+  }
+
+  if (pOptions->pProjectionPath != NULL) {
+    code = exportProjection(&ctx, pOptions->pProjectionPath, pOptions->projectionSeasons, pOptions->threads);
+    goto grandPrixCoreExit;
+  }
+
+  if (pOptions->pExportPath != NULL) {
+    code = exportSeasons(&ctx, pOptions->pExportPath, pOptions->exportFormat);
+    goto grandPrixCoreExit;
+  }
+
+  if (pOptions->pSeasonPath != NULL && !pOptions->headless) {
+    code = saveSeasonReports(&ctx, pOptions->pSeasonPath, pOptions->threads, false);
+    goto grandPrixCoreExit;
+  }
+
+  if (pOptions->headless) {
+    ctx.pReportDirectory = pOptions->pSeasonPath;
+    ctx.reportThreads = pOptions->threads;
+    code = grandPrixHeadless(&ctx, pOptions);
+    goto grandPrixCoreExit;
+  }
 
   initscr();
   start_color();
@@ -1348,20 +1791,25 @@ int grandPrixCore(ProgramOptions *pOptions) {
   code = 0;
   while (true) {
     code = displayMenu(&ctx, pMainMenu, false, code, NULL);
-    if (code == 6) {
+    if (code == 10) {
       break;
     }
   }
 
   delwin(pWindow);
   endwin();
+  code = RETURN_OK;
 
-  //stopListening(&ctx);
-
+grandPrixCoreExit:
   freeHistoric(&ctx);
+  freeScoringRules(&ctx);
   freeConfiguration(&ctx);
 
-  return RETURN_OK;
+#ifdef WIN64
+  WSACleanup();
+#endif
+
+  return code;
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
@@ -1374,9 +1822,93 @@ int main(int argc, char *ppArgv[]) {
   memset(&options, 0, sizeof(options));
   options.gpYear = 2025;
   options.speedFactor = 0;
-
-  while ((opt = getopt(argc, ppArgv, "al:p:s:y:h?")) != -1) {
+  options.listenPort = DEFAULT_LISTEN_PORT;
+  options.targetFps = DEFAULT_TARGET_FPS;
+  options.outputFormat = headless_JSON;
+  options.exportFormat = export_NDJSON;
+  options.snapshotIntervalMs = DEFAULT_SNAPSHOT_INTERVAL_MS;
+  options.projectionSeasons = PROJECTION_DEFAULT_SEASONS;
+
+  while ((opt = getopt_long(argc, ppArgv, "af:l:o:p:s:y:h?", pLongOptions, NULL)) != -1) {
     switch (opt) {
+    case 'H':
+      options.headless = true;
+      break;
+    case 'o':
+      options.pOutputPath = optarg;
+      break;
+    case OPTION_FORMAT:
+      if (strcasecmp(optarg, "json") == 0) {
+        options.outputFormat = headless_JSON;
+      } else if (strcasecmp(optarg, "binary") == 0) {
+        options.outputFormat = headless_BINARY;
+      } else {
+        printf("ERROR: illegal output format '%s'. Valid values are 'json' and 'binary'.\n", optarg);
+        return EXIT_FAILURE;
+      }
+      break;
+    case OPTION_EXPORT_COLUMNS:
+      options.pColumnsPath = optarg;
+      break;
+    case OPTION_PROJECTION:
+      options.pProjectionPath = optarg;
+      break;
+    case OPTION_SEASONS:
+      options.projectionSeasons = strtoull(optarg, NULL, 10);
+      if (options.projectionSeasons < 1) {
+        options.projectionSeasons = 1;
+      }
+      break;
+    case OPTION_SCORING:
+      options.pScoringName = optarg;
+      break;
+    case OPTION_RESCORE:
+      options.pRescorePath = optarg;
+      break;
+    case OPTION_EXPORT_SEASON:
+      options.pSeasonPath = optarg;
+      break;
+    case OPTION_EXPORT:
+      options.pExportPath = optarg;
+      break;
+    case OPTION_EXPORT_FORMAT:
+      if (strcasecmp(optarg, "csv") == 0) {
+        options.exportFormat = export_CSV;
+      } else if (strcasecmp(optarg, "ndjson") == 0) {
+        options.exportFormat = export_NDJSON;
+      } else if (strcasecmp(optarg, "binary") == 0) {
+        options.exportFormat = export_BINARY;
+      } else {
+        printf("ERROR: illegal export format '%s'. Valid values are 'csv', 'ndjson' and 'binary'.\n", optarg);
+        return EXIT_FAILURE;
+      }
+      break;
+    case OPTION_THREADS:
+      options.threads = atoi(optarg);
+      if (options.threads < 0) {
+        options.threads = 0;
+      }
+      break;
+    case OPTION_SNAPSHOT:
+      options.snapshotIntervalMs = atoi(optarg);
+      if (options.snapshotIntervalMs < 0) {
+        options.snapshotIntervalMs = 0;
+      }
+      break;
+    case 'f':
+      options.targetFps = atoi(optarg);
+      if (options.targetFps < 1) {
+        options.targetFps = 1;
+      } else if (options.targetFps > MAX_TARGET_FPS) {
+        options.targetFps = MAX_TARGET_FPS;
+      }
+      break;
+    case 'l':
+      options.pListenAddress = optarg;
+      break;
+    case 'p':
+      options.listenPort = atoi(optarg);
+      break;
     case 's':
       options.speedFactor = atoi(optarg);
       if (options.speedFactor < 0) {
@@ -0,0 +1,199 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+
+#include "headless.h"
+#include "util.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int headlessOpen(HeadlessOutput *pOutput, const char *pPath, HeadlessFormat format, int snapshotIntervalMs) {
+  memset(pOutput, 0, sizeof(HeadlessOutput));
+  pOutput->format = format;
+  pOutput->snapshotIntervalMs = snapshotIntervalMs;
+
+  if (pPath == NULL || strcmp(pPath, "-") == 0) {
+    pOutput->pFile = stdout;
+    return RETURN_OK;
+  }
+
+  pOutput->pFile = fopen(pPath, format == headless_BINARY ? "ab" : "a");
+  if (pOutput->pFile == NULL) {
+    logger(log_ERROR, "unable to open headless output '%s', errno=%d\n", pPath, errno);
+    return RETURN_KO;
+  }
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void headlessClose(HeadlessOutput *pOutput) {
+  if (pOutput->pFile != NULL && pOutput->pFile != stdout) {
+    fclose(pOutput->pFile);
+  }
+  pOutput->pFile = NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void headlessStartSession(HeadlessOutput *pOutput) {
+  pOutput->sessionStartUs = monotonicMicros();
+  pOutput->lastSnapshotUs = 0;
+  memset(pOutput->pPositions, 0, sizeof(pOutput->pPositions));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void writeRecordHeader(Context *pCtx, LeaderBoard *pLeaderBoard, HeadlessOutput *pOutput, HeadlessRecordType type,
+                       int count, uint32_t elapsedMs) {
+  HeadlessRecordHeader header;
+
+  header.magic = HEADLESS_RECORD_MAGIC;
+  header.type = (uint16_t)type;
+  header.count = (uint16_t)count;
+  header.year = pCtx->gpYear;
+  header.grandPrixId = pLeaderBoard->grandPrixId;
+  header.raceType = pLeaderBoard->type;
+  header.elapsedMs = elapsedMs;
+  fwrite(&header, sizeof(header), 1, pOutput->pFile);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void writeSnapshot(Context *pCtx, LeaderBoard *pLeaderBoard, HeadlessOutput *pOutput, uint32_t elapsedMs) {
+  HeadlessCarRecord record;
+  CarStatus *pCar;
+  FILE *pFile;
+  int i;
+
+  pFile = pOutput->pFile;
+  if (pOutput->format == headless_BINARY) {
+    writeRecordHeader(pCtx, pLeaderBoard, pOutput, record_SNAPSHOT, pLeaderBoard->cars, elapsedMs);
+    for (i = 0; i < pLeaderBoard->cars; i++) {
+      pCar = &pLeaderBoard->pCars[pLeaderBoard->pSortIndices[i]];
+      record.position = i + 1;
+      record.carId = pCar->cardId;
+      record.active = pCar->active;
+      record.lap = pCar->currentLap;
+      record.lastEvent = pCar->lastEvent;
+      record.s1Time = pCar->s1Time;
+      record.s2Time = pCar->s2Time;
+      record.s3Time = pCar->s3Time;
+      record.bestLapTime = pCar->bestLapTime;
+      record.bestLap = pCar->bestLap;
+      record.pits = pCar->pits;
+      record.totalPitsTime = pCar->totalPitsTime;
+      record.totalLapsTime = pCar->totalLapsTime;
+      fwrite(&record, sizeof(record), 1, pFile);
+    }
+    return;
+  }
+
+  fprintf(pFile, "{\"type\":\"snapshot\",\"year\":%d,\"gp\":%d,\"race\":\"%s\",\"elapsedMs\":%u,\"cars\":[",
+          pCtx->gpYear, pLeaderBoard->grandPrixId + 1, raceTypeToString(pLeaderBoard->type), elapsedMs);
+  for (i = 0; i < pLeaderBoard->cars; i++) {
+    pCar = &pLeaderBoard->pCars[pLeaderBoard->pSortIndices[i]];
+    fprintf(pFile,
+            "%s{\"pos\":%d,\"car\":%d,\"number\":\"%s\",\"active\":%s,\"lap\":%d,\"s1\":%d,\"s2\":%d,\"s3\":%d,"
+            "\"bestLapTime\":%u,\"bestLap\":%d,\"pits\":%d,\"pitsTime\":%u,\"totalTime\":%u}",
+            i > 0 ? "," : "", i + 1, pCar->cardId, pCtx->pDrivers[pCar->cardId].pNumber,
+            pCar->active ? "true" : "false", pCar->currentLap, pCar->s1Time, pCar->s2Time, pCar->s3Time,
+            pCar->bestLapTime, pCar->bestLap + 1, pCar->pits, pCar->totalPitsTime, pCar->totalLapsTime);
+  }
+  fprintf(pFile, "]}\n");
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void writePositionChange(Context *pCtx, LeaderBoard *pLeaderBoard, HeadlessOutput *pOutput, uint32_t elapsedMs,
+                         int carId, int from, int to) {
+  HeadlessPositionRecord record;
+
+  if (pOutput->format == headless_BINARY) {
+    writeRecordHeader(pCtx, pLeaderBoard, pOutput, record_POSITION, 1, elapsedMs);
+    record.carId = carId;
+    record.from = from;
+    record.to = to;
+    fwrite(&record, sizeof(record), 1, pOutput->pFile);
+    return;
+  }
+
+  fprintf(pOutput->pFile,
+          "{\"type\":\"position\",\"year\":%d,\"gp\":%d,\"race\":\"%s\",\"elapsedMs\":%u,\"car\":%d,\"number\":\"%s\","
+          "\"from\":%d,\"to\":%d}\n",
+          pCtx->gpYear, pLeaderBoard->grandPrixId + 1, raceTypeToString(pLeaderBoard->type), elapsedMs, carId,
+          pCtx->pDrivers[carId].pNumber, from, to);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int headlessDrawFrame(Context *pCtx, LeaderBoard *pLeaderBoard, void *pUserData) {
+  HeadlessOutput *pOutput;
+  uint32_t elapsedMs;
+  uint64_t now;
+  int position;
+  int car;
+  int i;
+
+  pOutput = (HeadlessOutput *)pUserData;
+  if (pLeaderBoard->dirtyCars == 0 && !pLeaderBoard->fullRedraw) {
+    return RETURN_OK;
+  }
+
+  sortLeaderBoard(pLeaderBoard);
+  now = monotonicMicros();
+  elapsedMs = (uint32_t)((now - pOutput->sessionStartUs) / 1000);
+
+  // the first frame only records the starting order
+  for (i = 0; i < pLeaderBoard->cars; i++) {
+    car = pLeaderBoard->pSortIndices[i];
+    position = pOutput->pPositions[car];
+    if (position != 0 && position != i + 1) {
+      writePositionChange(pCtx, pLeaderBoard, pOutput, elapsedMs, car, position, i + 1);
+    }
+    pOutput->pPositions[car] = i + 1;
+  }
+
+  if (pOutput->lastSnapshotUs == 0 || now - pOutput->lastSnapshotUs >= (uint64_t)pOutput->snapshotIntervalMs * 1000) {
+    writeSnapshot(pCtx, pLeaderBoard, pOutput, elapsedMs);
+    pOutput->lastSnapshotUs = now;
+  }
+  fflush(pOutput->pFile);
+
+  pLeaderBoard->dirtyCars = 0;
+  pLeaderBoard->fullRedraw = false;
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int headlessEndSession(Context *pCtx, LeaderBoard *pLeaderBoard, HeadlessOutput *pOutput) {
+  uint32_t elapsedMs;
+
+  // captureSession() leaves the board sorted on the final state
+  elapsedMs = (uint32_t)((monotonicMicros() - pOutput->sessionStartUs) / 1000);
+  writeSnapshot(pCtx, pLeaderBoard, pOutput, elapsedMs);
+
+  if (pOutput->format == headless_BINARY) {
+    writeRecordHeader(pCtx, pLeaderBoard, pOutput, record_SESSION_END, 0, elapsedMs);
+  } else {
+    fprintf(pOutput->pFile,
+            "{\"type\":\"end\",\"year\":%d,\"gp\":%d,\"race\":\"%s\",\"elapsedMs\":%u,\"events\":%d,\"frames\":%d}\n",
+            pCtx->gpYear, pLeaderBoard->grandPrixId + 1, raceTypeToString(pLeaderBoard->type), elapsedMs,
+            pLeaderBoard->events, pLeaderBoard->stats.frames);
+  }
+
+  if (fflush(pOutput->pFile) != 0) {
+    logger(log_ERROR, "unable to write to headless output, errno=%d\n", errno);
+    return RETURN_KO;
+  }
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
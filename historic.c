@@ -0,0 +1,688 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifdef WIN64
+#include <io.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "historic.h"
+#include "util.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define HISTORIC_RECORDS_SIZE (MAX_GP * sizeof(GrandPrix))
+#define HISTORIC_FILE_SIZE (HISTORIC_RECORDS_OFFSET + HISTORIC_RECORDS_SIZE)
+#define RECORD_OFFSET(grandPrixId) ((off_t)HISTORIC_RECORDS_OFFSET + (off_t)(grandPrixId) * sizeof(GrandPrix))
+#define JOURNAL_ENTRY_SIZE(version) ((version) == 1 ? offsetof(JournalEntry, standings) : sizeof(JournalEntry))
+
+// the records are mapped as they are stored, so the layout is checked at compile time
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "the historic file is little-endian and its records are used in place"
+#endif
+_Static_assert(sizeof(HistoricHeader) == HISTORIC_HEADER_SIZE, "HistoricHeader layout");
+_Static_assert(sizeof(StandingsPoints) == 128, "StandingsPoints layout");
+_Static_assert(sizeof(RaceInfo) == 36, "RaceInfo layout");
+_Static_assert(sizeof(Race) == 4 + MAX_DRIVERS * 36, "Race layout");
+_Static_assert(offsetof(GrandPrix, nextStep) == 8 && offsetof(GrandPrix, pPractices) == 12, "GrandPrix layout");
+_Static_assert(sizeof(GrandPrix) == 12 + 11 * sizeof(Race), "GrandPrix layout");
+
+#ifdef WIN64
+#define fdatasync(handle) _commit(handle)
+#endif
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static int writeAt(int fileHandle, off_t offset, const void *pData, size_t size) {
+  const char *pBytes;
+  ssize_t code;
+
+  pBytes = (const char *)pData;
+#ifdef WIN64
+  if (lseek(fileHandle, offset, SEEK_SET) == -1) {
+    return RETURN_KO;
+  }
+#endif
+  while (size > 0) {
+#ifdef WIN64
+    code = write(fileHandle, pBytes, size);
+#else
+    code = pwrite(fileHandle, pBytes, size, offset);
+#endif
+    if (code <= 0) {
+      return RETURN_KO;
+    }
+    pBytes += code;
+    offset += code;
+    size -= code;
+  }
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Returns the number of bytes read, less than size at the end of the file, or -1
+static ssize_t readAt(int fileHandle, off_t offset, void *pData, size_t size) {
+  char *pBytes;
+  ssize_t total;
+  ssize_t code;
+
+  pBytes = (char *)pData;
+  total = 0;
+#ifdef WIN64
+  if (lseek(fileHandle, offset, SEEK_SET) == -1) {
+    return -1;
+  }
+#endif
+  while ((size_t)total < size) {
+#ifdef WIN64
+    code = read(fileHandle, pBytes + total, size - total);
+#else
+    code = pread(fileHandle, pBytes + total, size - total, offset + total);
+#endif
+    if (code < 0) {
+      return -1;
+    }
+    if (code == 0) {
+      break;
+    }
+    total += code;
+  }
+
+  return total;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef WIN64
+
+// No mmap() with MinGW: the file is copied in memory
+static char *mapHistoric(int fileHandle, const char *pFileName, bool readOnly) {
+  char *pBase;
+
+  pBase = (char *)calloc(1, HISTORIC_FILE_SIZE);
+  if (pBase == NULL) {
+    logger(log_FATAL, "unable to allocate %d bytes for GrandPrix table.\n", (int)HISTORIC_FILE_SIZE);
+    return NULL;
+  }
+
+  if (readAt(fileHandle, 0, pBase, HISTORIC_FILE_SIZE) != (ssize_t)HISTORIC_FILE_SIZE) {
+    logger(log_ERROR, "an error has occurred while reading file %s\n", pFileName);
+    free(pBase);
+    return NULL;
+  }
+
+  return pBase;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void unmapHistoric(char *pBase) {
+  free(pBase);
+}
+
+#else
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Private mapping: the pages modified by the program are never written back, only committed records reach the file.
+// A read-only mapping is shared and follows the commits of the program owning the season.
+static char *mapHistoric(int fileHandle, const char *pFileName, bool readOnly) {
+  void *pMapping;
+
+  pMapping = mmap(NULL, HISTORIC_FILE_SIZE, readOnly ? PROT_READ : PROT_READ | PROT_WRITE,
+                  readOnly ? MAP_SHARED : MAP_PRIVATE, fileHandle, 0);
+  if (pMapping == MAP_FAILED) {
+    logger(log_ERROR, "unable to map file %s, errno=%d\n", pFileName, errno);
+    return NULL;
+  }
+
+  return (char *)pMapping;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void unmapHistoric(char *pBase) {
+  munmap(pBase, HISTORIC_FILE_SIZE);
+}
+
+#endif
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static uint32_t journalHeaderCrc(JournalHeader *pHeader) {
+  JournalHeader header;
+
+  header = *pHeader;
+  header.crc = 0;
+
+  return crc32Update(0, &header, sizeof(header));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Empties the journal once every record it holds is synced in the historic file
+static int checkpointHistoric(Context *pCtx) {
+  JournalHeader header;
+
+  if (fdatasync(pCtx->gpHistoricHandle) == -1) {
+    logger(log_ERROR, "unable to sync historic file, errno=%d\n", errno);
+    return RETURN_KO;
+  }
+
+  memset(&header, 0, sizeof(header));
+  header.magic = HISTORIC_JOURNAL_MAGIC;
+  header.version = HISTORIC_JOURNAL_VERSION;
+  header.recordSize = sizeof(GrandPrix);
+  header.generation = pCtx->gpGeneration;
+  header.crc = journalHeaderCrc(&header);
+
+  // a crash between the two writes only replays entries already in the historic file
+  if (writeAt(pCtx->gpJournalHandle, 0, &header, sizeof(header)) != RETURN_OK ||
+      ftruncate(pCtx->gpJournalHandle, sizeof(header)) == -1 || fdatasync(pCtx->gpJournalHandle) == -1) {
+    logger(log_ERROR, "unable to reset historic journal, errno=%d\n", errno);
+    return RETURN_KO;
+  }
+  pCtx->gpJournalEntries = 0;
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Applies the complete entries of the journal, a torn or stale entry ends it
+static int replayJournal(Context *pCtx, const char *pJournalName) {
+  JournalHeader header;
+  JournalEntry *pEntry;
+  size_t entrySize;
+  uint32_t crc;
+  ssize_t code;
+  off_t offset;
+  int replayed;
+
+  code = readAt(pCtx->gpJournalHandle, 0, &header, sizeof(header));
+  if (code == 0) {
+    return checkpointHistoric(pCtx);
+  }
+  if (code != sizeof(header) || header.magic != HISTORIC_JOURNAL_MAGIC || header.crc != journalHeaderCrc(&header) ||
+      header.version < 1 || header.version > HISTORIC_JOURNAL_VERSION || header.recordSize != sizeof(GrandPrix)) {
+    // only a checkpoint rewrites the header, after the historic file has been synced
+    logger(log_WARN, "invalid historic journal header in %s, journal ignored\n", pJournalName);
+    return checkpointHistoric(pCtx);
+  }
+
+  pEntry = (JournalEntry *)malloc(sizeof(JournalEntry));
+  if (pEntry == NULL) {
+    logger(log_FATAL, "unable to allocate %d bytes for historic journal.\n", (int)sizeof(JournalEntry));
+    return RETURN_KO;
+  }
+
+  entrySize = JOURNAL_ENTRY_SIZE(header.version);
+  pCtx->gpGeneration = header.generation;
+  offset = sizeof(header);
+  replayed = 0;
+  while (true) {
+    code = readAt(pCtx->gpJournalHandle, offset, pEntry, entrySize);
+    if (code != (ssize_t)entrySize) {
+      break;
+    }
+    crc = pEntry->crc;
+    pEntry->crc = 0;
+    if (pEntry->magic != HISTORIC_JOURNAL_MAGIC || crc != crc32Update(0, pEntry, entrySize) ||
+        pEntry->generation != pCtx->gpGeneration + 1 || pEntry->grandPrixId < 0 || pEntry->grandPrixId >= MAX_GP) {
+      logger(log_WARN, "incomplete entry at offset %ld of %s, ignored\n", (long)offset, pJournalName);
+      break;
+    }
+
+    // a version 1 entry has no standings, readHistoric() recomputes the ones left at 0
+    memcpy(&pCtx->pGrandPrix[pEntry->grandPrixId], &pEntry->grandPrix, sizeof(GrandPrix));
+    if (header.version == 1) {
+      memset(&pEntry->standings, 0, sizeof(StandingsPoints));
+    }
+    memcpy(pCtx->pStandings, &pEntry->standings, sizeof(StandingsPoints));
+    code = writeAt(pCtx->gpHistoricHandle, RECORD_OFFSET(pEntry->grandPrixId), &pEntry->grandPrix, sizeof(GrandPrix));
+    if (code == RETURN_OK) {
+      code = writeAt(pCtx->gpHistoricHandle, HISTORIC_STANDINGS_OFFSET, pCtx->pStandings, sizeof(StandingsPoints));
+    }
+    if (code != RETURN_OK) {
+      logger(log_ERROR, "an error has occurred while writing to historic file, errno=%d\n", errno);
+      free(pEntry);
+      return RETURN_KO;
+    }
+    pCtx->gpGeneration = pEntry->generation;
+    offset += entrySize;
+    replayed++;
+  }
+  free(pEntry);
+
+  if (replayed > 0) {
+    logger(log_INFO, "%d record(s) recovered from %s, generation %llu\n", replayed, pJournalName,
+           (unsigned long long)pCtx->gpGeneration);
+  }
+
+  return checkpointHistoric(pCtx);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void makeHistoricHeader(HistoricHeader *pHeader, int year) {
+  memset(pHeader, 0, sizeof(HistoricHeader));
+  pHeader->magic = HISTORIC_MAGIC;
+  pHeader->version = HISTORIC_VERSION;
+  pHeader->headerSize = HISTORIC_HEADER_SIZE;
+  pHeader->year = year;
+  pHeader->recordSize = sizeof(GrandPrix);
+  pHeader->recordCount = MAX_GP;
+  pHeader->standingsOffset = HISTORIC_STANDINGS_OFFSET;
+  pHeader->recordsOffset = HISTORIC_RECORDS_OFFSET;
+  pHeader->crc = crc32Update(0, pHeader, sizeof(HistoricHeader));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+uint32_t historicCalendarCrc(const Context *pCtx) {
+  const char *pCircuit;
+  uint32_t crc;
+  int i;
+
+  crc = 0;
+  for (i = 0; i < MAX_GP; i++) {
+    pCircuit = pCtx->pCalendar[i].pCircuit != NULL ? pCtx->pCalendar[i].pCircuit : "";
+    // the '\0' separates the names
+    crc = crc32Update(crc, pCircuit, strlen(pCircuit) + 1);
+  }
+  // 0 is kept for the seasons stored without their calendar
+  return crc == 0 ? 1 : crc;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The driver numbers and the calendar of the configuration are recorded in a header without them. A season already
+// recorded keeps its own, the catalog reads it with them.
+static int recordHistoricMapping(Context *pCtx, int fileHandle, HistoricHeader *pHeader, const char *pFileName) {
+  uint8_t pCarNumbers[MAX_DRIVERS];
+  uint32_t calendarCrc;
+  int number;
+  int i;
+
+  calendarCrc = historicCalendarCrc(pCtx);
+  for (i = 0; i < MAX_DRIVERS; i++) {
+    number = pCtx->pDrivers[i].number;
+    pCarNumbers[i] = number >= 0 && number <= UINT8_MAX ? number : 0;
+  }
+
+  if (pHeader->calendarCrc != 0) {
+    if (pHeader->calendarCrc != calendarCrc || memcmp(pHeader->pCarNumbers, pCarNumbers, MAX_DRIVERS) != 0) {
+      logger(log_WARN, "file %s was stored with another calendar or other driver numbers, kept for the catalog\n",
+             pFileName);
+    }
+    return RETURN_OK;
+  }
+
+  pHeader->calendarCrc = calendarCrc;
+  memcpy(pHeader->pCarNumbers, pCarNumbers, MAX_DRIVERS);
+  pHeader->crc = 0;
+  pHeader->crc = crc32Update(0, pHeader, sizeof(HistoricHeader));
+  if (writeAt(fileHandle, 0, pHeader, sizeof(HistoricHeader)) != RETURN_OK) {
+    logger(log_ERROR, "an error has occurred while writing to file %s, errno=%d\n", pFileName, errno);
+    return RETURN_KO;
+  }
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static int checkHistoricHeader(HistoricHeader *pHeader, const char *pFileName, int year) {
+  HistoricHeader header;
+
+  header = *pHeader;
+  header.crc = 0;
+  if (pHeader->crc != crc32Update(0, &header, sizeof(header))) {
+    logger(log_ERROR, "file %s has a corrupted header\n", pFileName);
+    return RETURN_KO;
+  }
+  if (pHeader->version > HISTORIC_VERSION) {
+    logger(log_ERROR, "file %s has version %d, this program only reads up to version %d\n", pFileName,
+           pHeader->version, HISTORIC_VERSION);
+    return RETURN_KO;
+  }
+  if (pHeader->headerSize != HISTORIC_HEADER_SIZE || pHeader->recordSize != sizeof(GrandPrix) ||
+      pHeader->recordCount != MAX_GP) {
+    logger(log_ERROR, "file %s has an unexpected layout: header %d, %d records of %d bytes\n", pFileName,
+           pHeader->headerSize, pHeader->recordCount, pHeader->recordSize);
+    return RETURN_KO;
+  }
+  if (pHeader->version == HISTORIC_VERSION && (pHeader->standingsOffset != HISTORIC_STANDINGS_OFFSET ||
+                                                pHeader->recordsOffset != HISTORIC_RECORDS_OFFSET)) {
+    logger(log_ERROR, "file %s has an unexpected layout: standings at %d, records at %d\n", pFileName,
+           pHeader->standingsOffset, pHeader->recordsOffset);
+    return RETURN_KO;
+  }
+  if (pHeader->year != year) {
+    logger(log_ERROR, "file %s holds year %d instead of %d\n", pFileName, pHeader->year, year);
+    return RETURN_KO;
+  }
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Version 0 files are raw dumps of the GrandPrix structure. Both the x86-64 Linux and MinGW builds laid it out as the
+// current record, only the bool and its padding can hold other values. Version 1 files have the records right after
+// the header and no standings, they are left at 0 for readHistoric() to compute. The new file replaces the old one
+// by rename.
+static int upgradeHistoric(const char *pFileName, int fileHandle, off_t size, int version, int year) {
+  char pTempName[PATH_MAX];
+  StandingsPoints standings;
+  HistoricHeader header;
+  GrandPrix *pRecords;
+  off_t recordsOffset;
+  int tempHandle;
+  int count;
+  int i;
+
+  tempHandle = -1;
+  pRecords = NULL;
+  if (version == 0) {
+    recordsOffset = 0;
+    if (size % sizeof(GrandPrix) != 0 || size > (off_t)HISTORIC_RECORDS_SIZE) {
+      logger(log_ERROR, "file %s has an invalid size of %ld bytes\n", pFileName, (long)size);
+      goto upgradeHistoricExit;
+    }
+  } else {
+    recordsOffset = HISTORIC_HEADER_SIZE;
+    if (size != (off_t)(HISTORIC_HEADER_SIZE + HISTORIC_RECORDS_SIZE)) {
+      logger(log_ERROR, "file %s has an invalid size of %ld bytes\n", pFileName, (long)size);
+      goto upgradeHistoricExit;
+    }
+    size -= HISTORIC_HEADER_SIZE;
+  }
+
+  pRecords = (GrandPrix *)calloc(MAX_GP, sizeof(GrandPrix));
+  if (pRecords == NULL) {
+    logger(log_FATAL, "unable to allocate %d bytes for GrandPrix table.\n", (int)HISTORIC_RECORDS_SIZE);
+    goto upgradeHistoricExit;
+  }
+  if (readAt(fileHandle, recordsOffset, pRecords, size) != size) {
+    logger(log_ERROR, "an error has occurred while reading file %s\n", pFileName);
+    goto upgradeHistoricExit;
+  }
+
+  count = size / sizeof(GrandPrix);
+  for (i = 0; i < count; i++) {
+    pRecords[i].specialGP = pRecords[i].specialGP != 0;
+    memset(pRecords[i].pReserved, 0, sizeof(pRecords[i].pReserved));
+  }
+  // computed by readHistoric() with the selected scoring rules
+  memset(&standings, 0, sizeof(standings));
+
+  sprintf(pTempName, "%s.tmp", pFileName);
+  tempHandle = open(pTempName, O_CREAT | O_TRUNC | O_BINARY | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+  if (tempHandle == -1) {
+    logger(log_ERROR, "unable to open file %s, errno=%d\n", pTempName, errno);
+    goto upgradeHistoricExit;
+  }
+
+  makeHistoricHeader(&header, year);
+  if (writeAt(tempHandle, 0, &header, sizeof(header)) != RETURN_OK ||
+      writeAt(tempHandle, HISTORIC_STANDINGS_OFFSET, &standings, sizeof(standings)) != RETURN_OK ||
+      writeAt(tempHandle, RECORD_OFFSET(0), pRecords, HISTORIC_RECORDS_SIZE) != RETURN_OK ||
+      fdatasync(tempHandle) == -1) {
+    logger(log_ERROR, "an error has occurred while writing to file %s, errno=%d\n", pTempName, errno);
+    goto upgradeHistoricError;
+  }
+
+#ifdef WIN64
+  // rename() does not replace an existing file on Windows
+  close(fileHandle);
+  fileHandle = -1;
+  remove(pFileName);
+#endif
+  if (rename(pTempName, pFileName) == -1) {
+    logger(log_ERROR, "unable to rename %s to %s, errno=%d\n", pTempName, pFileName, errno);
+    goto upgradeHistoricError;
+  }
+  logger(log_INFO, "file %s upgraded from version %d to version %d, %d records\n", pFileName, version,
+         HISTORIC_VERSION, count);
+  goto upgradeHistoricExit;
+
+upgradeHistoricError:
+  close(tempHandle);
+  remove(pTempName);
+  tempHandle = -1;
+
+upgradeHistoricExit:
+  if (fileHandle != -1) {
+    close(fileHandle);
+  }
+  free(pRecords);
+  return tempHandle;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int openHistoric(Context *pCtx, const char *pFileName) {
+  char pJournalName[PATH_MAX];
+  HistoricHeader header;
+  struct stat status;
+  char *pBase;
+  int fileHandle;
+
+  pCtx->gpJournalHandle = -1;
+  fileHandle = open(pFileName, O_CREAT | O_BINARY | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+  if (fileHandle == -1) {
+    logger(log_ERROR, "unable to open file %s, errno=%d\n", pFileName, errno);
+    return RETURN_KO;
+  }
+
+  if (fstat(fileHandle, &status) == -1) {
+    logger(log_ERROR, "unable to get the size of file %s, errno=%d\n", pFileName, errno);
+    goto openHistoricError;
+  }
+
+  if (status.st_size == 0) {
+    makeHistoricHeader(&header, pCtx->gpYear);
+    if (writeAt(fileHandle, 0, &header, sizeof(header)) != RETURN_OK) {
+      logger(log_ERROR, "an error has occurred while writing to file %s, errno=%d\n", pFileName, errno);
+      goto openHistoricError;
+    }
+    status.st_size = sizeof(header);
+  } else {
+    if (readAt(fileHandle, 0, &header, sizeof(header)) != sizeof(header) || header.magic != HISTORIC_MAGIC) {
+      header.version = 0;
+    } else if (checkHistoricHeader(&header, pFileName, pCtx->gpYear) != RETURN_OK) {
+      goto openHistoricError;
+    }
+    if (header.version < HISTORIC_VERSION) {
+      fileHandle = upgradeHistoric(pFileName, fileHandle, status.st_size, header.version, pCtx->gpYear);
+      if (fileHandle == -1) {
+        return RETURN_KO;
+      }
+      status.st_size = HISTORIC_FILE_SIZE;
+      if (readAt(fileHandle, 0, &header, sizeof(header)) != sizeof(header)) {
+        logger(log_ERROR, "an error has occurred while reading file %s\n", pFileName);
+        goto openHistoricError;
+      }
+    }
+  }
+  if (recordHistoricMapping(pCtx, fileHandle, &header, pFileName) != RETURN_OK) {
+    goto openHistoricError;
+  }
+
+  // a new file is extended to its final size, the records are zero filled so unused
+  if (status.st_size > (off_t)HISTORIC_FILE_SIZE) {
+    logger(log_ERROR, "file %s has an invalid size of %ld bytes\n", pFileName, (long)status.st_size);
+    goto openHistoricError;
+  }
+  if (status.st_size < (off_t)HISTORIC_FILE_SIZE && ftruncate(fileHandle, HISTORIC_FILE_SIZE) == -1) {
+    logger(log_ERROR, "unable to extend file %s to %d bytes, errno=%d\n", pFileName, (int)HISTORIC_FILE_SIZE, errno);
+    goto openHistoricError;
+  }
+
+  pBase = mapHistoric(fileHandle, pFileName, false);
+  if (pBase == NULL) {
+    goto openHistoricError;
+  }
+  pCtx->pStandings = (StandingsPoints *)(pBase + HISTORIC_STANDINGS_OFFSET);
+  pCtx->pGrandPrix = (GrandPrix *)(pBase + HISTORIC_RECORDS_OFFSET);
+  pCtx->gpHistoricHandle = fileHandle;
+  pCtx->gpHistoricSize = HISTORIC_FILE_SIZE;
+
+  sprintf(pJournalName, "%s.wal", pFileName);
+  pCtx->gpJournalHandle = open(pJournalName, O_CREAT | O_BINARY | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+  if (pCtx->gpJournalHandle == -1) {
+    logger(log_ERROR, "unable to open file %s, errno=%d\n", pJournalName, errno);
+    goto openHistoricError;
+  }
+
+  if (replayJournal(pCtx, pJournalName) != RETURN_OK) {
+    goto openHistoricError;
+  }
+
+  return RETURN_OK;
+
+openHistoricError:
+  if (pCtx->pGrandPrix != NULL) {
+    unmapHistoric((char *)pCtx->pGrandPrix - HISTORIC_RECORDS_OFFSET);
+    pCtx->pGrandPrix = NULL;
+    pCtx->pStandings = NULL;
+  }
+  if (pCtx->gpJournalHandle != -1) {
+    close(pCtx->gpJournalHandle);
+  }
+  close(fileHandle);
+  return RETURN_KO;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int syncHistoric(Context *pCtx, int grandPrixId) {
+  JournalEntry *pEntry;
+  off_t offset;
+  int code;
+
+  pEntry = (JournalEntry *)calloc(1, sizeof(JournalEntry));
+  if (pEntry == NULL) {
+    logger(log_FATAL, "unable to allocate %d bytes for historic journal.\n", (int)sizeof(JournalEntry));
+    return RETURN_KO;
+  }
+
+  pEntry->magic = HISTORIC_JOURNAL_MAGIC;
+  pEntry->grandPrixId = grandPrixId;
+  pEntry->generation = pCtx->gpGeneration + 1;
+  memcpy(&pEntry->grandPrix, &pCtx->pGrandPrix[grandPrixId], sizeof(GrandPrix));
+  memcpy(&pEntry->standings, pCtx->pStandings, sizeof(StandingsPoints));
+  pEntry->crc = crc32Update(0, pEntry, sizeof(JournalEntry));
+
+  // the commit point: once the entry is on disk, the record and the standings survive a crash
+  offset = sizeof(JournalHeader) + (off_t)pCtx->gpJournalEntries * sizeof(JournalEntry);
+  code = writeAt(pCtx->gpJournalHandle, offset, pEntry, sizeof(JournalEntry));
+  free(pEntry);
+  if (code != RETURN_OK || fdatasync(pCtx->gpJournalHandle) == -1) {
+    logger(log_ERROR, "an error has occurred while writing to historic journal, errno=%d\n", errno);
+    return RETURN_KO;
+  }
+  pCtx->gpGeneration++;
+  pCtx->gpJournalEntries++;
+
+  code = writeAt(pCtx->gpHistoricHandle, RECORD_OFFSET(grandPrixId), &pCtx->pGrandPrix[grandPrixId], sizeof(GrandPrix));
+  if (code == RETURN_OK) {
+    code = writeAt(pCtx->gpHistoricHandle, HISTORIC_STANDINGS_OFFSET, pCtx->pStandings, sizeof(StandingsPoints));
+  }
+  if (code != RETURN_OK) {
+    logger(log_ERROR, "an error has occurred while writing to historic file, errno=%d\n", errno);
+    return RETURN_KO;
+  }
+
+  if (pCtx->gpJournalEntries >= HISTORIC_CHECKPOINT_COMMITS) {
+    return checkpointHistoric(pCtx);
+  }
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int saveHistoricStandings(Context *pCtx) {
+  if (writeAt(pCtx->gpHistoricHandle, HISTORIC_STANDINGS_OFFSET, pCtx->pStandings, sizeof(StandingsPoints)) !=
+      RETURN_OK) {
+    logger(log_ERROR, "an error has occurred while writing to historic file, errno=%d\n", errno);
+    return RETURN_KO;
+  }
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void closeHistoric(Context *pCtx) {
+  if (pCtx->pGrandPrix == NULL) {
+    return;
+  }
+
+  if (pCtx->gpJournalEntries > 0) {
+    checkpointHistoric(pCtx);
+  }
+  unmapHistoric((char *)pCtx->pGrandPrix - HISTORIC_RECORDS_OFFSET);
+  close(pCtx->gpJournalHandle);
+  close(pCtx->gpHistoricHandle);
+  pCtx->pGrandPrix = NULL;
+  pCtx->pStandings = NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int openHistoricReadOnly(const char *pFileName, int year, const GrandPrix **ppGrandPrix, HistoricHeader *pHeader) {
+  struct stat status;
+  char *pBase;
+  int fileHandle;
+
+  *ppGrandPrix = NULL;
+  fileHandle = open(pFileName, O_BINARY | O_RDONLY);
+  if (fileHandle == -1) {
+    logger(log_ERROR, "unable to open file %s, errno=%d\n", pFileName, errno);
+    return RETURN_KO;
+  }
+
+  if (fstat(fileHandle, &status) == -1 || status.st_size != (off_t)HISTORIC_FILE_SIZE ||
+      readAt(fileHandle, 0, pHeader, sizeof(HistoricHeader)) != sizeof(HistoricHeader) ||
+      pHeader->magic != HISTORIC_MAGIC || pHeader->version != HISTORIC_VERSION) {
+    logger(log_WARN, "file %s is not a version %d historic, run the season once to upgrade it\n", pFileName,
+           HISTORIC_VERSION);
+    close(fileHandle);
+    return RETURN_KO;
+  }
+  if (checkHistoricHeader(pHeader, pFileName, year) != RETURN_OK) {
+    close(fileHandle);
+    return RETURN_KO;
+  }
+
+  pBase = mapHistoric(fileHandle, pFileName, true);
+  close(fileHandle);
+  if (pBase == NULL) {
+    return RETURN_KO;
+  }
+  *ppGrandPrix = (const GrandPrix *)(pBase + HISTORIC_RECORDS_OFFSET);
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void closeHistoricReadOnly(const GrandPrix *pGrandPrix) {
+  if (pGrandPrix != NULL) {
+    unmapHistoric((char *)pGrandPrix - HISTORIC_RECORDS_OFFSET);
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,120 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <pthread.h>
+
+#include "grandPrix.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define DEFAULT_LISTEN_ADDRESS "127.0.0.1"
+#define DEFAULT_LISTEN_PORT 1111
+#define DEFAULT_TARGET_FPS 30
+#define MAX_TARGET_FPS 240
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef struct structCarStatus {
+  int cardId;
+  int currentLap;
+  int segments;
+  EventType lastEvent;
+  uint32_t startLapTimestamp;
+  uint32_t lastEventTS;
+  uint32_t lastLapTime;
+  uint32_t bestLapTime;
+  uint32_t totalLapsTime;
+  uint32_t lastSegmentTS;
+  int bestLap;
+  int bestS1Time;
+  int bestS2Time;
+  int bestS3Time;
+  int s1Time;
+  int s2Time;
+  int s3Time;
+  uint32_t totalPitsTime;
+  int pitTime;
+  int pits;
+  bool active;
+} CarStatus;
+
+typedef struct structLeaderBoardRow {
+  int car; // index of the car drawn on this row, -1 when the row is blank
+  bool active;
+  EventType lastEvent;
+  int currentLap;
+  int s1Time;
+  int s2Time;
+  int s3Time;
+  uint32_t bestLapTime;
+  int bestLap;
+  int pits;
+  uint32_t totalLapsTime;
+} LeaderBoardRow;
+
+typedef struct structRenderStats {
+  int frames;
+  uint32_t lastFrameTimeUs;
+  uint32_t maxFrameTimeUs;
+  uint64_t totalFrameTimeUs;
+  int latencies;
+  uint32_t lastLatencyUs; // from the oldest event of the frame being received to the frame being drawn
+  uint32_t maxLatencyUs;
+  uint64_t totalLatencyUs;
+} RenderStats;
+
+// Render side of a live session. It is only touched by the render thread, pCars being a copy of the live car
+// status taken at the start of each frame.
+typedef struct structLeaderBoard {
+  int grandPrixId;
+  RaceType type;
+  time_t raceStartTime;
+  CarStatus *pCars;
+  int *pSortIndices;
+  int cars;
+  int laps;
+  uint32_t lastEventTimestamp;
+  uint32_t dirtyCars; // bit n is set by processEvent() when car n changed since the last draw
+  bool fullRedraw;
+  LeaderBoardRow pRows[MAX_DRIVERS]; // what is currently drawn at each position
+  RenderStats stats;
+  int events; // events received during the session, set when it is over
+} LeaderBoard;
+
+// Ingest side of a live session, shared by the acquisition and render threads under mutex.
+typedef struct structLiveRace {
+  pthread_mutex_t mutex;
+  pthread_cond_t changed;
+  CarStatus pCars[MAX_DRIVERS];
+  uint32_t dirtyCars;
+  uint64_t pendingSinceUs; // arrival time of the oldest event not drawn yet, 0 when everything is drawn
+  int events;
+  bool finished;
+  bool aborted;
+} LiveRace;
+
+typedef struct structAcquireThreadCtx {
+  Context *pCtx;
+  CarStatus *pCarStatus;
+  LiveRace *pLiveRace;
+  socket_t serverSocket;
+  socket_t clientSocket; // set and reset under pLiveRace->mutex, read by requestAbort()
+  bool threadStillAlive;
+  int returnCode;
+} AcquireThreadCtx;
+
+typedef struct structLiveOutput {
+  int (*pDrawFrame)(Context *pCtx, LeaderBoard *pLeaderBoard, void *pUserData);
+  bool (*pQuitRequested)(Context *pCtx, void *pUserData); // optional, polled while the render thread is idle
+  void *pUserData;
+} LiveOutput;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern int processEvent(AcquireThreadCtx *pThreadCtx, EventRace *pEvent);
+extern void sortLeaderBoard(LeaderBoard *pLeaderBoard);
+extern int captureSession(Context *pCtx, LeaderBoard *pLeaderBoard, LiveOutput *pOutput);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#endif
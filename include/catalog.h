@@ -0,0 +1,64 @@
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include "grandPrix.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define CATALOG_MAX_SEASONS 64
+#define CATALOG_MAX_NUMBER 100 // driver numbers are 0 to 99
+#define RACES_PER_GP 11        // pPractices to final, stored one after the other in GrandPrix
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef struct structSeason {
+  int year;
+  const GrandPrix *pGrandPrix;  // MAX_GP records mapped read-only
+  bool hasDrivers;              // false when stored without its driver numbers, left out of the driver index
+  bool hasCalendar;             // false when stored with another calendar or without it, left out of the circuit index
+  int pCarNumbers[MAX_DRIVERS]; // driver number of each carId in this season
+} Season;
+
+// A stored session of any season
+typedef struct structSessionRef {
+  int16_t season; // index in pSeasons
+  int16_t grandPrixId;
+  int32_t type; // RaceType
+  const Race *pRace;
+} SessionRef;
+
+// The result of one driver in a session
+typedef struct structResultRef {
+  int32_t session; // index in pSessions
+  int32_t position;
+} ResultRef;
+
+// Every season found in the working directory, with secondary indexes. An index lists, for each key, the sessions
+// or results pStarts[key] to pStarts[key + 1] - 1, in year then Grand Prix order. The drivers are indexed with the
+// numbers recorded in each season, the circuits only for the seasons run with the current calendar.
+typedef struct structCatalog {
+  Season pSeasons[CATALOG_MAX_SEASONS];
+  int seasons;
+  SessionRef *pSessions;
+  int sessions;
+  int pTypeStarts[race_MAX + 1];
+  int *pByType;
+  int pCircuitStarts[MAX_GP + 1]; // a circuit is the first calendar line using its name
+  int *pByCircuit;
+  int pDriverStarts[CATALOG_MAX_NUMBER + 1];
+  ResultRef *pByDriver;
+  int pCircuits[MAX_GP];        // circuit of each calendar line
+  int pCarNumbers[MAX_DRIVERS]; // driver number of each carId of the current configuration
+} Catalog;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern int catalogOpen(Context *pCtx, Catalog *pCatalog);
+extern void catalogClose(Catalog *pCatalog);
+extern const int *catalogSessionsByType(const Catalog *pCatalog, RaceType type, int *pCount);
+extern const int *catalogSessionsByCircuit(const Catalog *pCatalog, int grandPrixId, int *pCount);
+extern const ResultRef *catalogResultsByDriver(const Catalog *pCatalog, int number, int *pCount);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef COLUMNAR_H
+#define COLUMNAR_H
+
+#include "grandPrix.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define COLUMNS_MAGIC 0x4F435047 // "GPCO" read as little-endian
+#define COLUMNS_VERSION 1
+#define COLUMNS_ALIGNMENT 64 // every column starts on a cache line, in memory as in the file
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The RaceInfo of every stored session, one row per driver and session, one contiguous array per field.
+// The arrays live in a single block, in this order, which is also the content of a columns file after its header.
+typedef struct structResultColumns {
+  int rows;
+  int year;
+  // dimensions
+  uint8_t *pGrandPrixId;
+  uint8_t *pType; // RaceType
+  uint8_t *pPosition;
+  uint8_t *pCarId;
+  // metrics
+  uint32_t *pRaceTime;
+  uint32_t *pBestLapTime;
+  uint32_t *pBestS1;
+  uint32_t *pBestS2;
+  uint32_t *pBestS3;
+  uint32_t *pPits;
+  uint32_t *pPitsTime;
+  int pGrandPrixStarts[MAX_GP + 1]; // rows are sorted by Grand Prix, then session, then position
+  void *pBlock;
+  size_t blockSize;
+  bool mapped;
+} ResultColumns;
+
+typedef struct structColumnsHeader {
+  uint32_t magic;
+  uint32_t version;
+  int32_t year;
+  int32_t rows;
+  uint32_t blockSize;
+  uint32_t crc; // of the header with crc = 0
+  uint8_t pReserved[COLUMNS_ALIGNMENT - 24];
+} ColumnsHeader;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern int buildResultColumns(const GrandPrix *pGrandPrix, int year, ResultColumns *pColumns);
+extern int saveResultColumns(const ResultColumns *pColumns, const char *pFileName);
+extern int mapResultColumns(const char *pFileName, ResultColumns *pColumns);
+extern void freeResultColumns(ResultColumns *pColumns);
+
+// Per Grand Prix aggregates over the rows of one session type, race_ERROR for all; a value of 0 is "no time"
+extern void columnMinPerGrandPrix(const ResultColumns *pColumns, const uint32_t *pMetric, RaceType type,
+                                  uint32_t pMin[MAX_GP]);
+extern void columnSumPerGrandPrix(const ResultColumns *pColumns, const uint32_t *pMetric, RaceType type,
+                                  uint64_t pSum[MAX_GP]);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#endif
@@ -3,6 +3,16 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "csvScan.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define CSV_ARENA_BLOCK_SIZE 16384          // default size of the blocks of a CsvArena
+#define CSV_CHUNK_SIZE (1024 * 1024)        // default size of the reads of csvParserForEach()
+#define CSV_PARALLEL_MIN_CHUNK (256 * 1024) // smallest part of a buffer parsed by its own thread
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
@@ -10,21 +20,85 @@
 extern "C" {
 #endif
 
+// A row is a single allocation: the CsvRow, the field pointers then the NUL terminated fields
 typedef struct CsvRow {
   char **ppFields;
   int fields;
+  bool inArena; // released with its CsvArena, csvParserDestroyRow() leaves it
 } CsvRow;
 
+typedef struct CsvArenaBlock {
+  struct CsvArenaBlock *pNext;
+  size_t size;
+  size_t used;
+} CsvArenaBlock;
+
+// Bump allocator for the rows kept by the program: the rows of a file follow each other in a few blocks, released
+// together by csvArenaFree()
+typedef struct CsvArena {
+  CsvArenaBlock *pBlocks; // the block in use first
+  size_t blockSize;
+} CsvArena;
+
+// Field of a zero-copy row: length bytes of the parsed buffer, not terminated by '\0'
+typedef struct CsvSlice {
+  char *pData;
+  int length;
+} CsvSlice;
+
+typedef struct CsvSliceRow {
+  CsvSlice *pFields; // owned by the parser, overwritten by the next row
+  int fields;
+  int line; // line of the first character of the row, from 1
+} CsvSliceRow;
+
+// Called by csvParserForEach() for each row, whose slices are only valid during the call. false stops the parsing.
+typedef bool (*CsvRowCallback)(const CsvSliceRow *pRow, void *pUser);
+
+// Rows of one chunk of a parallel parsing
+typedef struct CsvRowBatch {
+  CsvSliceRow *pRows;
+  int rows;
+  CsvSlice *pFields; // the fields of all the rows, pointed to by pRows
+  int fields;
+} CsvRowBatch;
+
 typedef struct CsvParser {
   char *pFilePath;
   char delimiter;
   bool isFirstLineHeader;
   char *pErrorMessage;
+  bool reachedEnd; // every row was read, pErrorMessage is "Reached EOF"
   CsvRow *pHeader;
   FILE *pFileHandler;
   int fromString;
   char *pCsvString;
   int csvStringIter;
+  // zero-copy parsing, see csvParserCreateFromMapping()
+  char *pBuffer;
+  size_t bufferSize;
+  size_t bufferIter;
+  bool mapped;      // pBuffer is a private mapping of pFilePath, released by csvParserDestroy()
+  bool moreInput;   // pBuffer is a chunk of csvParserForEach(), the file goes on after it
+  bool delimitOnly; // the quoted fields are left as they are, see csvParserGetBatches()
+  size_t chunkSize; // bytes read at once by csvParserForEach()
+  int line;
+  CsvSlice *pSlices; // fields of the current row, grown to the widest row
+  int slicesCapacity;
+  CsvSliceRow sliceHeader;
+  // separators located by csvScanIndex(), given up for the scalar parsing at the first quote inside a field
+  bool structuralIndex;
+  CsvScanState scan;
+  uint32_t *pStructurals; // offsets from structuralBase of the separators of the window indexed
+  size_t structuralBase;
+  int structuralCount;
+  int structuralIter;
+  // row parsing: the fields are gathered in pScratch before the row is allocated
+  char *pScratch;
+  size_t scratchSize;
+  int *pFieldOffsets;
+  int fieldCapacity;
+  CsvArena *pArena; // NULL to malloc() each row
 } CsvParser;
 
 /*--------------------------------------------------------------------------------------------------------------------*/
@@ -38,6 +112,49 @@ extern CsvRow *csvParserGetRow(CsvParser *pCsvParser);
 extern int csvParserGetNumFields(const CsvRow *pCsvRow);
 extern const char **csvParserGetFields(const CsvRow *pCsvRow);
 extern const char *csvParserGetErrorMessage(CsvParser *pCsvParser);
+// true once the rows ran out, false before or when the parsing stopped on an error
+extern bool csvParserReachedEnd(CsvParser *pCsvParser);
+
+// blockSize 0 for CSV_ARENA_BLOCK_SIZE
+extern void csvArenaInit(CsvArena *pArena, size_t blockSize);
+extern void *csvArenaAlloc(CsvArena *pArena, size_t size);
+extern void csvArenaFree(CsvArena *pArena);
+// The next rows, header included, are allocated from pArena, which must outlive them. Only benchCsvParser uses it:
+// schemaLoad() reads slices and copies the strings of the tables into its own arena with csvArenaAlloc().
+extern void csvParserSetArena(CsvParser *pCsvParser, CsvArena *pArena);
+
+// Zero-copy parsing: the rows are returned as slices of the file mapped in memory, or of a caller buffer of size
+// bytes, without any allocation per row. The quoted fields holding "" are unescaped in place, so the buffer is
+// modified and a mapping is private to the process. The slices stay valid as long as the buffer.
+extern CsvParser *csvParserCreateFromMapping(const char *pFilePath, const char *pDelimiter, bool isFirstLineHeader);
+extern CsvParser *csvParserCreateFromBuffer(char *pBuffer, size_t size, const char *pDelimiter,
+                                            bool isFirstLineHeader);
+// false at the end of the buffer or on error, see csvParserGetErrorMessage()
+extern bool csvParserGetSlices(CsvParser *pCsvParser, CsvSliceRow *pRow);
+// NULL when the parser has no header
+extern const CsvSliceRow *csvParserGetSliceHeader(CsvParser *pCsvParser);
+// The rows are split with the structural index of csvScan.h by default when a vector kernel is available, false to
+// parse the buffer byte per byte
+extern void csvParserUseStructuralIndex(CsvParser *pCsvParser, bool enabled);
+
+// Push-style parsing of a file of any size: a parser from csvParserCreate() reads its file in chunks of chunkSize bytes
+// and hands each row to callback, as slices of the chunk. A row cut by the end of a chunk is completed by the next
+// read, so the memory stays bounded by the chunk size, or the longest row. The header is kept by the parser,
+// csvParserGetSliceHeader() returns it from the first call. The other parsers iterate over their text. Returns the
+// rows handed, -1 on error.
+extern int csvParserForEach(CsvParser *pCsvParser, CsvRowCallback callback, void *pUser);
+// chunkSize 0 for CSV_CHUNK_SIZE
+extern void csvParserSetChunkSize(CsvParser *pCsvParser, size_t chunkSize);
+
+// Parallel parsing of the rows left in a mapped file, a buffer or a string: the text is cut in one chunk per thread,
+// at row boundaries found from the parity of the quotes, and the chunks are parsed concurrently. The rows come back
+// as one batch per chunk, in input order, their slices valid as long as the buffer. When a quote inside a field
+// breaks the parity, the text is parsed by one thread. threads 0 for one per processor. NULL on error.
+extern CsvRowBatch *csvParserGetBatches(CsvParser *pCsvParser, int threads, int *pBatches);
+extern void csvParserFreeBatches(CsvRowBatch *pBatches, int batches);
+// Same parsing, the rows are then handed in input order to callback, on the calling thread. Returns the rows handed,
+// -1 on error.
+extern int csvParserForEachParallel(CsvParser *pCsvParser, int threads, CsvRowCallback callback, void *pUser);
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
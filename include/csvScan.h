@@ -0,0 +1,62 @@
+#ifndef CSV_SCAN_H
+#define CSV_SCAN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define CSV_SCAN_BLOCK 64           // bytes classified at once, one bit each in the masks
+#define CSV_SCAN_WINDOW (64 * 1024) // bytes indexed by one csvScanIndex() call, a multiple of CSV_SCAN_BLOCK
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum enumCsvScanKernel {
+  csvScan_AUTO,   // the widest one supported by the processor
+  csvScan_SCALAR, // 8 bytes at a time in a 64 bits register, any processor
+  csvScan_SSE2,   // 16 bytes at a time, any x86-64 processor
+  csvScan_AVX2    // 32 bytes at a time
+} CsvScanKernel;
+
+// Bit i of each mask is set when byte i of the block is that character
+typedef struct CsvBlockMasks {
+  uint64_t delimiters;
+  uint64_t quotes;
+  uint64_t newLines;
+} CsvBlockMasks;
+
+// Progress of the indexing of a buffer, carried from one block to the next
+typedef struct CsvScanState {
+  size_t scanned;     // bytes of the buffer indexed so far
+  size_t invalid;     // block holding a quote opened inside an unquoted field, SIZE_MAX if none
+  uint64_t inQuotes;  // all ones when the last block ended inside a quoted field
+  uint64_t afterStop; // 1 when the last block ended with a delimiter, a newline or a quote
+} CsvScanState;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Forces a kernel for the benchmarks, falls back to the widest supported one and returns the kernel in use
+extern CsvScanKernel csvScanSelect(CsvScanKernel kernel);
+extern CsvScanKernel csvScanKernel(void);
+extern const char *csvScanKernelName(CsvScanKernel kernel);
+
+extern void csvScanInit(CsvScanState *pState);
+// Classifies the CSV_SCAN_BLOCK bytes at pBlock with the selected kernel
+extern void csvScanClassify(const char *pBlock, char delimiter, CsvBlockMasks *pMasks);
+// Indexes up to CSV_SCAN_WINDOW bytes of pData from pState->scanned: pIndexes gets the offsets, from the first byte
+// indexed, of the delimiters and newlines outside the quoted fields, and the count is returned. The quoted regions
+// are the prefix XOR of the quote bits. The indexing stops before a block where a quote opens inside an unquoted field,
+// a case left to the scalar parser since it breaks the quote parity.
+extern int csvScanIndex(CsvScanState *pState, const char *pData, size_t size, char delimiter, uint32_t *pIndexes);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include "grandPrix.h"
+#include "report.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define EXPORT_RECORD_MAGIC 0x58455047 // "GPEX" read as little-endian
+#define EXPORT_FLUSH_SIZE (256 * 1024) // the output buffer is written in chunks of about this size
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef enum enumExportFormat {
+  export_CSV,
+  export_NDJSON,
+  export_BINARY
+} ExportFormat;
+
+typedef enum enumExportRecordType {
+  export_RESULT = 1,
+  export_STANDINGS = 2
+} ExportRecordType;
+
+// Text formats, one line per driver of a session or of the standings, the times in milliseconds:
+//   type,year,gp,race,pos,car,number,driver,team,raceTime,pitsTime,pits,bestLapTime,bestLap,s1,s2,s3,points
+//   {"type":"result","year":2024,"gp":1,"race":"GP","pos":1,"car":0,"number":"1","driver":"...",...,"points":25}
+// The standings lines leave the session columns empty in CSV and have no such keys in NDJSON.
+//
+// Binary stream: every record starts with this header, followed by 'count' ExportResultRecord for a session or
+// ExportStandingsRecord for the standings of a season (grandPrixId -1).
+typedef struct structExportRecordHeader {
+  uint32_t magic;
+  uint16_t type;
+  uint16_t count;
+  int32_t year;
+  int32_t grandPrixId;
+  int32_t raceType;
+} ExportRecordHeader;
+
+typedef struct structExportResultRecord {
+  int32_t position;
+  int32_t carId;
+  uint32_t raceTime;
+  uint32_t pitsTime;
+  int32_t pits;
+  uint32_t bestLapTime;
+  int32_t bestLap;
+  uint32_t bestS1;
+  uint32_t bestS2;
+  uint32_t bestS3;
+  int32_t points; // in half points
+} ExportResultRecord;
+
+typedef struct structExportStandingsRecord {
+  int32_t position;
+  int32_t carId;
+  int32_t points; // in half points
+} ExportStandingsRecord;
+
+// Streaming output: the records are formatted in place in one reusable buffer, written every EXPORT_FLUSH_SIZE
+typedef struct structExportOutput {
+  Context *pCtx; // drivers and scoring rules
+  ExportFormat format;
+  int fileHandle;
+  bool standardOutput;
+  ReportBuffer buffer;
+  ReportBuffer drivers;               // text of the driver columns of each carId, formatted once
+  int pDriverStarts[MAX_DRIVERS + 1]; // carId text is drivers.pData[pDriverStarts[carId]..pDriverStarts[carId + 1]]
+  uint64_t records;
+  uint64_t bytes;
+  int code;
+} ExportOutput;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// pPath '-' for stdout
+extern int exportOpen(ExportOutput *pOutput, Context *pCtx, const char *pPath, ExportFormat format);
+extern void exportRace(ExportOutput *pOutput, int year, int grandPrixId, const Race *pRace);
+// Every stored session of a Grand Prix
+extern void exportGrandPrix(ExportOutput *pOutput, int year, const GrandPrix *pGrandPrix);
+extern void exportStandings(ExportOutput *pOutput, int year, const StandingsTable *pTable);
+// Writes what is left and closes, returns the first error of the whole export
+extern int exportClose(ExportOutput *pOutput);
+
+// Every season of the working directory, read from the mapped historic files: all the sessions then the standings
+// computed with the selected scoring rules
+extern int exportSeasons(Context *pCtx, const char *pPath, ExportFormat format);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#endif
@@ -88,27 +88,30 @@ typedef struct structEventRace {
   uint32_t timestamp; // time in milliseconds
 } EventRace;
 
+// RaceInfo, Race and GrandPrix are also the records of the historic file (see historic.h): fixed width fields,
+// little-endian, no implicit padding. Any change to them needs a new HISTORIC_VERSION and an upgrade.
 typedef struct structRaceInfo {
-  int carId;
-  int pits;
+  int32_t carId;
+  int32_t pits;
   uint32_t raceTime;
   uint32_t pitsTime;
   uint32_t bestLapTime;
-  int bestLap;
+  int32_t bestLap;
   uint32_t bestS1;
   uint32_t bestS2;
   uint32_t bestS3;
 } RaceInfo;
 
 typedef struct structRace {
-  RaceType type;
+  int32_t type; // RaceType
   RaceInfo pItems[MAX_DRIVERS];
 } Race;
 
 typedef struct structGrandPrix {
-  int grandPrixId;
-  bool specialGP;
-  RaceType nextStep;
+  int32_t grandPrixId;
+  uint8_t specialGP; // 0 or 1
+  uint8_t pReserved[3];
+  int32_t nextStep; // RaceType
   Race pPractices[3];
   Race pSprintShootout[3];
   Race sprint;
@@ -116,6 +119,15 @@ typedef struct structGrandPrix {
   Race final;
 } GrandPrix;
 
+// Championship points of each carId after the stored sprints and Grands Prix, in half points. Kept up to date by
+// fillHistoric() and stored in the historic file with the records, same rules as GrandPrix.
+typedef struct structStandingsPoints {
+  int32_t pPoints[MAX_DRIVERS];
+  int32_t sessions; // sprints and Grands Prix counted
+  uint32_t rules;   // crc of the ScoringRules used, 0 when never computed
+  uint8_t pReserved[40];
+} StandingsPoints;
+
 typedef struct structStandingsTableItem {
   int carId;
   int points;
@@ -125,27 +137,69 @@ typedef struct structStandingsTable {
   StandingsTableItem pItems[MAX_DRIVERS];
 } StandingsTable;
 
+typedef struct structConstructorsTableItem {
+  int teamId;
+  int points;
+} ConstructorsTableItem;
+
+typedef struct structConstructorsTable {
+  ConstructorsTableItem pItems[MAX_DRIVERS]; // the first teams items are used
+  int teams;
+} ConstructorsTable;
+
+// One row of F1_Grand_Prix_2024.csv, see schema.h
+typedef struct structGrandPrixInfo {
+  const char *pName;
+  const char *pCircuit;
+  int32_t laps;
+  int32_t sprintLaps; // 0 when the weekend has no sprint
+  bool isSprint;
+} GrandPrixInfo;
+
+// One row of Drivers.csv
+typedef struct structDriverInfo {
+  const char *pNumber; // as written in the file, for the reports
+  const char *pName;
+  const char *pTeam;
+  int32_t number;
+} DriverInfo;
 
 typedef struct structContext {
-  CsvRow **ppCsvGrandPrix;
-  CsvRow **ppCsvDrivers;
-  StandingsTable standingsTable;
+  GrandPrixInfo pCalendar[MAX_GP];
+  DriverInfo pDrivers[MAX_DRIVERS];
+  CsvArena grandPrixArena; // strings of pCalendar
+  CsvArena driversArena;   // strings of pDrivers, replaced with them
+  const char *ppTeamNames[MAX_DRIVERS]; // by teamId, interned from the team column of the drivers
+  int pTeamIds[MAX_DRIVERS];            // by carId
+  int teams;
+  StandingsTable standingsTable; // pStandings sorted
+  StandingsPoints *pStandings;
+  const struct structScoringRules *pScoring; // selected rules, see scoring.h
+  struct structScoringRules *pRuleSets;
+  int ruleSets;
+  ConstructorsTable constructorsTable;     // pConstructorPoints sorted
+  int32_t pConstructorPoints[MAX_DRIVERS]; // by teamId
   GrandPrix *pGrandPrix;
+  uint32_t pGrandPrixVersions[MAX_GP]; // content of each record, updated when a session is stored
+  const char *pReportDirectory;        // season directory brought up to date after each session, NULL for none
+  int reportThreads;
   int gpHistoricHandle;
+  size_t gpHistoricSize;
+  int gpJournalHandle;
+  int gpJournalEntries;
+  uint64_t gpGeneration;
   int currentGP;
   int gpYear;
   int speedFactor;
+  const char *pListenAddress;
+  int listenPort;
+  int targetFps;
   bool autoLaunch;
   WINDOW *pWindow;
 } Context;
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-extern const int pSprintScores[];
-extern const int pGrandPrixScores[];
-
-/*--------------------------------------------------------------------------------------------------------------------*/
-
 extern int compareStandingsTableItem(const void *pA, const void *pB);
 
 /*--------------------------------------------------------------------------------------------------------------------*/
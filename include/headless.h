@@ -0,0 +1,80 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <stdio.h>
+
+#include "capture.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define DEFAULT_SNAPSHOT_INTERVAL_MS 1000
+
+#define HEADLESS_RECORD_MAGIC 0x4C485047 // "GPHL" read as little-endian
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef enum enumHeadlessFormat {
+  headless_JSON,
+  headless_BINARY
+} HeadlessFormat;
+
+typedef enum enumHeadlessRecordType {
+  record_SNAPSHOT = 1,
+  record_POSITION = 2,
+  record_SESSION_END = 3
+} HeadlessRecordType;
+
+// Binary stream: every record starts with this header, followed by 'count' HeadlessCarRecord for a snapshot,
+// one HeadlessPositionRecord for a position change and nothing for the end of a session.
+typedef struct structHeadlessRecordHeader {
+  uint32_t magic;
+  uint16_t type;
+  uint16_t count;
+  int32_t year;
+  int32_t grandPrixId;
+  int32_t raceType;
+  uint32_t elapsedMs;
+} HeadlessRecordHeader;
+
+typedef struct structHeadlessCarRecord {
+  int32_t position;
+  int32_t carId;
+  int32_t active;
+  int32_t lap;
+  int32_t lastEvent;
+  uint32_t s1Time;
+  uint32_t s2Time;
+  uint32_t s3Time;
+  uint32_t bestLapTime;
+  int32_t bestLap;
+  int32_t pits;
+  uint32_t totalPitsTime;
+  uint32_t totalLapsTime;
+} HeadlessCarRecord;
+
+typedef struct structHeadlessPositionRecord {
+  int32_t carId;
+  int32_t from;
+  int32_t to;
+} HeadlessPositionRecord;
+
+typedef struct structHeadlessOutput {
+  FILE *pFile;
+  HeadlessFormat format;
+  int snapshotIntervalMs;
+  uint64_t sessionStartUs;
+  uint64_t lastSnapshotUs;
+  int pPositions[MAX_DRIVERS]; // position of each car in the last frame, 0 before the first one
+} HeadlessOutput;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern int headlessOpen(HeadlessOutput *pOutput, const char *pPath, HeadlessFormat format, int snapshotIntervalMs);
+extern void headlessStartSession(HeadlessOutput *pOutput);
+extern int headlessDrawFrame(Context *pCtx, LeaderBoard *pLeaderBoard, void *pUserData);
+extern int headlessEndSession(Context *pCtx, LeaderBoard *pLeaderBoard, HeadlessOutput *pOutput);
+extern void headlessClose(HeadlessOutput *pOutput);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#endif
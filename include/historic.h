@@ -0,0 +1,85 @@
+#ifndef HISTORIC_H
+#define HISTORIC_H
+
+#include "grandPrix.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define HISTORIC_MAGIC 0x53485047 // "GPHS" read as little-endian
+#define HISTORIC_VERSION 2        // 0 is the raw GrandPrix dump without header, 1 has no standings
+#define HISTORIC_HEADER_SIZE 64
+#define HISTORIC_STANDINGS_OFFSET HISTORIC_HEADER_SIZE
+#define HISTORIC_RECORDS_OFFSET (HISTORIC_STANDINGS_OFFSET + sizeof(StandingsPoints))
+
+#define HISTORIC_JOURNAL_MAGIC 0x4C4A5047 // "GPJL" read as little-endian
+#define HISTORIC_JOURNAL_VERSION 2        // 1 has no standings in its entries
+#define HISTORIC_CHECKPOINT_COMMITS 8 // commits kept in the journal before the historic file is synced
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// GrandPrix.<year>.bin starts with this header, followed by the StandingsPoints at standingsOffset and the MAX_GP
+// GrandPrix records at recordsOffset. All fields are little-endian and fixed width so that the standings and the
+// records are used in place once the file is mapped. The records only hold carIds and grandPrixIds: the driver
+// numbers and the calendar of the season are recorded by the first openHistoric() with a configuration, so that
+// another season can be read with its own.
+typedef struct structHistoricHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t headerSize;
+  int32_t year;
+  uint32_t recordSize;
+  uint32_t recordCount;
+  uint32_t crc;                     // of the header with crc = 0
+  uint32_t standingsOffset;         // 0 before version 2
+  uint32_t recordsOffset;           // 0 before version 2, the records followed the header
+  uint32_t calendarCrc;             // of the circuits of the calendar used by the season, 0 when stored without it
+  uint8_t pCarNumbers[MAX_DRIVERS]; // driver number of each carId, recorded with calendarCrc
+  uint8_t pReserved[8];
+} HistoricHeader;
+
+// The journal GrandPrix.<year>.bin.wal starts with this header, rewritten at each checkpoint
+typedef struct structJournalHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t recordSize;
+  uint32_t crc;        // of the header with crc = 0
+  uint64_t generation; // last generation already synced in the historic file
+} JournalHeader;
+
+// then one entry per commit, the whole GrandPrix record and the standings after it, with generation = previous
+// generation + 1. A version 1 entry stops before the standings.
+typedef struct structJournalEntry {
+  uint32_t magic;
+  int32_t grandPrixId;
+  uint64_t generation;
+  uint32_t crc; // of the entry with crc = 0
+  uint32_t reserved;
+  GrandPrix grandPrix;
+  StandingsPoints standings;
+} JournalEntry;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The historic of a season is a fixed size file of MAX_GP GrandPrix records, unused records are zero filled. Older
+// versions are upgraded when opened. openHistoric() maps it copy-on-write in pCtx->pGrandPrix and pCtx->pStandings:
+// the records are read in place and the changes stay private until syncHistoric() commits one record with the
+// standings. A commit is durable once its journal entry is written and fdatasync()'ed; the record is then written to
+// the historic file, which is only synced every HISTORIC_CHECKPOINT_COMMITS commits. After a crash, openHistoric()
+// replays the valid journal entries.
+extern int openHistoric(Context *pCtx, const char *pFileName);
+extern int syncHistoric(Context *pCtx, int grandPrixId);
+// Writes pCtx->pStandings recomputed without a record change, outside of the journal: a lost write only means another
+// recompute at the next open
+extern int saveHistoricStandings(Context *pCtx);
+extern void closeHistoric(Context *pCtx);
+
+// Maps a season of another process or year for reading, without upgrade nor journal replay. pHeader gets its header.
+extern int openHistoricReadOnly(const char *pFileName, int year, const GrandPrix **ppGrandPrix,
+                                HistoricHeader *pHeader);
+// Fingerprint of the circuits of pCtx->pCalendar, never 0
+extern uint32_t historicCalendarCrc(const Context *pCtx);
+extern void closeHistoricReadOnly(const GrandPrix *pGrandPrix);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef PROJECTION_H
+#define PROJECTION_H
+
+#include "grandPrix.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define PROJECTION_DEFAULT_SEASONS 1000000
+#define PROJECTION_MAX_THREADS 64
+#define PROJECTION_FORM_DEVIATION 4.0   // standard deviation of the default model, in finishing positions
+#define PROJECTION_SPRINT_DEVIATION 5.0 // same for a sprint, a third of the distance leaves less time to sort the cars
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// xoshiro256** state, each simulation thread gets its own stream 2^128 draws after the previous one
+typedef struct structProjectionRng {
+  uint64_t pState[4];
+} ProjectionRng;
+
+// Performance model of the drivers: draws the performance of every carId for one sprint or Grand Prix, the cars
+// finish in increasing order of performance. pDrawPerformances() is called concurrently from all the threads with
+// their own stream, so it must not modify pModelData.
+typedef struct structProjectionModel {
+  void (*pDrawPerformances)(const void *pModelData, RaceType type, ProjectionRng *pRng, float *pPerformances);
+  const void *pModelData;
+} ProjectionModel;
+
+// Default model: a normal law per car centered on its average finishing position in the stored sprints and
+// Grands Prix, with one extra mid-field result so that a single race does not decide the mean. A sprint is drawn with
+// a wider law than a Grand Prix.
+typedef struct structFormModel {
+  double pMeans[MAX_DRIVERS];
+  double deviation;
+  double sprintDeviation;
+} FormModel;
+
+typedef struct structProjection {
+  uint64_t seasons;
+  int threads;
+  int remainingSprints;
+  int remainingGrandsPrix;
+  uint64_t elapsedUs;
+  double pProbabilities[MAX_DRIVERS][MAX_DRIVERS]; // [carId][final position - 1]
+} Projection;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern void projectionSeed(ProjectionRng *pRng, uint64_t seed);
+extern uint64_t projectionRandom(ProjectionRng *pRng);
+extern double projectionGaussian(ProjectionRng *pRng);
+
+extern void buildFormModel(const GrandPrix *pGrandPrix, FormModel *pFormModel, ProjectionModel *pModel);
+
+// Simulates the end of the season from pCtx->standingsTable and the sessions not stored yet, threads = 0 uses all
+// the cores
+extern int projectChampionship(Context *pCtx, const ProjectionModel *pModel, uint64_t seasons, int threads,
+                               uint64_t seed, Projection *pProjection);
+extern int saveProjection(Context *pCtx, const Projection *pProjection, const char *pFileName);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "timeFormat.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define REPORT_INITIAL_CAPACITY 16384 // a Grand Prix report is about 30 KB
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Growable text buffer: a whole report is formatted in memory, then written with a single write()
+typedef struct structReportBuffer {
+  char *pData;
+  size_t length;
+  size_t capacity;
+  bool failed; // an allocation failed, the content is incomplete
+} ReportBuffer;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+extern void reportInit(ReportBuffer *pReport);
+// Empties the buffer but keeps its memory for the next report
+extern void reportReset(ReportBuffer *pReport);
+extern void reportFree(ReportBuffer *pReport);
+
+// Makes room for size more bytes, false once an allocation has failed
+extern bool reportGrow(ReportBuffer *pReport, size_t size);
+
+static inline void reportAppend(ReportBuffer *pReport, const char *pText, size_t length) {
+  if (pReport->length + length <= pReport->capacity || reportGrow(pReport, length)) {
+    memcpy(pReport->pData + pReport->length, pText, length);
+    pReport->length += length;
+  }
+}
+
+extern void reportString(ReportBuffer *pReport, const char *pText);
+// Same text as printf() "%<width>.<precision>s", "%-<width>.<precision>s" when leftAligned; precision < 0 for none
+extern void reportField(ReportBuffer *pReport, const char *pText, int width, int precision, bool leftAligned);
+// Same text as printf() "%<width>d"
+extern void reportInt(ReportBuffer *pReport, int value, int width);
+// Same text as printf() "%u", formatted in place
+extern void reportUnsigned(ReportBuffer *pReport, uint32_t value);
+
+// Writes the whole buffer to fileHandle and empties it, for the outputs streamed in chunks
+extern int reportFlush(ReportBuffer *pReport, int fileHandle);
+// Writes the buffer to pFileName.tmp with one write() and renames it, a reader never sees a partial report
+extern int reportWrite(const ReportBuffer *pReport, const char *pFileName);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#endif
@@ -2,11 +2,29 @@
 #define SAVE_FILE_H
 
 #include "grandPrix.h"
+#include "report.h"
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+#define REPORT_MANIFEST_FORMAT "Reports_%d.idx" // versions of the reports of a season directory
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Appends the drivers and constructors standings
+extern int buildStandingsReport(Context *pCtx, ReportBuffer *pReport);
+// Appends the text of the sessions of grandPrixId run so far, GrandPrix_<year>_<n>.txt without the standings
+extern int buildGrandPrixReport(Context *pCtx, int grandPrixId, ReportBuffer *pReport);
+// Writes GrandPrix_<year>_<n>.txt in the working directory, followed by the standings
 extern int saveGrandPrixToFile(Context *pCtx, int grandPrixId);
 
+// Content version of a Grand Prix record, kept in pCtx->pGrandPrixVersions when a session is stored
+extern uint32_t grandPrixVersion(const GrandPrix *pGrandPrix);
+// Brings pDirectory up to date: the report of every Grand Prix stored since the last export, or of every Grand Prix
+// started when full is true, and Standings_<year>.txt when the standings changed. The versions of the files written
+// are kept in REPORT_MANIFEST_FORMAT. The Grands Prix are shared read only by threads workers (0 for all the cores),
+// each one formats its reports in its own buffer.
+extern int saveSeasonReports(Context *pCtx, const char *pDirectory, int threads, bool full);
+
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 #endif
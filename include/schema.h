@@ -0,0 +1,54 @@
+#ifndef SCHEMA_H
+#define SCHEMA_H
+
+#include <stddef.h>
+
+#include "grandPrix.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define GRANDPRIX_FILENAME "F1_Grand_Prix_2024.csv"
+#define DRIVERS_FILENAME "Drivers.csv"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef enum enumColumnType {
+  column_INT,   // int32_t, decimal with an optional sign
+  column_BOOL,  // bool, True or False in any case
+  column_STRING // const char *, NUL terminated copy of the field
+} ColumnType;
+
+// One column of a CSV table, stored at offset of each record
+typedef struct structColumnSchema {
+  const char *pName; // for the messages
+  int field;         // index in the row, a field may fill several columns
+  ColumnType type;
+  size_t offset;
+  bool optional;   // an empty field stands for 0, false or ""
+  int32_t minimum; // range of a column_INT
+  int32_t maximum;
+} ColumnSchema;
+
+typedef struct structTableSchema {
+  bool header;
+  const ColumnSchema *pColumns;
+  int columns;
+  int fields; // fields expected in a row at least, the next ones are ignored
+  size_t recordSize;
+} TableSchema;
+
+// F1_Grand_Prix_2024.csv into GrandPrixInfo, Drivers.csv into DriverInfo
+extern const TableSchema grandPrixSchema;
+extern const TableSchema driversSchema;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Converts the rows of pFileName into pTable, a packed array of up to maxRecords records, the strings copied in
+// pArena, and sets *pRecords to the rows read. Every bad row is logged with its line and the load fails, as it does
+// at the first row beyond maxRecords.
+extern int schemaLoad(const TableSchema *pSchema, const char *pFileName, void *pTable, int maxRecords, int *pRecords,
+                      CsvArena *pArena);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#endif
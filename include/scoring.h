@@ -0,0 +1,55 @@
+#ifndef SCORING_H
+#define SCORING_H
+
+#include "grandPrix.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define SCORING_FILENAME "Scoring.csv"
+#define SCORING_DEFAULT_RULES "default" // built-in rules when the file does not exist
+#define SCORING_MAX_RULES 16
+#define SCORING_NAME_MAX 32
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef enum enumScoringSession {
+  scoring_SPRINT,
+  scoring_GRAND_PRIX,
+  scoring_SESSIONS
+} ScoringSession;
+
+// Points of one session type, in half points, indexed by finishing position
+typedef struct structScoreTable {
+  int32_t pPositions[MAX_DRIVERS];
+  int32_t pFastestLap[MAX_DRIVERS]; // bonus of the fastest lap, 0 for the positions out of the top condition
+} ScoreTable;
+
+// One rule set of Scoring.csv, compiled so that scoring a race is a few table lookups:
+//   Rules,Session,Points,FastestLap,FastestLapTop,HalfPoints
+//   2019,GP,25 18 15 12 10 8 6 4 2 1,1,10,
+// Points are the points of the first positions separated by spaces, FastestLap the bonus of the fastest lap given
+// only to a driver classified in the FastestLapTop first positions (0 for all), HalfPoints the rounds (1 to MAX_GP)
+// where the session gives half of the points, rounded down to the half point.
+typedef struct structScoringRules {
+  char pName[SCORING_NAME_MAX];
+  ScoreTable pTables[scoring_SESSIONS][2];      // [session][1 for half points]
+  uint8_t pHalfPoints[scoring_SESSIONS][MAX_GP]; // 0 or 1, index of the table of each round
+  uint32_t crc;                                  // of the tables, kept with the standings computed with them
+} ScoringRules;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Loads every rule set of pFileName and selects pRulesName, NULL for the first one. pCtx->pScoring stays valid
+// until freeScoringRules().
+extern int loadScoringRules(Context *pCtx, const char *pFileName, const char *pRulesName);
+extern void freeScoringRules(Context *pCtx);
+
+// Points given to each finishing position of a stored race_SPRINT or race_GP, fastest lap included; returns false
+// and zeroes pPoints for the other sessions
+extern bool racePoints(const ScoringRules *pRules, int grandPrixId, const Race *pRace, int32_t *pPoints);
+// "12" or "12.5"
+extern char *pointsToString(int32_t halfPoints, char *pOutput, size_t size);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef STANDINGS_H
+#define STANDINGS_H
+
+#include "grandPrix.h"
+#include "scoring.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Adds the points of a stored race_SPRINT or race_GP, other sessions give no point
+extern void addStandingsPoints(const ScoringRules *pRules, StandingsPoints *pStandings, int grandPrixId,
+                               const Race *pRace);
+// Full recompute from the records, the reference for the incremental updates, also used to score a whole season
+// with other rules
+extern void computeStandings(const ScoringRules *pRules, const GrandPrix *pGrandPrix, StandingsPoints *pStandings);
+extern bool sameStandings(const StandingsPoints *pA, const StandingsPoints *pB);
+extern void rankStandings(const StandingsPoints *pStandings, StandingsTable *pTable);
+
+// Gives a dense teamId to each distinct team of pCtx->pDrivers, the only place where team names are compared
+extern void internTeams(Context *pCtx);
+// Team totals rebuilt from the driver points, after a change of drivers or at open
+extern void computeConstructorPoints(Context *pCtx);
+extern void rankConstructors(Context *pCtx);
+// Driver and constructor standings after a stored race_SPRINT or race_GP
+extern void addRaceToStandings(Context *pCtx, int grandPrixId, const Race *pRace);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#endif
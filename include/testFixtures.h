@@ -0,0 +1,18 @@
+#ifndef TEST_FIXTURES_H
+#define TEST_FIXTURES_H
+
+#include <stdint.h>
+
+#include "grandPrix.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// xorshift32 with a fixed seed, the same sequence at each run of the tests and benchmarks
+extern uint32_t nextRandom(void);
+// Random results of a session in finishing order. About one driver in eight has no lap, and the best laps do not
+// follow the order, so that the fastest lap is sometimes out of the top ten.
+extern void fillRace(Race *pRace, RaceType type);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#endif
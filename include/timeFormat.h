@@ -0,0 +1,36 @@
+#ifndef TIME_FORMAT_H
+#define TIME_FORMAT_H
+
+#include <stdint.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Longest text produced for a 32 bits time, NUL included ("+4294967.295s")
+#define TIME_FORMAT_MAX 16
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef enum enumTimeFormat {
+  format_HOUR,   // h:mm:ss.mmm
+  format_MINUTE, // m:ss.mmm
+  format_SECOND, // s.mmm
+  format_GAP     // +s.mmms
+} TimeFormat;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Each function writes the NUL terminated text in pOutput (at least TIME_FORMAT_MAX bytes) and returns its length.
+// The text is the same as the one produced by the timestampTo*() and milliToGap() snprintf() formats.
+extern int formatHour(uint32_t timeMs, char *pOutput);
+extern int formatMinute(uint32_t timeMs, char *pOutput);
+extern int formatSecond(uint32_t timeMs, char *pOutput);
+extern int formatGap(uint32_t timeMs, char *pOutput);
+extern int formatTime(TimeFormat format, uint32_t timeMs, char *pOutput);
+extern int formatUnsigned(uint32_t value, char *pOutput);
+
+// Formats a whole column: the text of pTimes[i] is written at pOutput + i * stride, stride >= TIME_FORMAT_MAX
+extern void formatTimeColumn(TimeFormat format, const uint32_t *pTimes, int count, char *pOutput, int stride);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#endif
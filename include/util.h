@@ -5,6 +5,15 @@
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+#define LOG_RING_SIZE 512          // messages waiting in the queue of each thread, the next ones are dropped
+#define LOG_MAX_ARGUMENTS 8        // arguments of a message copied as they are, '*' widths included
+#define LOG_TEXT_SIZE 232          // bytes of the strings copied with a message, the longer ones are truncated
+#define LOG_FLUSH_INTERVAL_MS 20   // longest wait of the background writer
+#define LOG_BATCH_SIZE (64 * 1024) // bytes formatted before each write to the log file
+#define LOG_MESSAGE_MAX 4096       // longest message, longer ones are truncated
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
 typedef enum enumLevel {
   log_NONE,
   log_OFF,
@@ -19,11 +28,21 @@ typedef enum enumLevel {
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+// Asynchronous: the arguments are copied, the strings included, in a queue of the calling thread, then formatted and
+// written to stdout.log by a background thread. pMessage is kept as a pointer, a string literal. A log_FATAL message is
+// written before the call returns.
 extern void logger(Level level, const char *pMessage, ...);
+// Writes the messages queued so far, called at exit
+extern void loggerFlush(void);
+// Messages lost because the queue of their thread was full
+extern uint64_t loggerDropped(void);
 extern char *timestampToHour(uint32_t timeMs, char *pOutput, int size);
 extern char *timestampToMinute(uint32_t timeMs, char *pOutput, int size);
 extern char *timestampToSecond(uint32_t timeMs, char *pOutput, int size);
 extern char *milliToGap(uint32_t timeMs, char *pOutput, int size);
+extern uint64_t monotonicMicros(void);
+extern int processorCores(void);
+extern uint32_t crc32Update(uint32_t crc, const void *pData, size_t size);
 extern void printEvent(EventRace *pEvent);
 extern const char *raceTypeToString(RaceType type);
 extern RaceType stringToRaceType(const char *pType);
@@ -0,0 +1,391 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "projection.h"
+#include "scoring.h"
+#include "util.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef struct structProjectionThread {
+  pthread_t threadId;
+  const ProjectionModel *pModel;
+  const int32_t *pStartPoints; // by carId
+  const RaceType *pSessions;
+  const int32_t *const *ppScores; // points by finishing position of each session
+  int sessions;
+  uint64_t seasons;
+  ProjectionRng rng;
+  uint64_t pCounts[MAX_DRIVERS][MAX_DRIVERS]; // [carId][final position - 1]
+} ProjectionThread;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static inline uint64_t rotateLeft(uint64_t value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void projectionSeed(ProjectionRng *pRng, uint64_t seed) {
+  uint64_t value;
+  int i;
+
+  // splitmix64, never gives the all-zero state
+  for (i = 0; i < 4; i++) {
+    seed += 0x9E3779B97F4A7C15ULL;
+    value = seed;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    pRng->pState[i] = value ^ (value >> 31);
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+uint64_t projectionRandom(ProjectionRng *pRng) {
+  uint64_t *pState;
+  uint64_t result;
+  uint64_t t;
+
+  pState = pRng->pState;
+  result = rotateLeft(pState[1] * 5, 7) * 9;
+  t = pState[1] << 17;
+  pState[2] ^= pState[0];
+  pState[3] ^= pState[1];
+  pState[1] ^= pState[2];
+  pState[0] ^= pState[3];
+  pState[2] ^= t;
+  pState[3] = rotateLeft(pState[3], 45);
+
+  return result;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Moves the stream 2^128 draws forward, the streams of two threads never overlap
+static void projectionJump(ProjectionRng *pRng) {
+  static const uint64_t pJump[] = {0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL,
+                                   0x39ABDC4529B1661CULL};
+  uint64_t pState[4];
+  int bit;
+  int i;
+
+  memset(pState, 0, sizeof(pState));
+  for (i = 0; i < 4; i++) {
+    for (bit = 0; bit < 64; bit++) {
+      if (pJump[i] & (1ULL << bit)) {
+        pState[0] ^= pRng->pState[0];
+        pState[1] ^= pRng->pState[1];
+        pState[2] ^= pRng->pState[2];
+        pState[3] ^= pRng->pState[3];
+      }
+      projectionRandom(pRng);
+    }
+  }
+  memcpy(pRng->pState, pState, sizeof(pState));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Approximation of the standard normal law by the sum of four 16 bits uniforms (Irwin-Hall), one draw of the stream
+// and no transcendental function; the values are bounded by +/-3.46
+double projectionGaussian(ProjectionRng *pRng) {
+  uint64_t value;
+  uint32_t sum;
+
+  value = projectionRandom(pRng);
+  sum = (uint32_t)(value & 0xFFFF) + (uint32_t)((value >> 16) & 0xFFFF) + (uint32_t)((value >> 32) & 0xFFFF) +
+        (uint32_t)(value >> 48);
+
+  // mean 2 and variance 1/3 for four uniforms of [0, 1[
+  return (sum * (1.0 / 65536.0) - 2.0) * 1.7320508075688772;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void drawFormPerformances(const void *pModelData, RaceType type, ProjectionRng *pRng, float *pPerformances) {
+  const FormModel *pFormModel;
+  double deviation;
+  int car;
+
+  pFormModel = (const FormModel *)pModelData;
+  deviation = type == race_SPRINT ? pFormModel->sprintDeviation : pFormModel->deviation;
+  for (car = 0; car < MAX_DRIVERS; car++) {
+    pPerformances[car] = (float)(pFormModel->pMeans[car] + deviation * projectionGaussian(pRng));
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void addFormPositions(const Race *pRace, double *pSums, int *pCounts) {
+  const RaceInfo *pRaceInfo;
+  int position;
+
+  pRaceInfo = pRace->pItems;
+  for (position = 1; position <= MAX_DRIVERS; position++, pRaceInfo++) {
+    if (pRaceInfo->carId >= 0 && pRaceInfo->carId < MAX_DRIVERS) {
+      pSums[pRaceInfo->carId] += position;
+      pCounts[pRaceInfo->carId]++;
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void buildFormModel(const GrandPrix *pGrandPrix, FormModel *pFormModel, ProjectionModel *pModel) {
+  double pSums[MAX_DRIVERS];
+  int pCounts[MAX_DRIVERS];
+  int car;
+  int gp;
+
+  for (car = 0; car < MAX_DRIVERS; car++) {
+    pSums[car] = (MAX_DRIVERS + 1) / 2.0;
+    pCounts[car] = 1;
+  }
+
+  // same sessions as computeStandings()
+  for (gp = 0; gp < MAX_GP; gp++, pGrandPrix++) {
+    if (pGrandPrix->specialGP && pGrandPrix->nextStep > race_SPRINT) {
+      addFormPositions(&pGrandPrix->sprint, pSums, pCounts);
+    }
+    if (pGrandPrix->nextStep > race_GP) {
+      addFormPositions(&pGrandPrix->final, pSums, pCounts);
+    }
+  }
+
+  for (car = 0; car < MAX_DRIVERS; car++) {
+    pFormModel->pMeans[car] = pSums[car] / pCounts[car];
+  }
+  pFormModel->deviation = PROJECTION_FORM_DEVIATION;
+  pFormModel->sprintDeviation = PROJECTION_SPRINT_DEVIATION;
+
+  pModel->pDrawPerformances = drawFormPerformances;
+  pModel->pModelData = pFormModel;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void *simulateSeasons(void *pArg) {
+  ProjectionThread *pThread;
+  float pPerformances[MAX_DRIVERS];
+  int32_t pPoints[MAX_DRIVERS];
+  int pOrder[MAX_DRIVERS];
+  uint64_t season;
+  const int32_t *pScores;
+  RaceType type;
+  int position;
+  int session;
+  int i;
+  int j;
+
+  pThread = (ProjectionThread *)pArg;
+  for (season = 0; season < pThread->seasons; season++) {
+    memcpy(pPoints, pThread->pStartPoints, sizeof(pPoints));
+
+    for (session = 0; session < pThread->sessions; session++) {
+      type = pThread->pSessions[session];
+      pScores = pThread->ppScores[session];
+      pThread->pModel->pDrawPerformances(pThread->pModel->pModelData, type, &pThread->rng, pPerformances);
+
+      // position of each car counted without branch, a tie goes to the lowest carId
+      for (i = 0; i < MAX_DRIVERS; i++) {
+        position = 0;
+        for (j = 0; j < i; j++) {
+          position += pPerformances[j] <= pPerformances[i];
+        }
+        for (j = i + 1; j < MAX_DRIVERS; j++) {
+          position += pPerformances[j] < pPerformances[i];
+        }
+        pPoints[i] += pScores[position];
+      }
+    }
+
+    // final classification, ties broken as in rankStandings()
+    for (i = 0; i < MAX_DRIVERS; i++) {
+      for (j = i; j > 0 && pPoints[pOrder[j - 1]] < pPoints[i]; j--) {
+        pOrder[j] = pOrder[j - 1];
+      }
+      pOrder[j] = i;
+    }
+    for (i = 0; i < MAX_DRIVERS; i++) {
+      pThread->pCounts[pOrder[i]][i]++;
+    }
+  }
+
+  return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int projectChampionship(Context *pCtx, const ProjectionModel *pModel, uint64_t seasons, int threads, uint64_t seed,
+                        Projection *pProjection) {
+  const int32_t *ppScores[2 * MAX_GP];
+  const ScoringRules *pRules;
+  RaceType pSessions[2 * MAX_GP];
+  int32_t pStartPoints[MAX_DRIVERS];
+  ProjectionThread *pThreads;
+  const GrandPrix *pGrandPrix;
+  ProjectionRng rng;
+  uint64_t startUs;
+  uint64_t counts;
+  bool specialGP;
+  int sessions;
+  int started;
+  int code;
+  int car;
+  int gp;
+  int t;
+  int i;
+
+  startUs = monotonicMicros();
+  memset(pProjection, 0, sizeof(Projection));
+
+  for (i = 0; i < MAX_DRIVERS; i++) {
+    pStartPoints[pCtx->standingsTable.pItems[i].carId] = pCtx->standingsTable.pItems[i].points;
+  }
+
+  // the sessions counted by computeStandings() and not stored yet, the records not initialized take the calendar. The
+  // fastest lap bonus is not simulated, the performance model gives no lap time.
+  pRules = pCtx->pScoring;
+  sessions = 0;
+  for (gp = 0; gp < MAX_GP; gp++) {
+    pGrandPrix = &pCtx->pGrandPrix[gp];
+    if (pGrandPrix->nextStep == race_ERROR) {
+      specialGP = pCtx->pCalendar[gp].isSprint;
+    } else {
+      specialGP = pGrandPrix->specialGP;
+    }
+    if (specialGP && pGrandPrix->nextStep <= race_SPRINT) {
+      ppScores[sessions] = pRules->pTables[scoring_SPRINT][pRules->pHalfPoints[scoring_SPRINT][gp]].pPositions;
+      pSessions[sessions++] = race_SPRINT;
+      pProjection->remainingSprints++;
+    }
+    if (pGrandPrix->nextStep <= race_GP) {
+      ppScores[sessions] =
+          pRules->pTables[scoring_GRAND_PRIX][pRules->pHalfPoints[scoring_GRAND_PRIX][gp]].pPositions;
+      pSessions[sessions++] = race_GP;
+      pProjection->remainingGrandsPrix++;
+    }
+  }
+
+  if (seasons < 1) {
+    seasons = 1;
+  }
+  if (threads < 1) {
+    threads = processorCores();
+  }
+  if (threads > PROJECTION_MAX_THREADS) {
+    threads = PROJECTION_MAX_THREADS;
+  }
+  if ((uint64_t)threads > seasons) {
+    threads = (int)seasons;
+  }
+  if (threads < 1) {
+    threads = 1;
+  }
+
+  pThreads = (ProjectionThread *)calloc(threads, sizeof(ProjectionThread));
+  if (pThreads == NULL) {
+    logger(log_FATAL, "unable to allocate %d simulation threads.\n", threads);
+    return RETURN_KO;
+  }
+
+  projectionSeed(&rng, seed);
+  for (t = 0; t < threads; t++) {
+    pThreads[t].pModel = pModel;
+    pThreads[t].pStartPoints = pStartPoints;
+    pThreads[t].pSessions = pSessions;
+    pThreads[t].ppScores = ppScores;
+    pThreads[t].sessions = sessions;
+    pThreads[t].seasons = seasons / threads + ((uint64_t)t < seasons % threads);
+    pThreads[t].rng = rng;
+    projectionJump(&rng);
+  }
+
+  code = RETURN_OK;
+  for (started = 0; started < threads; started++) {
+    if (pthread_create(&pThreads[started].threadId, NULL, simulateSeasons, &pThreads[started]) != 0) {
+      logger(log_ERROR, "unable to create simulation thread %d, errno=%d\n", started, errno);
+      code = RETURN_KO;
+      break;
+    }
+  }
+  for (t = 0; t < started; t++) {
+    pthread_join(pThreads[t].threadId, NULL);
+  }
+  if (code) {
+    goto projectChampionshipExit;
+  }
+
+  for (car = 0; car < MAX_DRIVERS; car++) {
+    for (i = 0; i < MAX_DRIVERS; i++) {
+      counts = 0;
+      for (t = 0; t < threads; t++) {
+        counts += pThreads[t].pCounts[car][i];
+      }
+      pProjection->pProbabilities[car][i] = (double)counts / seasons;
+    }
+  }
+  pProjection->seasons = seasons;
+  pProjection->threads = threads;
+  pProjection->elapsedUs = monotonicMicros() - startUs;
+
+  logger(log_INFO, "%llu seasons of %d projected with %d threads in %llu us, %d sprints and %d Grands Prix left\n",
+         (unsigned long long)seasons, pCtx->gpYear, threads, (unsigned long long)pProjection->elapsedUs,
+         pProjection->remainingSprints, pProjection->remainingGrandsPrix);
+
+projectChampionshipExit:
+  free(pThreads);
+
+  return code;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int saveProjection(Context *pCtx, const Projection *pProjection, const char *pFileName) {
+  const DriverInfo *pDriver;
+  char pPoints[16];
+  FILE *pFile;
+  int carId;
+  int i;
+  int j;
+
+  pFile = fopen(pFileName, "w");
+  if (pFile == NULL) {
+    logger(log_ERROR, "unable to create file %s, errno=%d\n", pFileName, errno);
+    return RETURN_KO;
+  }
+
+  // one line per driver in the current standings order, the probability of each final position
+  fprintf(pFile, "Number,Driver,Team,Points");
+  for (j = 1; j <= MAX_DRIVERS; j++) {
+    fprintf(pFile, ",P%d", j);
+  }
+  fprintf(pFile, "\n");
+
+  for (i = 0; i < MAX_DRIVERS; i++) {
+    carId = pCtx->standingsTable.pItems[i].carId;
+    pDriver = &pCtx->pDrivers[carId];
+    fprintf(pFile, "%s,%s,%s,%s", pDriver->pNumber, pDriver->pName, pDriver->pTeam,
+            pointsToString(pCtx->standingsTable.pItems[i].points, pPoints, sizeof(pPoints)));
+    for (j = 0; j < MAX_DRIVERS; j++) {
+      fprintf(pFile, ",%.6f", pProjection->pProbabilities[carId][j]);
+    }
+    fprintf(pFile, "\n");
+  }
+
+  if (fclose(pFile) != 0) {
+    logger(log_ERROR, "unable to write file %s, errno=%d\n", pFileName, errno);
+    return RETURN_KO;
+  }
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
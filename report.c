@@ -0,0 +1,207 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifdef WIN64
+#include <io.h>
+#endif
+
+#ifdef LINUX
+#include <linux/limits.h>
+#endif
+
+#include "grandPrix.h"
+#include "report.h"
+#include "util.h"
+
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void reportInit(ReportBuffer *pReport) {
+  memset(pReport, 0, sizeof(ReportBuffer));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void reportReset(ReportBuffer *pReport) {
+  pReport->length = 0;
+  pReport->failed = false;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void reportFree(ReportBuffer *pReport) {
+  free(pReport->pData);
+  memset(pReport, 0, sizeof(ReportBuffer));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool reportGrow(ReportBuffer *pReport, size_t size) {
+  size_t capacity;
+  char *pData;
+
+  if (pReport->failed) {
+    return false;
+  }
+
+  capacity = pReport->capacity == 0 ? REPORT_INITIAL_CAPACITY : pReport->capacity * 2;
+  while (capacity < pReport->length + size) {
+    capacity *= 2;
+  }
+  pData = (char *)realloc(pReport->pData, capacity);
+  if (pData == NULL) {
+    logger(log_FATAL, "unable to allocate %ld bytes for a report.\n", (long)capacity);
+    pReport->failed = true;
+    return false;
+  }
+  pReport->pData = pData;
+  pReport->capacity = capacity;
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void reportString(ReportBuffer *pReport, const char *pText) {
+  reportAppend(pReport, pText, strlen(pText));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Appends the length bytes of pText padded with spaces up to width, one reservation for the whole field
+static void reportPadded(ReportBuffer *pReport, const char *pText, size_t length, int width, bool leftAligned) {
+  size_t padding;
+  char *pOutput;
+
+  padding = (int)length < width ? width - length : 0;
+  if (pReport->length + length + padding > pReport->capacity && !reportGrow(pReport, length + padding)) {
+    return;
+  }
+
+  pOutput = pReport->pData + pReport->length;
+  if (!leftAligned) {
+    memset(pOutput, ' ', padding);
+    pOutput += padding;
+  }
+  memcpy(pOutput, pText, length);
+  if (leftAligned) {
+    memset(pOutput + length, ' ', padding);
+  }
+  pReport->length += length + padding;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void reportField(ReportBuffer *pReport, const char *pText, int width, int precision, bool leftAligned) {
+  // the widths count bytes, as printf() does
+  reportPadded(pReport, pText, precision < 0 ? strlen(pText) : strnlen(pText, precision), width, leftAligned);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void reportInt(ReportBuffer *pReport, int value, int width) {
+  char pText[TIME_FORMAT_MAX];
+  int length;
+
+  if (value < 0) {
+    pText[0] = '-';
+    length = 1 + formatUnsigned(0U - (uint32_t)value, pText + 1);
+  } else {
+    length = formatUnsigned((uint32_t)value, pText);
+  }
+  reportPadded(pReport, pText, length, width, false);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void reportUnsigned(ReportBuffer *pReport, uint32_t value) {
+  if (pReport->length + TIME_FORMAT_MAX <= pReport->capacity || reportGrow(pReport, TIME_FORMAT_MAX)) {
+    pReport->length += formatUnsigned(value, pReport->pData + pReport->length);
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// a single write() in practice, the loop only covers the partial writes allowed by POSIX
+static int writeAll(int fileHandle, const char *pData, size_t size) {
+  ssize_t written;
+
+  while (size > 0) {
+    written = write(fileHandle, pData, size);
+    if (written <= 0) {
+      return RETURN_KO;
+    }
+    pData += written;
+    size -= written;
+  }
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int reportFlush(ReportBuffer *pReport, int fileHandle) {
+  if (pReport->failed) {
+    logger(log_ERROR, "report buffer is incomplete, not written\n");
+    return RETURN_KO;
+  }
+  if (writeAll(fileHandle, pReport->pData, pReport->length) != RETURN_OK) {
+    logger(log_ERROR, "an error has occurred while writing %ld bytes, errno=%d\n", (long)pReport->length, errno);
+    return RETURN_KO;
+  }
+  pReport->length = 0;
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int reportWrite(const ReportBuffer *pReport, const char *pFileName) {
+  char pTempName[PATH_MAX];
+  int fileHandle;
+
+  if (pReport->failed) {
+    logger(log_ERROR, "report %s is incomplete, not written\n", pFileName);
+    return RETURN_KO;
+  }
+
+  // O_TEXT keeps the line endings of the former fopen("w") on Windows. The report can be built again from the
+  // historic, so it is not synced: the rename only hides the partial content from the readers.
+  snprintf(pTempName, sizeof(pTempName), "%s.tmp", pFileName);
+  fileHandle = open(pTempName, O_CREAT | O_TRUNC | O_WRONLY | O_TEXT, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+  if (fileHandle == -1) {
+    logger(log_ERROR, "an error has occurred while opening file %s for writing, errno=%d\n", pTempName, errno);
+    return RETURN_KO;
+  }
+
+  if (writeAll(fileHandle, pReport->pData, pReport->length) != RETURN_OK) {
+    logger(log_ERROR, "an error has occurred while writing file %s, errno=%d\n", pTempName, errno);
+    close(fileHandle);
+    remove(pTempName);
+    return RETURN_KO;
+  }
+  if (close(fileHandle) == -1) {
+    logger(log_ERROR, "an error has occurred while closing file %s, errno=%d\n", pTempName, errno);
+    remove(pTempName);
+    return RETURN_KO;
+  }
+
+#ifdef WIN64
+  // rename() does not replace an existing file on Windows
+  remove(pFileName);
+#endif
+  if (rename(pTempName, pFileName) == -1) {
+    logger(log_ERROR, "unable to rename %s to %s, errno=%d\n", pTempName, pFileName, errno);
+    remove(pTempName);
+    return RETURN_KO;
+  }
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -4,37 +4,80 @@
 #include <stdarg.h>
 #include <time.h>
 #include <sys/time.h>
+#include <pthread.h>
 
 #ifdef LINUX
 #include <linux/limits.h>
 #endif
 
+#include "report.h"
 #include "saveFile.h"
+#include "scoring.h"
 #include "util.h"
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-int saveRace(Context *pCtx, FILE *pFile, Race *pRace) {
+typedef struct structReportThread {
+  pthread_t threadId;
+  Context *pCtx; // read only, shared by all the threads
+  const char *pDirectory;
+  const int *pGrandPrixIds; // the thread writes pGrandPrixIds[first], pGrandPrixIds[first + step]...
+  int grandPrix;
+  int first;
+  int step;
+  uint32_t *pWritten; // version of each report written, by grandPrixId
+  int reports;
+  int code;
+} ReportThread;
+
+// Versions of the files of a report directory when they were written, kept as REPORT_MANIFEST_FORMAT:
+//   year 2024
+//   configuration 1c291ca3
+//   standings 8f0ad2a1
+//   gp 1 5e1d3b07
+typedef struct structReportManifest {
+  int year;
+  uint32_t configuration;
+  uint32_t standings;
+  uint32_t pGrandPrix[MAX_GP]; // 0 for a report never written
+} ReportManifest;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// "%3d  %5s    %-20.20s   %-30.30s" of every driver row
+static void reportDriver(ReportBuffer *pReport, int position, const DriverInfo *pDriver) {
+  reportInt(pReport, position, 3);
+  reportAppend(pReport, "  ", 2);
+  reportField(pReport, pDriver->pNumber, 5, -1, false);
+  reportAppend(pReport, "    ", 4);
+  reportField(pReport, pDriver->pName, 20, 20, true);
+  reportAppend(pReport, "   ", 3);
+  reportField(pReport, pDriver->pTeam, 30, 30, true);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int saveRace(Context *pCtx, ReportBuffer *pReport, Race *pRace) {
   uint32_t previousTime;
   RaceInfo *pRaceInfo;
-  char **ppDriverInfo;
-  char pBestLapTime[32];
-  char pBestS1Time[32];
-  char pBestS2Time[32];
-  char pBestS3Time[32];
-  char pTotalTime[32];
-  char pGapTime[32];
+  const DriverInfo *pDriver;
+  char pBestLapTime[TIME_FORMAT_MAX];
+  char pBestS1Time[TIME_FORMAT_MAX];
+  char pBestS2Time[TIME_FORMAT_MAX];
+  char pBestS3Time[TIME_FORMAT_MAX];
+  char pTotalTime[TIME_FORMAT_MAX];
+  char pGapTime[TIME_FORMAT_MAX];
   int carId;
   int cars;
   int i;
 
   pRaceInfo = pRace->pItems;
-  fprintf(pFile, "\n\n");
-  fprintf(pFile, "Epreuve: %s\n", raceTypeToString(pRace->type));
-  fprintf(pFile, "Pos   Number     Driver                      Team                       Best S1  Best S2  "
-                 "Best S3   Best lap time     Gap     Laps   Total time\n");
-  fprintf(pFile, "------------------------------------------------------------------------------------------"
-                 "------------------------------------------------------\n");
+  reportString(pReport, "\n\nEpreuve: ");
+  reportString(pReport, raceTypeToString(pRace->type));
+  reportString(pReport, "\nPos   Number     Driver                      Team                       Best S1  Best S2  "
+                        "Best S3   Best lap time     Gap     Laps   Total time\n"
+                        "------------------------------------------------------------------------------------------"
+                        "------------------------------------------------------\n");
 
   if (pRace->type == race_Q2_GP || pRace->type == race_Q2_SPRINT) {
     cars = MAX_DRIVERS_Q2;
@@ -43,29 +86,45 @@ int saveRace(Context *pCtx, FILE *pFile, Race *pRace) {
   } else {
     cars = MAX_DRIVERS_Q1;
   }
+  // a driver without lap keeps the total time of the previous row, as the report always did
+  pTotalTime[0] = 0;
+  previousTime = 0;
   for (i = 0; i < cars; i++) {
     carId = pRaceInfo->carId;
-    ppDriverInfo = pCtx->ppCsvDrivers[carId]->ppFields;
+    pDriver = &pCtx->pDrivers[carId];
 
     pBestLapTime[0] = 0;
     pGapTime[0] = 0;
     pBestS1Time[0] = pBestS2Time[0] = pBestS3Time[0] = 0;
     if (pRaceInfo->bestLapTime > 0) {
-      timestampToSecond(pRaceInfo->bestS1, pBestS1Time, sizeof(pBestS1Time));
-      timestampToSecond(pRaceInfo->bestS2, pBestS2Time, sizeof(pBestS2Time));
-      timestampToSecond(pRaceInfo->bestS3, pBestS3Time, sizeof(pBestS3Time));
-      timestampToMinute(pRaceInfo->bestLapTime, pBestLapTime, sizeof(pBestLapTime));
-      timestampToHour(pRaceInfo->raceTime, pTotalTime, sizeof(pTotalTime));
+      formatSecond(pRaceInfo->bestS1, pBestS1Time);
+      formatSecond(pRaceInfo->bestS2, pBestS2Time);
+      formatSecond(pRaceInfo->bestS3, pBestS3Time);
+      formatMinute(pRaceInfo->bestLapTime, pBestLapTime);
+      formatHour(pRaceInfo->raceTime, pTotalTime);
       if (i == 0) {
         previousTime = pRaceInfo->bestLapTime;
       } else {
-        milliToGap(pRaceInfo->bestLapTime - previousTime, pGapTime, sizeof(pGapTime));
+        formatGap(pRaceInfo->bestLapTime - previousTime, pGapTime);
       }
     }
 
-    fprintf(pFile, "%3d  %5s    %-20.20s   %-30.30s   %8s %8s %8s     %10s   %10s  %3d    %10s\n", i + 1,
-            ppDriverInfo[0], ppDriverInfo[1], ppDriverInfo[2], pBestS1Time, pBestS2Time, pBestS3Time, pBestLapTime,
-            pGapTime, pRaceInfo->bestLap + 1, pTotalTime);
+    reportDriver(pReport, i + 1, pDriver);
+    reportAppend(pReport, "   ", 3);
+    reportField(pReport, pBestS1Time, 8, -1, false);
+    reportAppend(pReport, " ", 1);
+    reportField(pReport, pBestS2Time, 8, -1, false);
+    reportAppend(pReport, " ", 1);
+    reportField(pReport, pBestS3Time, 8, -1, false);
+    reportAppend(pReport, "     ", 5);
+    reportField(pReport, pBestLapTime, 10, -1, false);
+    reportAppend(pReport, "   ", 3);
+    reportField(pReport, pGapTime, 10, -1, false);
+    reportAppend(pReport, "  ", 2);
+    reportInt(pReport, pRaceInfo->bestLap + 1, 3);
+    reportAppend(pReport, "    ", 4);
+    reportField(pReport, pTotalTime, 10, -1, false);
+    reportAppend(pReport, "\n", 1);
     pRaceInfo++;
   }
 
@@ -74,28 +133,31 @@ int saveRace(Context *pCtx, FILE *pFile, Race *pRace) {
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-int saveSprintOrFinal(Context *pCtx, FILE *pFile, Race *pRace) {
+int saveSprintOrFinal(Context *pCtx, ReportBuffer *pReport, int grandPrixId, Race *pRace) {
+  int32_t pPoints[MAX_DRIVERS];
   uint32_t previousTime;
   RaceInfo *pRaceInfo;
-  char **ppDriverInfo;
-  char pBestLapTime[32];
-  char pBestS1Time[32];
-  char pBestS2Time[32];
-  char pBestS3Time[32];
-  char pTotalTime[32];
-  char pPitsTime[32];
-  char pGapTime[32];
+  const DriverInfo *pDriver;
+  char pBestLapTime[TIME_FORMAT_MAX];
+  char pBestS1Time[TIME_FORMAT_MAX];
+  char pBestS2Time[TIME_FORMAT_MAX];
+  char pBestS3Time[TIME_FORMAT_MAX];
+  char pTotalTime[TIME_FORMAT_MAX];
+  char pPitsTime[TIME_FORMAT_MAX];
+  char pGapTime[TIME_FORMAT_MAX];
+  char pPointsText[16];
   int carId;
   int cars;
   int i;
 
+  racePoints(pCtx->pScoring, grandPrixId, pRace, pPoints);
   pRaceInfo = pRace->pItems;
-  fprintf(pFile, "\n\n");
-  fprintf(pFile, "Epreuve: %s\n", raceTypeToString(pRace->type));
-  fprintf(pFile, "Pos   Number     Driver                      Team                       Best S1  Best S2  "
-                 "Best S3   Best lap time   Laps   Pits  Pits time   Total time     Gap      Points\n");
-  fprintf(pFile, "------------------------------------------------------------------------------------------"
-                 "---------------------------------------------------------------------------------\n");
+  reportString(pReport, "\n\nEpreuve: ");
+  reportString(pReport, raceTypeToString(pRace->type));
+  reportString(pReport, "\nPos   Number     Driver                      Team                       Best S1  Best S2  "
+                        "Best S3   Best lap time   Laps   Pits  Pits time   Total time     Gap      Points\n"
+                        "------------------------------------------------------------------------------------------"
+                        "---------------------------------------------------------------------------------\n");
 
   if (pRace->type == race_Q2_GP || pRace->type == race_Q2_SPRINT) {
     cars = MAX_DRIVERS_Q2;
@@ -104,31 +166,52 @@ int saveSprintOrFinal(Context *pCtx, FILE *pFile, Race *pRace) {
   } else {
     cars = MAX_DRIVERS_Q1;
   }
+  // a driver without lap keeps the pits and total times of the previous row, as the report always did
+  pPitsTime[0] = pTotalTime[0] = 0;
+  previousTime = 0;
   for (i = 0; i < cars; i++) {
     carId = pRaceInfo->carId;
-    ppDriverInfo = pCtx->ppCsvDrivers[carId]->ppFields;
+    pDriver = &pCtx->pDrivers[carId];
 
     pBestLapTime[0] = 0;
     pGapTime[0] = 0;
     pBestS1Time[0] = pBestS2Time[0] = pBestS3Time[0] = 0;
     if (pRaceInfo->bestLapTime > 0) {
-      timestampToSecond(pRaceInfo->bestS1, pBestS1Time, sizeof(pBestS1Time));
-      timestampToSecond(pRaceInfo->bestS2, pBestS2Time, sizeof(pBestS2Time));
-      timestampToSecond(pRaceInfo->bestS3, pBestS3Time, sizeof(pBestS3Time));
-      timestampToMinute(pRaceInfo->bestLapTime, pBestLapTime, sizeof(pBestLapTime));
-      timestampToMinute(pRaceInfo->pitsTime, pPitsTime, sizeof(pPitsTime));
-      timestampToHour(pRaceInfo->raceTime, pTotalTime, sizeof(pTotalTime));
+      formatSecond(pRaceInfo->bestS1, pBestS1Time);
+      formatSecond(pRaceInfo->bestS2, pBestS2Time);
+      formatSecond(pRaceInfo->bestS3, pBestS3Time);
+      formatMinute(pRaceInfo->bestLapTime, pBestLapTime);
+      formatMinute(pRaceInfo->pitsTime, pPitsTime);
+      formatHour(pRaceInfo->raceTime, pTotalTime);
     }
     if (i == 0) {
       previousTime = pRaceInfo->raceTime;
     } else {
-      milliToGap(pRaceInfo->raceTime - previousTime, pGapTime, sizeof(pGapTime));
+      formatGap(pRaceInfo->raceTime - previousTime, pGapTime);
     }
 
-    fprintf(pFile, "%3d  %5s    %-20.20s   %-30.30s   %8s %8s %8s     %10s     %3d   %3d   %10s  %10s %10s  %4d\n",
-            i + 1, ppDriverInfo[0], ppDriverInfo[1], ppDriverInfo[2], pBestS1Time, pBestS2Time, pBestS3Time,
-            pBestLapTime, pRaceInfo->bestLap + 1, pRaceInfo->pits, pPitsTime, pTotalTime, pGapTime,
-            pRace->type == race_SPRINT ? pSprintScores[i] : pGrandPrixScores[i]);
+    reportDriver(pReport, i + 1, pDriver);
+    reportAppend(pReport, "   ", 3);
+    reportField(pReport, pBestS1Time, 8, -1, false);
+    reportAppend(pReport, " ", 1);
+    reportField(pReport, pBestS2Time, 8, -1, false);
+    reportAppend(pReport, " ", 1);
+    reportField(pReport, pBestS3Time, 8, -1, false);
+    reportAppend(pReport, "     ", 5);
+    reportField(pReport, pBestLapTime, 10, -1, false);
+    reportAppend(pReport, "     ", 5);
+    reportInt(pReport, pRaceInfo->bestLap + 1, 3);
+    reportAppend(pReport, "   ", 3);
+    reportInt(pReport, pRaceInfo->pits, 3);
+    reportAppend(pReport, "   ", 3);
+    reportField(pReport, pPitsTime, 10, -1, false);
+    reportAppend(pReport, "  ", 2);
+    reportField(pReport, pTotalTime, 10, -1, false);
+    reportAppend(pReport, " ", 1);
+    reportField(pReport, pGapTime, 10, -1, false);
+    reportAppend(pReport, "  ", 2);
+    reportField(pReport, pointsToString(pPoints[i], pPointsText, sizeof(pPointsText)), 4, -1, false);
+    reportAppend(pReport, "\n", 1);
     pRaceInfo++;
   }
 
@@ -137,18 +220,18 @@ int saveSprintOrFinal(Context *pCtx, FILE *pFile, Race *pRace) {
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-int saveStartingGrid(Context *pCtx, FILE *pFile, RaceType type, Race *pRace) {
+int saveStartingGrid(Context *pCtx, ReportBuffer *pReport, RaceType type, Race *pRace) {
   RaceInfo *pRaceInfo;
-  char **ppDriverInfo;
-  char pBestLapTime[32];
+  const DriverInfo *pDriver;
+  char pBestLapTime[TIME_FORMAT_MAX];
   int carId;
   int i;
 
   pRaceInfo = pRace->pItems;
-  fprintf(pFile, "\n\n");
-  fprintf(pFile, "Grille de départ: %s\n", raceTypeToString(type));
-  fprintf(pFile, "Pos   Number     Driver                      Team                       Best time\n");
-  fprintf(pFile, "---------------------------------------------------------------------------------\n");
+  reportString(pReport, "\n\nGrille de départ: ");
+  reportString(pReport, raceTypeToString(type));
+  reportString(pReport, "\nPos   Number     Driver                      Team                       Best time\n"
+                        "---------------------------------------------------------------------------------\n");
 
   for (i = 0; i < MAX_DRIVERS; i++) {
     if (i == 0) {
@@ -160,10 +243,13 @@ int saveStartingGrid(Context *pCtx, FILE *pFile, RaceType type, Race *pRace) {
     }
 
     carId = pRaceInfo->carId;
-    ppDriverInfo = pCtx->ppCsvDrivers[carId]->ppFields;
+    pDriver = &pCtx->pDrivers[carId];
 
-    fprintf(pFile, "%3d  %5s    %-20.20s   %-30.30s    %10s\n", i + 1, ppDriverInfo[0], ppDriverInfo[1],
-            ppDriverInfo[2], timestampToMinute(pRaceInfo->bestLapTime, pBestLapTime, sizeof(pBestLapTime)));
+    formatMinute(pRaceInfo->bestLapTime, pBestLapTime);
+    reportDriver(pReport, i + 1, pDriver);
+    reportAppend(pReport, "    ", 4);
+    reportField(pReport, pBestLapTime, 10, -1, false);
+    reportAppend(pReport, "\n", 1);
     pRaceInfo++;
   }
 
@@ -172,57 +258,51 @@ int saveStartingGrid(Context *pCtx, FILE *pFile, RaceType type, Race *pRace) {
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-int saveStandings(Context *pCtx, FILE *pFile) {
+int saveStandings(Context *pCtx, ReportBuffer *pReport) {
   StandingsTableItem *pStandingsTableItem;
-  RaceInfo *pSprintInfo;
-  RaceInfo *pGrandPrixInfo;
-  GrandPrix *pGrandPrix;
-  char **ppFields;
+  const DriverInfo *pDriver;
+  char pPoints[16];
   int carId;
-  int car;
   int i;
 
-  pGrandPrix = pCtx->pGrandPrix;
+  reportString(pReport, "\n\nClassement général\n"
+                        "Pos   Number     Driver                      Team                   Total points\n"
+                        "--------------------------------------------------------------------------------\n");
+
   pStandingsTableItem = (StandingsTableItem *)pCtx->standingsTable.pItems;
   for (i = 0; i < MAX_DRIVERS; i++) {
-    pStandingsTableItem->carId = i;
-    pStandingsTableItem->points = 0;
+    carId = pStandingsTableItem->carId;
+    pDriver = &pCtx->pDrivers[carId];
+    reportDriver(pReport, i + 1, pDriver);
+    reportAppend(pReport, "   ", 3);
+    reportField(pReport, pointsToString(pStandingsTableItem->points, pPoints, sizeof(pPoints)), 5, -1, false);
+    reportAppend(pReport, "\n", 1);
     pStandingsTableItem++;
   }
 
-  pStandingsTableItem = (StandingsTableItem *)pCtx->standingsTable.pItems;
-  for (i = 0; i < MAX_GP; i++) {
-    if (pGrandPrix->specialGP && pGrandPrix->nextStep > race_SPRINT) {
-      pSprintInfo = (RaceInfo *)pGrandPrix->sprint.pItems;
-      for (car = 0; car < MAX_DRIVERS; car++) {
-        pStandingsTableItem[pSprintInfo->carId].points += pSprintScores[car];
-        pSprintInfo++;
-      }
-    }
-    if (pGrandPrix->nextStep > race_GP) {
-      pGrandPrixInfo = (RaceInfo *)pGrandPrix->final.pItems;
-      for (car = 0; car < MAX_DRIVERS; car++) {
-        pStandingsTableItem[pGrandPrixInfo->carId].points += pGrandPrixScores[car];
-        pGrandPrixInfo++;
-      }
-    }
-    pGrandPrix++;
-  }
+  return RETURN_OK;
+}
 
-  qsort(&pCtx->standingsTable.pItems, MAX_DRIVERS, sizeof(StandingsTableItem), compareStandingsTableItem);
+/*--------------------------------------------------------------------------------------------------------------------*/
 
-  fprintf(pFile, "\n\n");
-  fprintf(pFile, "Classement général\n");
-  fprintf(pFile, "Pos   Number     Driver                      Team                   Total points\n");
-  fprintf(pFile, "--------------------------------------------------------------------------------\n");
+int saveConstructors(Context *pCtx, ReportBuffer *pReport) {
+  ConstructorsTableItem *pConstructorsTableItem;
+  char pPoints[16];
+  int i;
 
-  pStandingsTableItem = (StandingsTableItem *)pCtx->standingsTable.pItems;
-  for (i = 0; i < MAX_DRIVERS; i++) {
-    carId = pStandingsTableItem->carId;
-    ppFields = pCtx->ppCsvDrivers[carId]->ppFields;
-    fprintf(pFile, "%3d  %5s    %-20.20s   %-30.30s   %5d\n", i + 1, ppFields[0], ppFields[1], ppFields[2],
-            pStandingsTableItem->points);
-    pStandingsTableItem++;
+  reportString(pReport, "\n\nClassement des constructeurs\n"
+                        "Pos   Team                                      Total points\n"
+                        "------------------------------------------------------------\n");
+
+  pConstructorsTableItem = pCtx->constructorsTable.pItems;
+  for (i = 0; i < pCtx->constructorsTable.teams; i++) {
+    reportInt(pReport, i + 1, 3);
+    reportAppend(pReport, "   ", 3);
+    reportField(pReport, pCtx->ppTeamNames[pConstructorsTableItem->teamId], 40, 40, true);
+    reportAppend(pReport, "   ", 3);
+    reportField(pReport, pointsToString(pConstructorsTableItem->points, pPoints, sizeof(pPoints)), 5, -1, false);
+    reportAppend(pReport, "\n", 1);
+    pConstructorsTableItem++;
   }
 
   return RETURN_OK;
@@ -230,41 +310,48 @@ int saveStandings(Context *pCtx, FILE *pFile) {
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-int saveGrandPrixToFile(Context *pCtx, int grandPrixId) {
-  char pFileName[PATH_MAX];
+int buildStandingsReport(Context *pCtx, ReportBuffer *pReport) {
+  saveStandings(pCtx, pReport);
+  saveConstructors(pCtx, pReport);
+
+  return pReport->failed ? RETURN_KO : RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int buildGrandPrixReport(Context *pCtx, int grandPrixId, ReportBuffer *pReport) {
   GrandPrix *pGrandPrix;
   Race *pRace;
   bool special;
-  char **ppGPInfo;
-  FILE *pFile;
+  const GrandPrixInfo *pGrandPrixInfo;
   int returnCode;
   int code;
   int i;
 
   pGrandPrix = &pCtx->pGrandPrix[grandPrixId];
   special = pGrandPrix->specialGP;
-  ppGPInfo = pCtx->ppCsvGrandPrix[grandPrixId]->ppFields;
+  pGrandPrixInfo = &pCtx->pCalendar[grandPrixId];
 
-  sprintf(pFileName, "GrandPrix_%d_%d.txt", pCtx->gpYear, grandPrixId + 1);
-  pFile = fopen(pFileName, "w");
-  if (pFile == NULL) {
-    logger(log_ERROR, "an error has occurred while opening file %s for writing, errno=%d\n", pFileName, errno);
-    return RETURN_KO;
-  }
-
-  fprintf(pFile, "Championnat %d Formule 1 Grand Prix %s/%s\n", pCtx->gpYear, ppGPInfo[0], ppGPInfo[1]);
+  reportString(pReport, "Championnat ");
+  reportInt(pReport, pCtx->gpYear, 0);
+  reportString(pReport, " Formule 1 Grand Prix ");
+  reportString(pReport, pGrandPrixInfo->pName);
+  reportAppend(pReport, "/", 1);
+  reportString(pReport, pGrandPrixInfo->pCircuit);
+  reportAppend(pReport, "\n", 1);
 
   returnCode = RETURN_OK;
+  code = RETURN_OK;
 
   for (i = 0; i < (special ? 1 : 3); i++) {
     pRace = &pGrandPrix->pPractices[i];
     if (pRace->type == race_ERROR) {
-      goto saveGrandPrixToFileExit;
+      goto buildGrandPrixReportExit;
     }
-    code = saveRace(pCtx, pFile, pRace);
+    code = saveRace(pCtx, pReport, pRace);
     if (code) {
       returnCode = code;
-      goto saveGrandPrixToFileExit;
+      goto buildGrandPrixReportExit;
     }
   }
 
@@ -272,68 +359,343 @@ int saveGrandPrixToFile(Context *pCtx, int grandPrixId) {
     for (i = 0; i < 3; i++) {
       pRace = &pGrandPrix->pSprintShootout[i];
       if (pRace->type == race_ERROR) {
-        goto saveGrandPrixToFileExit;
+        goto buildGrandPrixReportExit;
       }
-      code = saveRace(pCtx, pFile, pRace);
+      code = saveRace(pCtx, pReport, pRace);
       if (code) {
         returnCode = code;
-        goto saveGrandPrixToFileExit;
+        goto buildGrandPrixReportExit;
       }
     }
 
-    code = saveStartingGrid(pCtx, pFile, race_SPRINT, pGrandPrix->pSprintShootout);
+    code = saveStartingGrid(pCtx, pReport, race_SPRINT, pGrandPrix->pSprintShootout);
     if (code) {
       returnCode = code;
-      goto saveGrandPrixToFileExit;
+      goto buildGrandPrixReportExit;
     }
 
     pRace = &pGrandPrix->sprint;
     if (pRace->type == race_ERROR) {
-      goto saveGrandPrixToFileExit;
+      goto buildGrandPrixReportExit;
     }
-    code = saveSprintOrFinal(pCtx, pFile, pRace);
+    code = saveSprintOrFinal(pCtx, pReport, grandPrixId, pRace);
     if (code) {
       returnCode = code;
-      goto saveGrandPrixToFileExit;
+      goto buildGrandPrixReportExit;
     }
   }
 
   for (i = 0; i < 3; i++) {
     pRace = &pGrandPrix->pQualifications[i];
     if (pRace->type == race_ERROR) {
-      goto saveGrandPrixToFileExit;
+      goto buildGrandPrixReportExit;
     }
-    code = saveRace(pCtx, pFile, pRace);
+    code = saveRace(pCtx, pReport, pRace);
     if (code) {
       returnCode = code;
-      goto saveGrandPrixToFileExit;
+      goto buildGrandPrixReportExit;
     }
   }
 
-  code = saveStartingGrid(pCtx, pFile, race_GP, pGrandPrix->pQualifications);
+  code = saveStartingGrid(pCtx, pReport, race_GP, pGrandPrix->pQualifications);
   if (code) {
     returnCode = code;
-    goto saveGrandPrixToFileExit;
+    goto buildGrandPrixReportExit;
   }
 
   pRace = &pGrandPrix->final;
   if (pRace->type == race_ERROR) {
-    goto saveGrandPrixToFileExit;
+    goto buildGrandPrixReportExit;
   }
-  code = saveSprintOrFinal(pCtx, pFile, pRace);
+  code = saveSprintOrFinal(pCtx, pReport, grandPrixId, pRace);
   if (code) {
     returnCode = code;
-    goto saveGrandPrixToFileExit;
+    goto buildGrandPrixReportExit;
   }
 
-saveGrandPrixToFileExit:
-  if (code == RETURN_OK) {
-    saveStandings(pCtx, pFile);
+buildGrandPrixReportExit:
+  return returnCode;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int saveGrandPrixToFile(Context *pCtx, int grandPrixId) {
+  char pFileName[PATH_MAX];
+  ReportBuffer report;
+  int returnCode;
+  int code;
+
+  reportInit(&report);
+  returnCode = buildGrandPrixReport(pCtx, grandPrixId, &report);
+  if (returnCode == RETURN_OK) {
+    buildStandingsReport(pCtx, &report);
   }
 
-  fclose(pFile);
+  // the sections built before an error are written, as the former fprintf() version did
+  sprintf(pFileName, "GrandPrix_%d_%d.txt", pCtx->gpYear, grandPrixId + 1);
+  code = reportWrite(&report, pFileName);
+  if (returnCode == RETURN_OK) {
+    returnCode = code;
+  }
+  reportFree(&report);
 
   return returnCode;
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
+
+uint32_t grandPrixVersion(const GrandPrix *pGrandPrix) {
+  uint32_t version;
+
+  // 0 is kept for the reports never written
+  version = crc32Update(0, pGrandPrix, sizeof(GrandPrix));
+
+  return version == 0 ? 1 : version;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Everything but the records that a report depends on: the drivers, the calendar and the scoring rules
+static uint32_t configurationVersion(Context *pCtx) {
+  const char *ppFields[3];
+  uint32_t crc;
+  int field;
+  int i;
+
+  // the text of the fields as in the files, so that the versions stay those of the reports already written
+  crc = pCtx->pScoring->crc;
+  for (i = 0; i < MAX_DRIVERS; i++) {
+    ppFields[0] = pCtx->pDrivers[i].pNumber;
+    ppFields[1] = pCtx->pDrivers[i].pName;
+    ppFields[2] = pCtx->pDrivers[i].pTeam;
+    for (field = 0; field < 3; field++) {
+      crc = crc32Update(crc, ppFields[field], strlen(ppFields[field]) + 1);
+    }
+  }
+  for (i = 0; i < MAX_GP; i++) {
+    ppFields[0] = pCtx->pCalendar[i].pName;
+    ppFields[1] = pCtx->pCalendar[i].pCircuit;
+    for (field = 0; field < 2; field++) {
+      crc = crc32Update(crc, ppFields[field], strlen(ppFields[field]) + 1);
+    }
+  }
+
+  return crc;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// A missing or unreadable manifest is an empty one: every report is written again
+static void readManifest(Context *pCtx, const char *pFileName, ReportManifest *pManifest) {
+  ReportManifest manifest;
+  uint32_t version;
+  FILE *pFile;
+  bool valid;
+  int gp;
+
+  memset(pManifest, 0, sizeof(ReportManifest));
+  pFile = fopen(pFileName, "r");
+  if (pFile == NULL) {
+    return;
+  }
+
+  memset(&manifest, 0, sizeof(ReportManifest));
+  valid = fscanf(pFile, "year %d configuration %x standings %x", &manifest.year, &manifest.configuration,
+                 &manifest.standings) == 3 &&
+          manifest.year == pCtx->gpYear;
+  while (valid && fscanf(pFile, " gp %d %x", &gp, &version) == 2) {
+    valid = gp >= 1 && gp <= MAX_GP;
+    if (valid) {
+      manifest.pGrandPrix[gp - 1] = version;
+    }
+  }
+  valid = valid && feof(pFile);
+  fclose(pFile);
+
+  if (!valid) {
+    logger(log_WARN, "report manifest %s is not valid, all the reports are written\n", pFileName);
+    return;
+  }
+  memcpy(pManifest, &manifest, sizeof(ReportManifest));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static int writeManifest(const ReportManifest *pManifest, const char *pFileName) {
+  ReportBuffer text;
+  char pLine[64];
+  int code;
+  int gp;
+
+  reportInit(&text);
+  reportAppend(&text, pLine,
+               snprintf(pLine, sizeof(pLine), "year %d\nconfiguration %08x\nstandings %08x\n", pManifest->year,
+                        pManifest->configuration, pManifest->standings));
+  for (gp = 0; gp < MAX_GP; gp++) {
+    if (pManifest->pGrandPrix[gp] != 0) {
+      reportAppend(&text, pLine, snprintf(pLine, sizeof(pLine), "gp %d %08x\n", gp + 1, pManifest->pGrandPrix[gp]));
+    }
+  }
+  code = reportWrite(&text, pFileName);
+  reportFree(&text);
+
+  return code;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void *writeReports(void *pUserData) {
+  char pFileName[PATH_MAX];
+  ReportThread *pThread;
+  ReportBuffer report;
+  Context *pCtx;
+  int grandPrixId;
+  int code;
+  int i;
+
+  pThread = (ReportThread *)pUserData;
+  pCtx = pThread->pCtx;
+
+  // the buffer grows to the largest report then is reused by the next ones
+  reportInit(&report);
+  for (i = pThread->first; i < pThread->grandPrix; i += pThread->step) {
+    grandPrixId = pThread->pGrandPrixIds[i];
+    reportReset(&report);
+    code = buildGrandPrixReport(pCtx, grandPrixId, &report);
+    snprintf(pFileName, sizeof(pFileName), "%s/GrandPrix_%d_%d.txt", pThread->pDirectory, pCtx->gpYear,
+             grandPrixId + 1);
+    if (reportWrite(&report, pFileName) != RETURN_OK) {
+      code = RETURN_KO;
+    }
+    if (code) {
+      pThread->code = code;
+      break;
+    }
+    pThread->pWritten[grandPrixId] = pCtx->pGrandPrixVersions[grandPrixId];
+    pThread->reports++;
+  }
+  reportFree(&report);
+
+  return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int saveSeasonReports(Context *pCtx, const char *pDirectory, int threads, bool full) {
+  char pManifestName[PATH_MAX];
+  char pFileName[PATH_MAX];
+  int pGrandPrixIds[MAX_GP];
+  ReportManifest manifest;
+  ReportThread *pThreads;
+  ReportBuffer standings;
+  uint32_t configuration;
+  uint32_t version;
+  uint64_t startUs;
+  bool standingsWritten;
+  int grandPrix;
+  int reports;
+  int started;
+  int code;
+  int gp;
+  int t;
+
+  startUs = monotonicMicros();
+  snprintf(pManifestName, sizeof(pManifestName), "%s/" REPORT_MANIFEST_FORMAT, pDirectory, pCtx->gpYear);
+  readManifest(pCtx, pManifestName, &manifest);
+  configuration = configurationVersion(pCtx);
+  if (full || manifest.configuration != configuration) {
+    memset(manifest.pGrandPrix, 0, sizeof(manifest.pGrandPrix));
+    manifest.standings = 0;
+  }
+  manifest.year = pCtx->gpYear;
+  manifest.configuration = configuration;
+
+  // only the Grands Prix stored since the last export are formatted again
+  grandPrix = 0;
+  for (gp = 0; gp < MAX_GP; gp++) {
+    if (pCtx->pGrandPrix[gp].pPractices[0].type != race_ERROR &&
+        manifest.pGrandPrix[gp] != pCtx->pGrandPrixVersions[gp]) {
+      pGrandPrixIds[grandPrix++] = gp;
+    }
+  }
+
+  if (threads < 1) {
+    threads = processorCores();
+  }
+  if (threads > grandPrix) {
+    threads = grandPrix;
+  }
+
+  pThreads = NULL;
+  if (threads > 0) {
+    pThreads = (ReportThread *)calloc(threads, sizeof(ReportThread));
+    if (pThreads == NULL) {
+      logger(log_FATAL, "unable to allocate %d report threads.\n", threads);
+      return RETURN_KO;
+    }
+  }
+
+  code = RETURN_OK;
+  for (started = 0; started < threads; started++) {
+    pThreads[started].pCtx = pCtx;
+    pThreads[started].pDirectory = pDirectory;
+    pThreads[started].pGrandPrixIds = pGrandPrixIds;
+    pThreads[started].grandPrix = grandPrix;
+    pThreads[started].first = started;
+    pThreads[started].step = threads;
+    pThreads[started].pWritten = manifest.pGrandPrix;
+    if (pthread_create(&pThreads[started].threadId, NULL, writeReports, &pThreads[started]) != 0) {
+      logger(log_ERROR, "unable to create report thread %d, errno=%d\n", started, errno);
+      code = RETURN_KO;
+      break;
+    }
+  }
+
+  // the standings change after every sprint and Grand Prix, they have their own file written while the threads
+  // format the Grands Prix
+  reportInit(&standings);
+  reportString(&standings, "Championnat ");
+  reportInt(&standings, pCtx->gpYear, 0);
+  reportString(&standings, " Formule 1\n");
+  buildStandingsReport(pCtx, &standings);
+  version = crc32Update(0, standings.pData, standings.length);
+  standingsWritten = false;
+  if (version != manifest.standings) {
+    snprintf(pFileName, sizeof(pFileName), "%s/Standings_%d.txt", pDirectory, pCtx->gpYear);
+    if (reportWrite(&standings, pFileName) == RETURN_OK) {
+      manifest.standings = version;
+      standingsWritten = true;
+    } else {
+      code = RETURN_KO;
+    }
+  }
+  reportFree(&standings);
+
+  // each thread only sets the versions of its own Grands Prix in manifest.pGrandPrix
+  reports = 0;
+  for (t = 0; t < started; t++) {
+    pthread_join(pThreads[t].threadId, NULL);
+    reports += pThreads[t].reports;
+    if (pThreads[t].code) {
+      code = pThreads[t].code;
+    }
+  }
+  free(pThreads);
+
+  // the reports written before an error are kept, the others are tried again by the next export
+  if (reports > 0 || standingsWritten) {
+    if (writeManifest(&manifest, pManifestName) != RETURN_OK) {
+      code = RETURN_KO;
+    }
+  }
+
+  if (code == RETURN_OK) {
+    logger(log_INFO, "%d reports of season %d written to %s with %d threads in %llu us, standings %s\n", reports,
+           pCtx->gpYear, pDirectory, threads, (unsigned long long)(monotonicMicros() - startUs),
+           standingsWritten ? "written" : "unchanged");
+  }
+
+  return code;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
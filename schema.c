@@ -0,0 +1,163 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <strings.h>
+
+#include "schema.h"
+#include "util.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+//   GrandPrix,Circuit,Laps,Special,SprintLaps
+//   Emilia-Romagna GP,Autodromo Enzo e Dino Ferrari,63,True,17
+static const ColumnSchema pGrandPrixColumns[] = {
+    {"GrandPrix", 0, column_STRING, offsetof(GrandPrixInfo, pName), false, 0, 0},
+    {"Circuit", 1, column_STRING, offsetof(GrandPrixInfo, pCircuit), false, 0, 0},
+    {"Laps", 2, column_INT, offsetof(GrandPrixInfo, laps), false, 1, 999},
+    {"Special", 3, column_BOOL, offsetof(GrandPrixInfo, isSprint), false, 0, 0},
+    {"SprintLaps", 4, column_INT, offsetof(GrandPrixInfo, sprintLaps), true, 0, 999}};
+
+const TableSchema grandPrixSchema = {true, pGrandPrixColumns, sizeof(pGrandPrixColumns) / sizeof(ColumnSchema), 5,
+                                     sizeof(GrandPrixInfo)};
+
+//   1,Max Verstappen,Red Bull Racing
+// The number is kept as written for the reports
+static const ColumnSchema pDriversColumns[] = {
+    {"Number", 0, column_INT, offsetof(DriverInfo, number), false, 0, 99},
+    {"Number", 0, column_STRING, offsetof(DriverInfo, pNumber), false, 0, 0},
+    {"Driver", 1, column_STRING, offsetof(DriverInfo, pName), false, 0, 0},
+    {"Team", 2, column_STRING, offsetof(DriverInfo, pTeam), false, 0, 0}};
+
+const TableSchema driversSchema = {false, pDriversColumns, sizeof(pDriversColumns) / sizeof(ColumnSchema), 3,
+                                   sizeof(DriverInfo)};
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static bool parseInt(const CsvSlice *pField, int32_t *pValue) {
+  int64_t value;
+  bool negative;
+  int i;
+
+  i = 0;
+  negative = pField->length > 0 && (pField->pData[0] == '-' || pField->pData[0] == '+');
+  if (negative) {
+    negative = pField->pData[0] == '-';
+    i++;
+  }
+  if (i == pField->length || pField->length - i > 10) {
+    return false;
+  }
+  for (value = 0; i < pField->length; i++) {
+    if (pField->pData[i] < '0' || pField->pData[i] > '9') {
+      return false;
+    }
+    value = value * 10 + pField->pData[i] - '0';
+  }
+  value = negative ? -value : value;
+  if (value < INT32_MIN || value > INT32_MAX) {
+    return false;
+  }
+  *pValue = (int32_t)value;
+  return true;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Stores a field in the record, false when it does not match its column
+static bool convertField(const ColumnSchema *pColumn, const CsvSlice *pField, char *pRecord, CsvArena *pArena) {
+  int32_t value;
+  char *pText;
+
+  if (pField->length == 0 && !pColumn->optional) {
+    return false;
+  }
+
+  switch (pColumn->type) {
+  case column_INT:
+    value = 0;
+    if (pField->length > 0 && (!parseInt(pField, &value) || value < pColumn->minimum || value > pColumn->maximum)) {
+      return false;
+    }
+    memcpy(pRecord + pColumn->offset, &value, sizeof(int32_t));
+    return true;
+  case column_BOOL:
+    if (pField->length == 4 && strncasecmp(pField->pData, "True", 4) == 0) {
+      *(bool *)(pRecord + pColumn->offset) = true;
+    } else if (pField->length == 0 || (pField->length == 5 && strncasecmp(pField->pData, "False", 5) == 0)) {
+      *(bool *)(pRecord + pColumn->offset) = false;
+    } else {
+      return false;
+    }
+    return true;
+  case column_STRING:
+    pText = (char *)csvArenaAlloc(pArena, pField->length + 1);
+    if (pText == NULL) {
+      return false;
+    }
+    memcpy(pText, pField->pData, pField->length);
+    pText[pField->length] = '\0';
+    memcpy(pRecord + pColumn->offset, &pText, sizeof(const char *));
+    return true;
+  }
+  return false;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int schemaLoad(const TableSchema *pSchema, const char *pFileName, void *pTable, int maxRecords, int *pRecords,
+               CsvArena *pArena) {
+  const ColumnSchema *pColumn;
+  const CsvSlice *pField;
+  CsvParser *pCsvParser;
+  CsvSliceRow row;
+  char *pRecord;
+  int column;
+  int code;
+
+  *pRecords = 0;
+  pCsvParser = csvParserCreateFromMapping(pFileName, NULL, pSchema->header);
+  if (pCsvParser == NULL) {
+    logger(log_ERROR, "unable to create new parser for '%s'.\n", pFileName);
+    return RETURN_KO;
+  }
+
+  // every row is checked, so that all the mistakes of the file are reported at once
+  code = RETURN_OK;
+  while (csvParserGetSlices(pCsvParser, &row)) {
+    if (*pRecords == maxRecords) {
+      logger(log_ERROR, "line %d of %s: more than %d rows\n", row.line, pFileName, maxRecords);
+      code = RETURN_KO;
+      goto schemaLoadExit;
+    }
+    if (row.fields < pSchema->fields) {
+      logger(log_ERROR, "line %d of %s has %d fields, %d expected\n", row.line, pFileName, row.fields,
+             pSchema->fields);
+      code = RETURN_KO;
+      continue;
+    }
+    pRecord = (char *)pTable + *pRecords * pSchema->recordSize;
+    for (column = 0; column < pSchema->columns; column++) {
+      pColumn = &pSchema->pColumns[column];
+      pField = &row.pFields[pColumn->field];
+      if (!convertField(pColumn, pField, pRecord, pArena)) {
+        logger(log_ERROR, "line %d of %s: illegal %s '%.*s'\n", row.line, pFileName, pColumn->pName, pField->length,
+               pField->pData);
+        code = RETURN_KO;
+      }
+    }
+    (*pRecords)++;
+  }
+  if (!csvParserReachedEnd(pCsvParser)) {
+    logger(log_ERROR, "unable to read %s: %s\n", pFileName, csvParserGetErrorMessage(pCsvParser));
+    code = RETURN_KO;
+  }
+
+schemaLoadExit:
+  csvParserDestroy(pCsvParser);
+  return code;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
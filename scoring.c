@@ -0,0 +1,288 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "scoring.h"
+#include "util.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Built-in rules, the points given before Scoring.csv existed
+static const int pDefaultSprintPoints[] = {8, 7, 6, 5, 4, 3, 2, 1};
+static const int pDefaultGrandPrixPoints[] = {25, 20, 15, 10, 8, 6, 5, 3, 2, 1};
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Fills the half points table of a session from the full points one and computes the crc
+static void compileScoringRules(ScoringRules *pRules) {
+  ScoreTable *pFull;
+  ScoreTable *pHalf;
+  int session;
+  int i;
+
+  for (session = 0; session < scoring_SESSIONS; session++) {
+    pFull = &pRules->pTables[session][0];
+    pHalf = &pRules->pTables[session][1];
+    for (i = 0; i < MAX_DRIVERS; i++) {
+      pHalf->pPositions[i] = pFull->pPositions[i] / 2;
+      pHalf->pFastestLap[i] = pFull->pFastestLap[i] / 2;
+    }
+  }
+
+  pRules->crc = crc32Update(0, pRules->pTables, sizeof(pRules->pTables));
+  pRules->crc = crc32Update(pRules->crc, pRules->pHalfPoints, sizeof(pRules->pHalfPoints));
+  // 0 is kept for the standings never computed
+  if (pRules->crc == 0) {
+    pRules->crc = 1;
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void defaultScoringRules(ScoringRules *pRules) {
+  int i;
+
+  memset(pRules, 0, sizeof(ScoringRules));
+  strcpy(pRules->pName, SCORING_DEFAULT_RULES);
+  for (i = 0; i < (int)(sizeof(pDefaultSprintPoints) / sizeof(pDefaultSprintPoints[0])); i++) {
+    pRules->pTables[scoring_SPRINT][0].pPositions[i] = pDefaultSprintPoints[i] * 2;
+  }
+  for (i = 0; i < (int)(sizeof(pDefaultGrandPrixPoints) / sizeof(pDefaultGrandPrixPoints[0])); i++) {
+    pRules->pTables[scoring_GRAND_PRIX][0].pPositions[i] = pDefaultGrandPrixPoints[i] * 2;
+  }
+  compileScoringRules(pRules);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// "25 18 12.5" in half points, at most MAX_DRIVERS values
+static int parseHalfPoints(const char *pText, int32_t *pValues, int *pCount) {
+  char *pEnd;
+  double value;
+
+  *pCount = 0;
+  while (true) {
+    while (*pText == ' ') {
+      pText++;
+    }
+    if (*pText == '\0') {
+      return RETURN_OK;
+    }
+    value = strtod(pText, &pEnd);
+    if (pEnd == pText || value < 0 || *pCount == MAX_DRIVERS) {
+      return RETURN_KO;
+    }
+    pValues[(*pCount)++] = (int32_t)(value * 2 + 0.5);
+    pText = pEnd;
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static int parseScoringRow(Context *pCtx, CsvRow *pCsvRow, int line) {
+  int32_t pValues[MAX_DRIVERS];
+  ScoringRules *pRules;
+  ScoreTable *pTable;
+  char **ppFields;
+  const char *pText;
+  char *pEnd;
+  int32_t bonus;
+  long round;
+  int session;
+  int count;
+  int top;
+  int i;
+
+  ppFields = pCsvRow->ppFields;
+  if (pCsvRow->fields < 6) {
+    logger(log_ERROR, "line %d of %s has %d fields instead of 6\n", line, SCORING_FILENAME, pCsvRow->fields);
+    return RETURN_KO;
+  }
+
+  if (strcasecmp(ppFields[1], "Sprint") == 0) {
+    session = scoring_SPRINT;
+  } else if (strcasecmp(ppFields[1], "GP") == 0) {
+    session = scoring_GRAND_PRIX;
+  } else {
+    logger(log_ERROR, "line %d of %s: illegal session '%s', 'Sprint' or 'GP' expected\n", line, SCORING_FILENAME,
+           ppFields[1]);
+    return RETURN_KO;
+  }
+
+  for (i = 0; i < pCtx->ruleSets; i++) {
+    if (strcmp(pCtx->pRuleSets[i].pName, ppFields[0]) == 0) {
+      break;
+    }
+  }
+  if (i == pCtx->ruleSets) {
+    if (pCtx->ruleSets == SCORING_MAX_RULES) {
+      logger(log_ERROR, "line %d of %s: more than %d rule sets\n", line, SCORING_FILENAME, SCORING_MAX_RULES);
+      return RETURN_KO;
+    }
+    memset(&pCtx->pRuleSets[i], 0, sizeof(ScoringRules));
+    snprintf(pCtx->pRuleSets[i].pName, SCORING_NAME_MAX, "%s", ppFields[0]);
+    pCtx->ruleSets++;
+  }
+  pRules = &pCtx->pRuleSets[i];
+  pTable = &pRules->pTables[session][0];
+
+  if (parseHalfPoints(ppFields[2], pValues, &count) != RETURN_OK) {
+    logger(log_ERROR, "line %d of %s: illegal points '%s'\n", line, SCORING_FILENAME, ppFields[2]);
+    return RETURN_KO;
+  }
+  memset(pTable, 0, sizeof(ScoreTable));
+  memcpy(pTable->pPositions, pValues, sizeof(int32_t) * count);
+
+  if (parseHalfPoints(ppFields[3], &bonus, &count) != RETURN_OK || count > 1) {
+    logger(log_ERROR, "line %d of %s: illegal fastest lap bonus '%s'\n", line, SCORING_FILENAME, ppFields[3]);
+    return RETURN_KO;
+  }
+  top = atoi(ppFields[4]);
+  if (count == 1) {
+    for (i = 0; i < MAX_DRIVERS && (top <= 0 || i < top); i++) {
+      pTable->pFastestLap[i] = bonus;
+    }
+  }
+
+  pText = ppFields[5];
+  while (true) {
+    while (*pText == ' ') {
+      pText++;
+    }
+    if (*pText == '\0') {
+      break;
+    }
+    round = strtol(pText, &pEnd, 10);
+    if (pEnd == pText || round < 1 || round > MAX_GP) {
+      logger(log_ERROR, "line %d of %s: illegal half points rounds '%s'\n", line, SCORING_FILENAME, ppFields[5]);
+      return RETURN_KO;
+    }
+    pRules->pHalfPoints[session][round - 1] = 1;
+    pText = pEnd;
+  }
+
+  return RETURN_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int loadScoringRules(Context *pCtx, const char *pFileName, const char *pRulesName) {
+  CsvParser *pCsvParser;
+  CsvRow *pCsvRow;
+  int code;
+  int line;
+  int i;
+
+  pCtx->pRuleSets = (ScoringRules *)calloc(SCORING_MAX_RULES, sizeof(ScoringRules));
+  if (pCtx->pRuleSets == NULL) {
+    logger(log_FATAL, "unable to allocate %d bytes for the scoring rules.\n",
+           (int)(sizeof(ScoringRules) * SCORING_MAX_RULES));
+    return RETURN_KO;
+  }
+  pCtx->ruleSets = 0;
+
+  code = RETURN_OK;
+  if (access(pFileName, F_OK) != 0) {
+    logger(log_INFO, "no file %s, the built-in '%s' rules are used\n", pFileName, SCORING_DEFAULT_RULES);
+    defaultScoringRules(&pCtx->pRuleSets[0]);
+    pCtx->ruleSets = 1;
+  } else {
+    pCsvParser = csvParserCreate(pFileName, NULL, true);
+    if (pCsvParser == NULL) {
+      logger(log_ERROR, "unable to create new parser for '%s'.\n", pFileName);
+      return RETURN_KO;
+    }
+    for (line = 2; code == RETURN_OK && (pCsvRow = csvParserGetRow(pCsvParser)) != NULL; line++) {
+      code = parseScoringRow(pCtx, pCsvRow, line);
+      csvParserDestroyRow(pCsvRow);
+    }
+    csvParserDestroy(pCsvParser);
+    if (code) {
+      return code;
+    }
+    for (i = 0; i < pCtx->ruleSets; i++) {
+      compileScoringRules(&pCtx->pRuleSets[i]);
+    }
+  }
+
+  if (pCtx->ruleSets == 0) {
+    logger(log_ERROR, "file %s contains no rules\n", pFileName);
+    return RETURN_KO;
+  }
+  if (pRulesName == NULL) {
+    pCtx->pScoring = &pCtx->pRuleSets[0];
+    return RETURN_OK;
+  }
+  for (i = 0; i < pCtx->ruleSets; i++) {
+    if (strcmp(pCtx->pRuleSets[i].pName, pRulesName) == 0) {
+      pCtx->pScoring = &pCtx->pRuleSets[i];
+      return RETURN_OK;
+    }
+  }
+
+  logger(log_ERROR, "no rules '%s' in %s\n", pRulesName, pFileName);
+  return RETURN_KO;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void freeScoringRules(Context *pCtx) {
+  free(pCtx->pRuleSets);
+  pCtx->pRuleSets = NULL;
+  pCtx->pScoring = NULL;
+  pCtx->ruleSets = 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool racePoints(const ScoringRules *pRules, int grandPrixId, const Race *pRace, int32_t *pPoints) {
+  const ScoreTable *pTable;
+  const RaceInfo *pRaceInfo;
+  uint32_t bestKey;
+  uint32_t key;
+  int session;
+  int fastest;
+  int i;
+
+  if (pRace->type != race_SPRINT && pRace->type != race_GP) {
+    memset(pPoints, 0, sizeof(int32_t) * MAX_DRIVERS);
+    return false;
+  }
+  session = pRace->type == race_GP ? scoring_GRAND_PRIX : scoring_SPRINT;
+  pTable = &pRules->pTables[session][pRules->pHalfPoints[session][grandPrixId]];
+
+  // the fastest lap, a time of 0 (no lap) becomes the largest key and never wins
+  pRaceInfo = pRace->pItems;
+  fastest = 0;
+  bestKey = UINT32_MAX;
+  for (i = 0; i < MAX_DRIVERS; i++) {
+    key = pRaceInfo[i].bestLapTime - 1;
+    fastest = key < bestKey ? i : fastest;
+    bestKey = key < bestKey ? key : bestKey;
+  }
+  fastest = bestKey == UINT32_MAX ? MAX_DRIVERS : fastest;
+
+  for (i = 0; i < MAX_DRIVERS; i++) {
+    pPoints[i] = pTable->pPositions[i] + pTable->pFastestLap[i] * (i == fastest);
+  }
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+char *pointsToString(int32_t halfPoints, char *pOutput, size_t size) {
+  if (halfPoints % 2 == 0) {
+    snprintf(pOutput, size, "%d", halfPoints / 2);
+  } else {
+    snprintf(pOutput, size, "%d.5", halfPoints / 2);
+  }
+
+  return pOutput;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
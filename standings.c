@@ -0,0 +1,180 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "standings.h"
+#include "util.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int compareStandingsTableItem(const void *pA, const void *pB) {
+  int compare;
+
+  compare = ((StandingsTableItem *)pB)->points - ((StandingsTableItem *)pA)->points;
+  if (compare == 0) {
+    compare = ((StandingsTableItem *)pA)->carId - ((StandingsTableItem *)pB)->carId;
+  }
+  return compare;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Points of each finishing position of a sprint or Grand Prix, false when the race gives no point. The carIds are
+// checked once per race so that the loops adding the points have no branch.
+static bool scoreRace(const ScoringRules *pRules, int grandPrixId, const Race *pRace, int32_t *pPoints) {
+  uint32_t invalid;
+  int car;
+
+  if (!racePoints(pRules, grandPrixId, pRace, pPoints)) {
+    return false;
+  }
+
+  invalid = 0;
+  for (car = 0; car < MAX_DRIVERS; car++) {
+    invalid |= (uint32_t)pRace->pItems[car].carId >= MAX_DRIVERS;
+  }
+  if (invalid) {
+    logger(log_WARN, "%s of Grand Prix %d has an invalid carId, its points are ignored\n",
+           raceTypeToString(pRace->type), grandPrixId + 1);
+    return false;
+  }
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void addStandingsPoints(const ScoringRules *pRules, StandingsPoints *pStandings, int grandPrixId, const Race *pRace) {
+  int32_t pPoints[MAX_DRIVERS];
+  int car;
+
+  if (!scoreRace(pRules, grandPrixId, pRace, pPoints)) {
+    return;
+  }
+  for (car = 0; car < MAX_DRIVERS; car++) {
+    pStandings->pPoints[pRace->pItems[car].carId] += pPoints[car];
+  }
+  pStandings->sessions++;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void computeStandings(const ScoringRules *pRules, const GrandPrix *pGrandPrix, StandingsPoints *pStandings) {
+  int i;
+
+  memset(pStandings, 0, sizeof(StandingsPoints));
+  pStandings->rules = pRules->crc;
+  for (i = 0; i < MAX_GP; i++, pGrandPrix++) {
+    if (pGrandPrix->specialGP && pGrandPrix->nextStep > race_SPRINT) {
+      addStandingsPoints(pRules, pStandings, i, &pGrandPrix->sprint);
+    }
+    if (pGrandPrix->nextStep > race_GP) {
+      addStandingsPoints(pRules, pStandings, i, &pGrandPrix->final);
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+bool sameStandings(const StandingsPoints *pA, const StandingsPoints *pB) {
+  return pA->sessions == pB->sessions && memcmp(pA->pPoints, pB->pPoints, sizeof(pA->pPoints)) == 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void rankStandings(const StandingsPoints *pStandings, StandingsTable *pTable) {
+  StandingsTableItem item;
+  int i;
+  int j;
+
+  for (i = 0; i < MAX_DRIVERS; i++) {
+    pTable->pItems[i].carId = i;
+    pTable->pItems[i].points = pStandings->pPoints[i];
+  }
+
+  // insertion sort, MAX_DRIVERS items
+  for (i = 1; i < MAX_DRIVERS; i++) {
+    item = pTable->pItems[i];
+    for (j = i; j > 0 && compareStandingsTableItem(&pTable->pItems[j - 1], &item) > 0; j--) {
+      pTable->pItems[j] = pTable->pItems[j - 1];
+    }
+    pTable->pItems[j] = item;
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void internTeams(Context *pCtx) {
+  const char *pTeam;
+  int teamId;
+  int carId;
+
+  pCtx->teams = 0;
+  for (carId = 0; carId < MAX_DRIVERS; carId++) {
+    pTeam = pCtx->pDrivers[carId].pTeam;
+    for (teamId = 0; teamId < pCtx->teams; teamId++) {
+      if (strcmp(pCtx->ppTeamNames[teamId], pTeam) == 0) {
+        break;
+      }
+    }
+    if (teamId == pCtx->teams) {
+      pCtx->ppTeamNames[pCtx->teams++] = pTeam;
+    }
+    pCtx->pTeamIds[carId] = teamId;
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void computeConstructorPoints(Context *pCtx) {
+  int carId;
+
+  memset(pCtx->pConstructorPoints, 0, sizeof(pCtx->pConstructorPoints));
+  for (carId = 0; carId < MAX_DRIVERS; carId++) {
+    pCtx->pConstructorPoints[pCtx->pTeamIds[carId]] += pCtx->pStandings->pPoints[carId];
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void rankConstructors(Context *pCtx) {
+  ConstructorsTable *pTable;
+  ConstructorsTableItem item;
+  int i;
+  int j;
+
+  pTable = &pCtx->constructorsTable;
+  pTable->teams = pCtx->teams;
+  for (i = 0; i < pTable->teams; i++) {
+    item.teamId = i;
+    item.points = pCtx->pConstructorPoints[i];
+    for (j = i; j > 0 && pTable->pItems[j - 1].points < item.points; j--) {
+      pTable->pItems[j] = pTable->pItems[j - 1];
+    }
+    pTable->pItems[j] = item;
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void addRaceToStandings(Context *pCtx, int grandPrixId, const Race *pRace) {
+  int32_t pPoints[MAX_DRIVERS];
+  int carId;
+  int car;
+
+  if (!scoreRace(pCtx->pScoring, grandPrixId, pRace, pPoints)) {
+    return;
+  }
+  for (car = 0; car < MAX_DRIVERS; car++) {
+    carId = pRace->pItems[car].carId;
+    pCtx->pStandings->pPoints[carId] += pPoints[car];
+    pCtx->pConstructorPoints[pCtx->pTeamIds[carId]] += pPoints[car];
+  }
+  pCtx->pStandings->sessions++;
+
+  rankStandings(pCtx->pStandings, &pCtx->standingsTable);
+  rankConstructors(pCtx);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
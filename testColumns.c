@@ -0,0 +1,166 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "grandPrix.h"
+#include "catalog.h"
+#include "columnar.h"
+#include "testFixtures.h"
+#include "util.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define TEST_COLUMNS_FILENAME "testColumns.col"
+#define TEST_YEAR 2024
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// A season stopped in the middle of a sprint weekend, the later Grands Prix never run
+static void fillSeason(GrandPrix *pGrandPrix) {
+  Race *pRaces;
+  int gp;
+  int i;
+
+  for (gp = 0; gp < MAX_GP / 2; gp++) {
+    pGrandPrix[gp].grandPrixId = gp;
+    pGrandPrix[gp].specialGP = gp % 4 == 2;
+    pGrandPrix[gp].nextStep = race_FINISHED;
+    pRaces = pGrandPrix[gp].pPractices;
+    for (i = 0; i < RACES_PER_GP; i++) {
+      // the sessions of the slots of a sprint weekend stay unused in the other ones
+      if (pGrandPrix[gp].specialGP ? i == 1 || i == 2 : i >= 3 && i <= 6) {
+        continue;
+      }
+      fillRace(&pRaces[i], (RaceType)(race_P1 + i));
+    }
+  }
+  pGrandPrix[gp].grandPrixId = gp;
+  pGrandPrix[gp].specialGP = 1;
+  pGrandPrix[gp].nextStep = race_SPRINT;
+  fillRace(&pGrandPrix[gp].pPractices[0], race_P1);
+  for (i = 0; i < 3; i++) {
+    fillRace(&pGrandPrix[gp].pSprintShootout[i], (RaceType)(race_Q1_SPRINT + i));
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Every column and index of the mapped file against the built ones
+static bool sameColumns(const ResultColumns *pBuilt, const ResultColumns *pMapped) {
+  const uint32_t *ppBuiltMetrics[] = {pBuilt->pRaceTime, pBuilt->pBestLapTime, pBuilt->pBestS1, pBuilt->pBestS2,
+                                      pBuilt->pBestS3,   pBuilt->pPits,        pBuilt->pPitsTime};
+  const uint32_t *ppMappedMetrics[] = {pMapped->pRaceTime, pMapped->pBestLapTime, pMapped->pBestS1, pMapped->pBestS2,
+                                       pMapped->pBestS3,   pMapped->pPits,        pMapped->pPitsTime};
+  const RaceType pTypes[] = {race_ERROR, race_P1, race_Q3_SPRINT, race_SPRINT, race_Q3_GP, race_GP};
+  uint32_t pBuiltMin[MAX_GP];
+  uint32_t pMappedMin[MAX_GP];
+  uint64_t pBuiltSum[MAX_GP];
+  uint64_t pMappedSum[MAX_GP];
+  size_t metric;
+  size_t type;
+  size_t rows;
+
+  rows = pBuilt->rows;
+  if (pMapped->rows != pBuilt->rows || pMapped->year != pBuilt->year ||
+      memcmp(pMapped->pGrandPrixStarts, pBuilt->pGrandPrixStarts, sizeof(pBuilt->pGrandPrixStarts)) != 0 ||
+      memcmp(pMapped->pGrandPrixId, pBuilt->pGrandPrixId, rows) != 0 ||
+      memcmp(pMapped->pType, pBuilt->pType, rows) != 0 || memcmp(pMapped->pPosition, pBuilt->pPosition, rows) != 0 ||
+      memcmp(pMapped->pCarId, pBuilt->pCarId, rows) != 0) {
+    printf("ERROR: dimensions of %s differ from the built ones\n", TEST_COLUMNS_FILENAME);
+    return false;
+  }
+
+  for (metric = 0; metric < sizeof(ppBuiltMetrics) / sizeof(ppBuiltMetrics[0]); metric++) {
+    if (memcmp(ppMappedMetrics[metric], ppBuiltMetrics[metric], rows * sizeof(uint32_t)) != 0) {
+      printf("ERROR: metric %d of %s differs from the built one\n", (int)metric, TEST_COLUMNS_FILENAME);
+      return false;
+    }
+    for (type = 0; type < sizeof(pTypes) / sizeof(pTypes[0]); type++) {
+      columnMinPerGrandPrix(pBuilt, ppBuiltMetrics[metric], pTypes[type], pBuiltMin);
+      columnMinPerGrandPrix(pMapped, ppMappedMetrics[metric], pTypes[type], pMappedMin);
+      columnSumPerGrandPrix(pBuilt, ppBuiltMetrics[metric], pTypes[type], pBuiltSum);
+      columnSumPerGrandPrix(pMapped, ppMappedMetrics[metric], pTypes[type], pMappedSum);
+      if (memcmp(pBuiltMin, pMappedMin, sizeof(pBuiltMin)) != 0 ||
+          memcmp(pBuiltSum, pMappedSum, sizeof(pBuiltSum)) != 0) {
+        printf("ERROR: aggregates of metric %d for %s differ\n", (int)metric, raceTypeToString(pTypes[type]));
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The stored season is written, mapped back and compared, then a corrupted header must be refused
+static bool checkRoundTrip(const GrandPrix *pGrandPrix) {
+  ResultColumns built;
+  ResultColumns mapped;
+  FILE *pFile;
+  bool same;
+
+  if (buildResultColumns(pGrandPrix, TEST_YEAR, &built) != RETURN_OK) {
+    printf("ERROR: unable to build the columns\n");
+    return false;
+  }
+  if (saveResultColumns(&built, TEST_COLUMNS_FILENAME) != RETURN_OK ||
+      mapResultColumns(TEST_COLUMNS_FILENAME, &mapped) != RETURN_OK) {
+    printf("ERROR: unable to write and map %s\n", TEST_COLUMNS_FILENAME);
+    freeResultColumns(&built);
+    return false;
+  }
+  same = sameColumns(&built, &mapped);
+  printf("INFO: %d rows, %d bytes of columns read back from %s\n", built.rows, (int)built.blockSize,
+         TEST_COLUMNS_FILENAME);
+  freeResultColumns(&mapped);
+  freeResultColumns(&built);
+  if (!same) {
+    return false;
+  }
+
+  // the year of the header, covered by its crc
+  pFile = fopen(TEST_COLUMNS_FILENAME, "r+b");
+  if (pFile == NULL || fseek(pFile, 8, SEEK_SET) != 0 || fputc(0xFF, pFile) == EOF) {
+    printf("ERROR: unable to corrupt %s\n", TEST_COLUMNS_FILENAME);
+    if (pFile != NULL) {
+      fclose(pFile);
+    }
+    return false;
+  }
+  fclose(pFile);
+  if (mapResultColumns(TEST_COLUMNS_FILENAME, &mapped) == RETURN_OK) {
+    printf("ERROR: corrupted header of %s accepted\n", TEST_COLUMNS_FILENAME);
+    freeResultColumns(&mapped);
+    return false;
+  }
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int main(int argc, char *ppArgv[]) {
+  GrandPrix *pGrandPrix;
+  int code;
+
+  pGrandPrix = (GrandPrix *)calloc(MAX_GP, sizeof(GrandPrix));
+  if (pGrandPrix == NULL) {
+    printf("ERROR: unable to allocate the season\n");
+    return EXIT_FAILURE;
+  }
+
+  // a season without any session, then a partly run one
+  code = checkRoundTrip(pGrandPrix) ? EXIT_SUCCESS : EXIT_FAILURE;
+  if (code == EXIT_SUCCESS) {
+    fillSeason(pGrandPrix);
+    code = checkRoundTrip(pGrandPrix) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  free(pGrandPrix);
+  return code;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
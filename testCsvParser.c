@@ -4,36 +4,427 @@
 #include <stdbool.h>
 #include <string.h>
 #include <getopt.h>
+#include <time.h>
+#include <sys/stat.h>
 
 #include "csvParser.h"
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-int main(int argc, char *ppArgv[]) {
-  const char *pFilePath;
+static bool _quiet; // -q: the rows are parsed and counted, not printed, to measure the parser only
+static long _rows;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void printSliceHeader(const CsvSliceRow *pCsvHeader) {
+  int i;
+
+  if (_quiet) {
+    return;
+  }
+  for (i = 0; i < pCsvHeader->fields; i++) {
+    printf("Header #%d: '%.*s'\n", i, pCsvHeader->pFields[i].length, pCsvHeader->pFields[i].pData);
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void printSliceRow(const CsvSliceRow *pCsvHeader, const CsvSliceRow *pRow) {
+  int i;
+
+  _rows++;
+  if (_quiet) {
+    return;
+  }
+  printf("{");
+  for (i = 0; i < pRow->fields; i++) {
+    if (i > 0) {
+      printf(",");
+    }
+    if (pCsvHeader != NULL && i < pCsvHeader->fields) {
+      printf("\"%.*s\": \"%.*s\"", pCsvHeader->pFields[i].length, pCsvHeader->pFields[i].pData,
+             pRow->pFields[i].length, pRow->pFields[i].pData);
+    } else {
+      printf("\"FIELD_%d\": \"%.*s\"", i, pRow->pFields[i].length, pRow->pFields[i].pData);
+    }
+  }
+  printf("}\n");
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Same output as the row parser, from the slices of the mapped file
+static int printSlices(const char *pFilePath, bool header, bool structuralIndex) {
+  const CsvSliceRow *pCsvHeader;
   CsvParser *pCsvParser;
-  CsvRow *pCsvHeader;
-  CsvRow *pCsvRow;
+  CsvSliceRow row;
+
+  pCsvParser = csvParserCreateFromMapping(pFilePath, NULL, header);
+  if (pCsvParser == NULL) {
+    printf("ERROR: unable to create new parser for '%s'.\n", pFilePath);
+    return EXIT_FAILURE;
+  }
+  csvParserUseStructuralIndex(pCsvParser, structuralIndex);
+
+  pCsvHeader = NULL;
+  if (header) {
+    pCsvHeader = csvParserGetSliceHeader(pCsvParser);
+    if (pCsvHeader == NULL) {
+      printf("ERROR: unable to create get CSV headers, error=%s.\n", csvParserGetErrorMessage(pCsvParser));
+      csvParserDestroy(pCsvParser);
+      return EXIT_FAILURE;
+    }
+    printSliceHeader(pCsvHeader);
+  }
+
+  while (csvParserGetSlices(pCsvParser, &row)) {
+    printSliceRow(pCsvHeader, &row);
+  }
+
+  csvParserDestroy(pCsvParser);
+
+  return EXIT_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+typedef struct StreamState {
+  CsvParser *pCsvParser;
+  const CsvSliceRow *pCsvHeader;
   bool header;
+} StreamState;
+
+static bool printStreamedRow(const CsvSliceRow *pRow, void *pUser) {
+  StreamState *pState;
+
+  pState = (StreamState *)pUser;
+  if (pState->header && pState->pCsvHeader == NULL) {
+    // read by the parser with the first chunk
+    pState->pCsvHeader = csvParserGetSliceHeader(pState->pCsvParser);
+    printSliceHeader(pState->pCsvHeader);
+  }
+  printSliceRow(pState->pCsvHeader, pRow);
+  return true;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Same output again, the file read in chunks of chunkSize bytes
+static int printStream(const char *pFilePath, bool header, bool structuralIndex, size_t chunkSize) {
+  StreamState state;
+  int rows;
+
+  state.pCsvParser = csvParserCreate(pFilePath, NULL, header);
+  if (state.pCsvParser == NULL) {
+    printf("ERROR: unable to create new parser for '%s'.\n", pFilePath);
+    return EXIT_FAILURE;
+  }
+  csvParserUseStructuralIndex(state.pCsvParser, structuralIndex);
+  csvParserSetChunkSize(state.pCsvParser, chunkSize);
+  state.pCsvHeader = NULL;
+  state.header = header;
+
+  rows = csvParserForEach(state.pCsvParser, printStreamedRow, &state);
+  if (rows == -1) {
+    printf("ERROR: unable to parse '%s', error=%s.\n", pFilePath, csvParserGetErrorMessage(state.pCsvParser));
+    csvParserDestroy(state.pCsvParser);
+    return EXIT_FAILURE;
+  }
+  if (header && state.pCsvHeader == NULL && csvParserGetSliceHeader(state.pCsvParser) != NULL) {
+    // a header without any row
+    printSliceHeader(csvParserGetSliceHeader(state.pCsvParser));
+  }
+
+  csvParserDestroy(state.pCsvParser);
+
+  return EXIT_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static bool printParallelRow(const CsvSliceRow *pRow, void *pUser) {
+  printSliceRow((const CsvSliceRow *)pUser, pRow);
+  return true;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Same output again, the mapped file parsed by threads
+static int printParallel(const char *pFilePath, bool header, bool structuralIndex, int threads) {
+  const CsvSliceRow *pCsvHeader;
+  CsvParser *pCsvParser;
+
+  pCsvParser = csvParserCreateFromMapping(pFilePath, NULL, header);
+  if (pCsvParser == NULL) {
+    printf("ERROR: unable to create new parser for '%s'.\n", pFilePath);
+    return EXIT_FAILURE;
+  }
+  csvParserUseStructuralIndex(pCsvParser, structuralIndex);
+
+  pCsvHeader = NULL;
+  if (header) {
+    pCsvHeader = csvParserGetSliceHeader(pCsvParser);
+    if (pCsvHeader == NULL) {
+      printf("ERROR: unable to create get CSV headers, error=%s.\n", csvParserGetErrorMessage(pCsvParser));
+      csvParserDestroy(pCsvParser);
+      return EXIT_FAILURE;
+    }
+    printSliceHeader(pCsvHeader);
+  }
+
+  if (csvParserForEachParallel(pCsvParser, threads, printParallelRow, (void *)pCsvHeader) == -1) {
+    printf("ERROR: unable to parse '%s', error=%s.\n", pFilePath, csvParserGetErrorMessage(pCsvParser));
+    csvParserDestroy(pCsvParser);
+    return EXIT_FAILURE;
+  }
+
+  csvParserDestroy(pCsvParser);
+
+  return EXIT_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The rows of the batches against the serial parsing of the same text by csvParserGetSlices(), field by field, then
+// the number of batches
+static int compareBatches(const char *pName, CsvParser *pParallel, CsvParser *pSerial, int threads, int expected) {
+  const CsvSliceRow *pRow;
+  CsvRowBatch *pBatches;
+  CsvSliceRow row;
+  bool same;
+  int batches;
+  int code;
   int i;
-  int opt;
+  int j;
+  int k;
 
-  header = false;
-  while ((opt = getopt(argc, ppArgv, "af:h?")) != -1) {
-    switch (opt) {
-    case 'a':
-      header = true;
-      break;
-    case 'f':
-      pFilePath = optarg;
-      break;
-    case 'h':
-    case '?':
-    default:
-      return EXIT_SUCCESS;
+  pBatches = csvParserGetBatches(pParallel, threads, &batches);
+  if (pBatches == NULL) {
+    printf("ERROR: unable to parse '%s', error=%s.\n", pName, csvParserGetErrorMessage(pParallel));
+    return EXIT_FAILURE;
+  }
+
+  code = EXIT_SUCCESS;
+  for (i = 0; i < batches && code == EXIT_SUCCESS; i++) {
+    for (j = 0; j < pBatches[i].rows && code == EXIT_SUCCESS; j++) {
+      pRow = &pBatches[i].pRows[j];
+      if (!csvParserGetSlices(pSerial, &row)) {
+        printf("ERROR: row of line %d of '%s' in batch %d, not in the serial parsing.\n", pRow->line, pName, i);
+        code = EXIT_FAILURE;
+        break;
+      }
+      same = row.fields == pRow->fields && row.line == pRow->line;
+      for (k = 0; same && k < row.fields; k++) {
+        same = row.pFields[k].length == pRow->pFields[k].length &&
+               memcmp(row.pFields[k].pData, pRow->pFields[k].pData, row.pFields[k].length) == 0;
+      }
+      if (!same) {
+        printf("ERROR: row of line %d of '%s' in batch %d differs from the serial parsing.\n", row.line, pName, i);
+        code = EXIT_FAILURE;
+      }
+      _rows++;
+    }
+  }
+  if (code == EXIT_SUCCESS && csvParserGetSlices(pSerial, &row)) {
+    printf("ERROR: row of line %d of '%s' missing from the batches.\n", row.line, pName);
+    code = EXIT_FAILURE;
+  }
+  csvParserFreeBatches(pBatches, batches);
+
+  fprintf(stderr, "INFO: %d batches of '%s' for %d threads\n", batches, pName, threads);
+  if (code == EXIT_SUCCESS && batches != expected) {
+    printf("ERROR: '%s' parsed in %d batches, %d expected.\n", pName, batches, expected);
+    code = EXIT_FAILURE;
+  }
+  return code;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// -b: the mapped file must be cut in one batch per thread, as many as its size allows, into the rows of the serial
+// parsing. A fall back to a single thread after a wrong cut fails the check.
+static int checkBatches(const char *pFilePath, bool header, bool structuralIndex, int threads) {
+  CsvParser *pParallel;
+  CsvParser *pSerial;
+  struct stat status;
+  int expected;
+  int code;
+
+  pParallel = csvParserCreateFromMapping(pFilePath, NULL, header);
+  pSerial = csvParserCreateFromMapping(pFilePath, NULL, header);
+  if (pParallel == NULL || pSerial == NULL || stat(pFilePath, &status) != 0) {
+    printf("ERROR: unable to create new parser for '%s'.\n", pFilePath);
+    csvParserDestroy(pParallel);
+    csvParserDestroy(pSerial);
+    return EXIT_FAILURE;
+  }
+  csvParserUseStructuralIndex(pParallel, structuralIndex);
+  csvParserUseStructuralIndex(pSerial, structuralIndex);
+
+  expected = (size_t)status.st_size / CSV_PARALLEL_MIN_CHUNK < (size_t)threads
+                 ? (int)((size_t)status.st_size / CSV_PARALLEL_MIN_CHUNK)
+                 : threads;
+  expected = expected < 1 ? 1 : expected;
+  code = compareBatches(pFilePath, pParallel, pSerial, threads, expected);
+
+  csvParserDestroy(pParallel);
+  csvParserDestroy(pSerial);
+  return code;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Short rows, and at each offset where csvParserGetBatches() cuts the buffer for threads, a quoted field holding ""
+// and a newline: the offset falls between the two quotes of "" in even chunks, on the newline in odd ones
+static char *buildBoundaries(int threads, size_t *pSize) {
+  char *pBuffer;
+  size_t offset;
+  size_t used;
+  size_t cut;
+  int chunk;
+  int row;
+
+  *pSize = (size_t)threads * CSV_PARALLEL_MIN_CHUNK;
+  pBuffer = (char *)malloc(*pSize + 1); // the '\0' of the last sprintf()
+  if (pBuffer == NULL) {
+    return NULL;
+  }
+
+  used = 0;
+  row = 0;
+  for (chunk = 1; chunk <= threads; chunk++) {
+    cut = chunk < threads ? *pSize / threads * chunk : *pSize;
+    while (cut - used > 128) {
+      used += sprintf(pBuffer + used, "%d,row,\"a, b\"\n", row++);
+    }
+    used += sprintf(pBuffer + used, chunk < threads ? "%d,\"" : "%d,", row++);
+    offset = chunk < threads && chunk % 2 == 0 ? cut - 1 : cut;
+    if (chunk == threads) {
+      // the last row ends the buffer
+      offset--;
+    }
+    memset(pBuffer + used, 'x', offset - used);
+    used = offset;
+    if (chunk == threads) {
+      pBuffer[used++] = '\n';
+    } else {
+      used += sprintf(pBuffer + used, "%s\nline, \"\"quoted\"\"\",end\n", chunk % 2 == 0 ? "\"\"" : "");
+    }
+  }
+  return pBuffer;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// -b: a buffer whose cuts all fall inside quoted fields, parsed as one batch per thread into the rows of the serial
+// parsing
+static int checkBoundaries(bool structuralIndex, int threads) {
+  CsvParser *pParallel;
+  CsvParser *pSerial;
+  char *pParallelBuffer;
+  char *pSerialBuffer;
+  size_t size;
+  int code;
+
+  // both parsings unquote the fields in place
+  pParallelBuffer = buildBoundaries(threads, &size);
+  pSerialBuffer = pParallelBuffer != NULL ? (char *)malloc(size) : NULL;
+  if (pSerialBuffer == NULL) {
+    printf("ERROR: unable to allocate the chunk boundaries buffers.\n");
+    free(pParallelBuffer);
+    return EXIT_FAILURE;
+  }
+  memcpy(pSerialBuffer, pParallelBuffer, size);
+
+  pParallel = csvParserCreateFromBuffer(pParallelBuffer, size, NULL, false);
+  pSerial = csvParserCreateFromBuffer(pSerialBuffer, size, NULL, false);
+  csvParserUseStructuralIndex(pParallel, structuralIndex);
+  csvParserUseStructuralIndex(pSerial, structuralIndex);
+  code = compareBatches("chunk boundaries", pParallel, pSerial, threads, threads);
+
+  csvParserDestroy(pParallel);
+  csvParserDestroy(pSerial);
+  free(pParallelBuffer);
+  free(pSerialBuffer);
+  return code;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// -u: fields holding text after their closing quote, unquoted by csvParserGetSlices() as by the row parser: the '\r'
+// skipped, the closing quote kept unless it ends the field
+static int checkUnquote(bool structuralIndex) {
+  static const char *pRows = "1,\"ab\"\rc,end\n"
+                             "2,\"\"\ra,end\n"
+                             "3,\"a\"\r\"\"b,end\n"
+                             "4,\"a\"\"\"\rb,end\n"
+                             "5,\"\"x\r\",end\n"
+                             "6,\"ab\"\r,end\r\n";
+  CsvParser *pSlicesParser;
+  CsvParser *pRowParser;
+  CsvSliceRow row;
+  CsvRow *pCsvRow;
+  char *pBuffer;
+  bool same;
+  int code;
+  int i;
+
+  // the slices are unquoted in place
+  pBuffer = strdup(pRows);
+  pRowParser = csvParserCreateFromString(pRows, NULL, false);
+  pSlicesParser = pBuffer != NULL ? csvParserCreateFromBuffer(pBuffer, strlen(pBuffer), NULL, false) : NULL;
+  if (pRowParser == NULL || pSlicesParser == NULL) {
+    printf("ERROR: unable to create the parsers of the quoted fields.\n");
+    code = EXIT_FAILURE;
+    goto checkUnquoteExit;
+  }
+  csvParserUseStructuralIndex(pSlicesParser, structuralIndex);
+
+  code = EXIT_SUCCESS;
+  while (code == EXIT_SUCCESS && (pCsvRow = csvParserGetRow(pRowParser)) != NULL) {
+    if (!csvParserGetSlices(pSlicesParser, &row)) {
+      printf("ERROR: row %ld of the quoted fields missing from the slices.\n", _rows + 1);
+      code = EXIT_FAILURE;
+    } else {
+      same = row.fields == pCsvRow->fields;
+      for (i = 0; same && i < row.fields; i++) {
+        same = row.pFields[i].length == (int)strlen(pCsvRow->ppFields[i]) &&
+               memcmp(row.pFields[i].pData, pCsvRow->ppFields[i], row.pFields[i].length) == 0;
+      }
+      if (!same) {
+        printf("ERROR: row %ld of the quoted fields differs between the row parser and the slices.\n", _rows + 1);
+        code = EXIT_FAILURE;
+      }
     }
+    _rows++;
+    csvParserDestroyRow(pCsvRow);
+  }
+  if (code == EXIT_SUCCESS && csvParserGetSlices(pSlicesParser, &row)) {
+    printf("ERROR: row %ld of the quoted fields missing from the row parser.\n", _rows + 1);
+    code = EXIT_FAILURE;
+  }
+
+checkUnquoteExit:
+  if (pRowParser != NULL) {
+    csvParserDestroy(pRowParser);
   }
+  if (pSlicesParser != NULL) {
+    csvParserDestroy(pSlicesParser);
+  }
+  free(pBuffer);
+  return code;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
 
+// Row parser, one allocation per row
+static int printRows(const char *pFilePath, bool header) {
+  CsvParser *pCsvParser;
+  CsvRow *pCsvHeader;
+  CsvRow *pCsvRow;
+  int i;
+
+  pCsvHeader = NULL;
   pCsvParser = csvParserCreate(pFilePath, NULL, header);
   if (pCsvParser == NULL) {
     printf("ERROR: unable to create new parser for '%s'.\n", pFilePath);
@@ -47,7 +438,7 @@ int main(int argc, char *ppArgv[]) {
       return EXIT_FAILURE;
     }
 
-    for (i = 0; i < pCsvHeader->fields; i++) {
+    for (i = 0; i < pCsvHeader->fields && !_quiet; i++) {
       printf("Header #%d: '%s'\n", i, pCsvHeader->ppFields[i]);
     }
   }
@@ -57,6 +448,11 @@ int main(int argc, char *ppArgv[]) {
     if (pCsvRow == NULL) {
       break;
     }
+    _rows++;
+    if (_quiet) {
+      csvParserDestroyRow(pCsvRow);
+      continue;
+    }
     printf("{");
     for (i = 0; i < pCsvRow->fields; i++) {
       if (i > 0) {
@@ -81,3 +477,105 @@ int main(int argc, char *ppArgv[]) {
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
+
+int main(int argc, char *ppArgv[]) {
+  struct timespec start;
+  struct timespec end;
+  struct stat status;
+  const char *pFilePath;
+  CsvScanKernel kernel;
+  double seconds;
+  bool structuralIndex;
+  bool header;
+  size_t chunkSize;
+  bool unquote;
+  bool batches;
+  bool slices;
+  int threads;
+  int code;
+  int opt;
+
+  pFilePath = NULL;
+  header = false;
+  unquote = false;
+  batches = false;
+  slices = false;
+  chunkSize = 0;
+  threads = 0;
+  structuralIndex = true;
+  while ((opt = getopt(argc, ppArgv, "abc:f:j:k:mquh?")) != -1) {
+    switch (opt) {
+    case 'a':
+      header = true;
+      break;
+    case 'b':
+      // with -j, checks the batches of csvParserGetBatches() against the serial parsing instead of printing the rows
+      batches = true;
+      break;
+    case 'm':
+      slices = true;
+      break;
+    case 'c':
+      // csvParserForEach() with chunks of this size
+      chunkSize = strtoul(optarg, NULL, 10);
+      break;
+    case 'j':
+      // csvParserForEachParallel() with this number of threads
+      threads = atoi(optarg);
+      break;
+    case 'q':
+      _quiet = true;
+      break;
+    case 'u':
+      unquote = true;
+      break;
+    case 'k':
+      // kernel of the structural index of -m, -c and -j, "none" for the byte per byte parsing
+      structuralIndex = strcmp(optarg, "none") != 0;
+      for (kernel = csvScan_AUTO; kernel <= csvScan_AVX2; kernel++) {
+        if (strcmp(optarg, csvScanKernelName(kernel)) == 0) {
+          break;
+        }
+      }
+      kernel = csvScanSelect(kernel > csvScan_AVX2 ? csvScan_AUTO : kernel);
+      fprintf(stderr, "INFO: structural index %s with the %s kernel\n", structuralIndex ? "used" : "not used",
+              csvScanKernelName(kernel));
+      break;
+    case 'f':
+      pFilePath = optarg;
+      break;
+    case 'h':
+    case '?':
+    default:
+      return EXIT_SUCCESS;
+    }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  if (unquote) {
+    code = checkUnquote(structuralIndex);
+  } else if (threads > 0 && batches) {
+    code = checkBatches(pFilePath, header, structuralIndex, threads);
+    if (code == EXIT_SUCCESS) {
+      code = checkBoundaries(structuralIndex, threads);
+    }
+  } else if (threads > 0) {
+    code = printParallel(pFilePath, header, structuralIndex, threads);
+  } else if (chunkSize > 0) {
+    code = printStream(pFilePath, header, structuralIndex, chunkSize);
+  } else if (slices) {
+    code = printSlices(pFilePath, header, structuralIndex);
+  } else {
+    code = printRows(pFilePath, header);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  seconds = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+  if (code == EXIT_SUCCESS && pFilePath != NULL && stat(pFilePath, &status) == 0 && seconds > 0) {
+    fprintf(stderr, "INFO: %ld rows, %lld bytes in %.3f s: %.1f MB/s, %.0f rows/s\n", _rows,
+            (long long)status.st_size, seconds, (double)status.st_size / seconds / 1e6, (double)_rows / seconds);
+  }
+  return code;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
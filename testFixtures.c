@@ -0,0 +1,60 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "testFixtures.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static uint32_t _random = 2024;
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+uint32_t nextRandom(void) {
+  _random ^= _random << 13;
+  _random ^= _random >> 17;
+  _random ^= _random << 5;
+  return _random;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void fillRace(Race *pRace, RaceType type) {
+  RaceInfo *pRaceInfo;
+  uint32_t lapTime;
+  int pCarIds[MAX_DRIVERS];
+  int swap;
+  int i;
+  int j;
+
+  pRace->type = type;
+  for (i = 0; i < MAX_DRIVERS; i++) {
+    pCarIds[i] = i;
+  }
+  for (i = MAX_DRIVERS - 1; i > 0; i--) {
+    j = (int)(nextRandom() % (uint32_t)(i + 1));
+    swap = pCarIds[i];
+    pCarIds[i] = pCarIds[j];
+    pCarIds[j] = swap;
+  }
+
+  for (i = 0; i < MAX_DRIVERS; i++) {
+    pRaceInfo = &pRace->pItems[i];
+    memset(pRaceInfo, 0, sizeof(RaceInfo));
+    pRaceInfo->carId = pCarIds[i];
+    pRaceInfo->bestLap = (int32_t)(nextRandom() % 50);
+    if (nextRandom() % 8 == 0) {
+      continue;
+    }
+    lapTime = 80000 + nextRandom() % 5000;
+    pRaceInfo->bestLapTime = lapTime;
+    pRaceInfo->bestS1 = lapTime / 3 - nextRandom() % 500;
+    pRaceInfo->bestS2 = lapTime / 3 + nextRandom() % 500;
+    pRaceInfo->bestS3 = lapTime - pRaceInfo->bestS1 - pRaceInfo->bestS2;
+    pRaceInfo->pits = type == race_GP ? (int32_t)(1 + nextRandom() % 3) : 0;
+    pRaceInfo->pitsTime = pRaceInfo->pits * (20000 + nextRandom() % 5000);
+    pRaceInfo->raceTime = 5400000 + i * 3000 + nextRandom() % 3000;
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
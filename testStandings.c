@@ -0,0 +1,182 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "grandPrix.h"
+#include "scoring.h"
+#include "standings.h"
+#include "testFixtures.h"
+#include "util.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define TEST_SCORING_FILENAME "testStandings.csv"
+#define TEST_SCORING_RULES "test"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Half points of the Grand Prix in rounds 1, 5 and 12 and of the sprint in round 3, a sprint every fourth round from
+// the third one: both kinds of sessions are scored with both tables
+static const char *_pScoringFile = "Rules,Session,Points,FastestLap,FastestLapTop,HalfPoints\n"
+                                   "test,Sprint,8 7 6 5 4 3 2 1,0,0,3\n"
+                                   "test,GP,25 18 15 12 10 8 6 4 2 1,1,10,1 5 12\n";
+
+static char _ppTeams[MAX_DRIVERS / 2][16];
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Stores the next session of the Grand Prix, in the order of fillHistoric()
+static void storeSession(Context *pCtx, int grandPrixId) {
+  GrandPrix *pGrandPrix;
+  RaceType type;
+
+  pGrandPrix = &pCtx->pGrandPrix[grandPrixId];
+  type = (RaceType)pGrandPrix->nextStep;
+  switch (type) {
+  case race_P1:
+  case race_P2:
+  case race_P3:
+    fillRace(&pGrandPrix->pPractices[type - race_P1], type);
+    if (type == race_P1 && pGrandPrix->specialGP) {
+      pGrandPrix->nextStep = race_Q1_SPRINT;
+    } else {
+      pGrandPrix->nextStep = type == race_P3 ? race_Q1_GP : type + 1;
+    }
+    break;
+  case race_Q1_SPRINT:
+  case race_Q2_SPRINT:
+  case race_Q3_SPRINT:
+    fillRace(&pGrandPrix->pSprintShootout[type - race_Q1_SPRINT], type);
+    pGrandPrix->nextStep = type + 1;
+    break;
+  case race_SPRINT:
+    fillRace(&pGrandPrix->sprint, type);
+    addRaceToStandings(pCtx, grandPrixId, &pGrandPrix->sprint);
+    pGrandPrix->nextStep = race_Q1_GP;
+    break;
+  case race_Q1_GP:
+  case race_Q2_GP:
+  case race_Q3_GP:
+    fillRace(&pGrandPrix->pQualifications[type - race_Q1_GP], type);
+    pGrandPrix->nextStep = type + 1;
+    break;
+  case race_GP:
+    fillRace(&pGrandPrix->final, type);
+    addRaceToStandings(pCtx, grandPrixId, &pGrandPrix->final);
+    pGrandPrix->nextStep = race_FINISHED;
+    break;
+  default:
+    break;
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The incremental standings, ranks and constructor points against a full recompute of the records
+static bool checkStandings(Context *pCtx, int grandPrixId) {
+  int32_t pConstructorPoints[MAX_DRIVERS];
+  StandingsTable standingsTable;
+  StandingsPoints standings;
+  bool same;
+  int i;
+
+  computeStandings(pCtx->pScoring, pCtx->pGrandPrix, &standings);
+  same = sameStandings(pCtx->pStandings, &standings);
+
+  rankStandings(&standings, &standingsTable);
+  same = same && memcmp(&standingsTable, &pCtx->standingsTable, sizeof(StandingsTable)) == 0;
+
+  memcpy(pConstructorPoints, pCtx->pConstructorPoints, sizeof(pConstructorPoints));
+  computeConstructorPoints(pCtx);
+  same = same && memcmp(pConstructorPoints, pCtx->pConstructorPoints, sizeof(pConstructorPoints)) == 0;
+
+  if (!same) {
+    printf("ERROR: standings differ after step %d of Grand Prix %d\n", pCtx->pGrandPrix[grandPrixId].nextStep,
+           grandPrixId + 1);
+    for (i = 0; i < MAX_DRIVERS; i++) {
+      printf("  carId %2d: %5d incremental, %5d recomputed\n", i, pCtx->pStandings->pPoints[i], standings.pPoints[i]);
+    }
+  }
+  return same;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int main(int argc, char *ppArgv[]) {
+  StandingsPoints standings;
+  Context *pCtx;
+  FILE *pFile;
+  bool halfPoints;
+  int code;
+  int i;
+
+  code = EXIT_FAILURE;
+  pCtx = (Context *)calloc(1, sizeof(Context));
+  pFile = fopen(TEST_SCORING_FILENAME, "w");
+  if (pCtx == NULL || pFile == NULL || fputs(_pScoringFile, pFile) == EOF) {
+    printf("ERROR: unable to write '%s'\n", TEST_SCORING_FILENAME);
+    goto mainExit;
+  }
+  fclose(pFile);
+  pFile = NULL;
+
+  if (loadScoringRules(pCtx, TEST_SCORING_FILENAME, TEST_SCORING_RULES) != RETURN_OK) {
+    printf("ERROR: unable to load the '%s' rules of '%s'\n", TEST_SCORING_RULES, TEST_SCORING_FILENAME);
+    goto mainExit;
+  }
+  halfPoints = pCtx->pScoring->pHalfPoints[scoring_SPRINT][2] && pCtx->pScoring->pHalfPoints[scoring_GRAND_PRIX][0];
+  if (!halfPoints) {
+    printf("ERROR: half points rounds of '%s' not loaded\n", TEST_SCORING_FILENAME);
+    goto mainExit;
+  }
+
+  // two drivers per team, as in Drivers.csv
+  for (i = 0; i < MAX_DRIVERS; i++) {
+    snprintf(_ppTeams[i / 2], sizeof(_ppTeams[i / 2]), "Team %d", i / 2);
+    pCtx->pDrivers[i].pTeam = _ppTeams[i / 2];
+  }
+  internTeams(pCtx);
+
+  pCtx->pGrandPrix = (GrandPrix *)calloc(MAX_GP, sizeof(GrandPrix));
+  pCtx->pStandings = &standings;
+  if (pCtx->pGrandPrix == NULL) {
+    printf("ERROR: unable to allocate the season\n");
+    goto mainExit;
+  }
+  memset(&standings, 0, sizeof(standings));
+  standings.rules = pCtx->pScoring->crc;
+  rankStandings(pCtx->pStandings, &pCtx->standingsTable);
+  computeConstructorPoints(pCtx);
+  rankConstructors(pCtx);
+
+  for (i = 0; i < MAX_GP; i++) {
+    pCtx->pGrandPrix[i].grandPrixId = i;
+    pCtx->pGrandPrix[i].specialGP = i % 4 == 2;
+    pCtx->pGrandPrix[i].nextStep = race_P1;
+    while (pCtx->pGrandPrix[i].nextStep != race_FINISHED) {
+      storeSession(pCtx, i);
+      if (!checkStandings(pCtx, i)) {
+        goto mainExit;
+      }
+    }
+  }
+
+  printf("INFO: %d sessions scored, standings identical to the full recompute after each session\n",
+         standings.sessions);
+  code = EXIT_SUCCESS;
+
+mainExit:
+  if (pFile != NULL) {
+    fclose(pFile);
+  }
+  if (pCtx != NULL) {
+    free(pCtx->pGrandPrix);
+    freeScoringRules(pCtx);
+    free(pCtx);
+  }
+  return code;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,203 @@
+#include <string.h>
+
+#include "timeFormat.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// clang-format off
+#define DIGITS_10(prefix) prefix "0" prefix "1" prefix "2" prefix "3" prefix "4" \
+                          prefix "5" prefix "6" prefix "7" prefix "8" prefix "9"
+#define DIGITS_100(prefix) DIGITS_10(prefix "0") DIGITS_10(prefix "1") DIGITS_10(prefix "2") DIGITS_10(prefix "3") \
+                           DIGITS_10(prefix "4") DIGITS_10(prefix "5") DIGITS_10(prefix "6") DIGITS_10(prefix "7") \
+                           DIGITS_10(prefix "8") DIGITS_10(prefix "9")
+// clang-format on
+
+// "00" "01" ... "99" and "000" "001" ... "999" without separator
+static const char _pDigits2[] = DIGITS_100("");
+static const char _pDigits3[] = DIGITS_100("0") DIGITS_100("1") DIGITS_100("2") DIGITS_100("3") DIGITS_100("4")
+    DIGITS_100("5") DIGITS_100("6") DIGITS_100("7") DIGITS_100("8") DIGITS_100("9");
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static inline char *putDigits2(char *pOutput, uint32_t value) {
+  memcpy(pOutput, &_pDigits2[value * 2], 2);
+  return pOutput + 2;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static inline char *putDigits3(char *pOutput, uint32_t value) {
+  memcpy(pOutput, &_pDigits3[value * 3], 3);
+  return pOutput + 3;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static inline char *putUnsigned(char *pOutput, uint32_t value) {
+  char pBuffer[10];
+  char *pDigits;
+  int length;
+
+  if (value < 10) {
+    *pOutput = (char)('0' + value);
+    return pOutput + 1;
+  }
+  if (value < 100) {
+    return putDigits2(pOutput, value);
+  }
+
+  // two digits at a time from the right, then copied in order
+  pDigits = pBuffer + sizeof(pBuffer);
+  while (value >= 100) {
+    pDigits -= 2;
+    memcpy(pDigits, &_pDigits2[(value % 100) * 2], 2);
+    value /= 100;
+  }
+  if (value >= 10) {
+    pDigits -= 2;
+    memcpy(pDigits, &_pDigits2[value * 2], 2);
+  } else {
+    *--pDigits = (char)('0' + value);
+  }
+
+  length = (int)(pBuffer + sizeof(pBuffer) - pDigits);
+  memcpy(pOutput, pDigits, length);
+
+  return pOutput + length;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int formatUnsigned(uint32_t value, char *pOutput) {
+  char *pEnd;
+
+  pEnd = putUnsigned(pOutput, value);
+  *pEnd = 0;
+
+  return (int)(pEnd - pOutput);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int formatHour(uint32_t timeMs, char *pOutput) {
+  uint32_t milli;
+  uint32_t second;
+  uint32_t minute;
+  char *pEnd;
+
+  milli = timeMs % 1000;
+  timeMs /= 1000;
+  second = timeMs % 60;
+  timeMs /= 60;
+  minute = timeMs % 60;
+
+  pEnd = putUnsigned(pOutput, timeMs / 60);
+  *pEnd++ = ':';
+  pEnd = putDigits2(pEnd, minute);
+  *pEnd++ = ':';
+  pEnd = putDigits2(pEnd, second);
+  *pEnd++ = '.';
+  pEnd = putDigits3(pEnd, milli);
+  *pEnd = 0;
+
+  return (int)(pEnd - pOutput);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int formatMinute(uint32_t timeMs, char *pOutput) {
+  uint32_t milli;
+  uint32_t second;
+  char *pEnd;
+
+  milli = timeMs % 1000;
+  timeMs /= 1000;
+  second = timeMs % 60;
+
+  pEnd = putUnsigned(pOutput, timeMs / 60);
+  *pEnd++ = ':';
+  pEnd = putDigits2(pEnd, second);
+  *pEnd++ = '.';
+  pEnd = putDigits3(pEnd, milli);
+  *pEnd = 0;
+
+  return (int)(pEnd - pOutput);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int formatSecond(uint32_t timeMs, char *pOutput) {
+  char *pEnd;
+
+  pEnd = putUnsigned(pOutput, timeMs / 1000);
+  *pEnd++ = '.';
+  pEnd = putDigits3(pEnd, timeMs % 1000);
+  *pEnd = 0;
+
+  return (int)(pEnd - pOutput);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int formatGap(uint32_t timeMs, char *pOutput) {
+  char *pEnd;
+
+  pOutput[0] = '+';
+  pEnd = putUnsigned(pOutput + 1, timeMs / 1000);
+  *pEnd++ = '.';
+  pEnd = putDigits3(pEnd, timeMs % 1000);
+  *pEnd++ = 's';
+  *pEnd = 0;
+
+  return (int)(pEnd - pOutput);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int formatTime(TimeFormat format, uint32_t timeMs, char *pOutput) {
+  switch (format) {
+  case format_HOUR:
+    return formatHour(timeMs, pOutput);
+  case format_MINUTE:
+    return formatMinute(timeMs, pOutput);
+  case format_SECOND:
+    return formatSecond(timeMs, pOutput);
+  case format_GAP:
+    return formatGap(timeMs, pOutput);
+  }
+
+  *pOutput = 0;
+  return 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void formatTimeColumn(TimeFormat format, const uint32_t *pTimes, int count, char *pOutput, int stride) {
+  int i;
+
+  // one loop per format so that the dispatch is not repeated for every value
+  switch (format) {
+  case format_HOUR:
+    for (i = 0; i < count; i++, pOutput += stride) {
+      formatHour(pTimes[i], pOutput);
+    }
+    break;
+  case format_MINUTE:
+    for (i = 0; i < count; i++, pOutput += stride) {
+      formatMinute(pTimes[i], pOutput);
+    }
+    break;
+  case format_SECOND:
+    for (i = 0; i < count; i++, pOutput += stride) {
+      formatSecond(pTimes[i], pOutput);
+    }
+    break;
+  case format_GAP:
+    for (i = 0; i < count; i++, pOutput += stride) {
+      formatGap(pTimes[i], pOutput);
+    }
+    break;
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
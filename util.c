@@ -1,16 +1,100 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
 #include <string.h>
 #include <stdarg.h>
 #include <time.h>
 #include <sys/time.h>
+#include <unistd.h>
+#include <pthread.h>
 
 #include "util.h"
+#include "timeFormat.h"
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+#define LOG_STAR_PRECISION -2
+#define LOG_FORMATTED_BY_CALLER 0xFF
+#define LOG_FORMAT_CACHE 64 // formats parsed by each thread, a power of 2
+#define LOG_MAX_RINGS 256   // threads logging at the same time
+
+typedef enum enumLogArgument {
+  argument_NONE, // %%
+  argument_INT,
+  argument_LONG,
+  argument_LONG_LONG,
+  argument_SIZE,
+  argument_INTMAX,
+  argument_PTRDIFF,
+  argument_DOUBLE,
+  argument_STRING,
+  argument_POINTER,
+  argument_UNSUPPORTED // %n, %Lf, %ls...: the message is formatted by the caller
+} LogArgument;
+
+typedef struct structLogConversion {
+  LogArgument argument;
+  int stars;     // '*' width and precision, each taking an int argument
+  int precision; // -1 for none, LOG_STAR_PRECISION when given by an argument
+  int size;      // characters from the '%' to the conversion character included
+} LogConversion;
+
+// A message waiting to be written: its format, its arguments as they were passed and a copy of its strings. A
+// message that cannot be kept this way is formatted by the caller in pText, pFormat NULL.
+typedef struct structLogRecord {
+  uint64_t timeUs; // wall clock
+  const char *pFormat;
+  uint8_t level;
+  uint8_t arguments;
+  uint16_t textUsed;
+  uint64_t pArguments[LOG_MAX_ARGUMENTS]; // integers, double bits, or the offset of a string in pText
+  char pText[LOG_TEXT_SIZE];
+} LogRecord;
+
+// Arguments of a format, parsed at its first use by a thread
+typedef struct structLogFormat {
+  const char *pFormat;
+  uint8_t arguments;                     // LOG_FORMATTED_BY_CALLER when they cannot be copied
+  uint8_t pArguments[LOG_MAX_ARGUMENTS]; // LogArgument of each one
+  int16_t pPrecisions[LOG_MAX_ARGUMENTS];
+} LogFormat;
+
+typedef enum enumRingState {
+  ring_FREE,
+  ring_OWNED,
+  ring_RELEASED // its thread is gone, free once written
+} RingState;
+
+// Queue of one thread, written by it only and read by the writer only: no lock, head and tail on their own lines
+typedef struct structLogRing {
+  struct structLogRing *pNext; // list of all the rings, never shrunk
+  int state;
+  uint64_t dropped;
+  char pPadding1[64];
+  uint32_t head; // next record written
+  char pPadding2[64];
+  uint32_t tail; // next record read
+  char pPadding3[64];
+  LogFormat pFormats[LOG_FORMAT_CACHE]; // by address of the format
+  LogRecord pRecords[LOG_RING_SIZE];
+} LogRing;
+
 static Level _level = log_DEBUG;
 static FILE *_logFile = NULL;
+static pthread_once_t _loggerOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t _flushLock = PTHREAD_MUTEX_INITIALIZER; // held by the one draining the rings
+static pthread_cond_t _flushWakeUp = PTHREAD_COND_INITIALIZER;
+static pthread_t _writerThread;
+static bool _writerStarted;
+static bool _stopping;
+static bool _stopped;
+static pthread_key_t _ringKey; // releases the ring of a thread when it ends
+static __thread LogRing *_pThreadRing;
+static LogRing *_pRings;
+static uint64_t _droppedWithoutRing;
+static uint64_t _droppedReported;
 static const char *const _ppLevelStr[] = {
     [log_NONE] = "",     [log_OFF] = "OFF",     [log_FATAL] = "FATAL", [log_ERROR] = "ERROR", [log_WARN] = "WARN",
     [log_INFO] = "INFO", [log_DEBUG] = "DEBUG", [log_TRACE] = "TRACE", [log_ALL] = "ALL"};
@@ -57,67 +141,110 @@ RaceType stringToRaceType(const char *pType) {
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-char *timestampToHour(uint32_t timeMs, char *pOutput, int size) {
-  int milli;
-  int second;
-  int minute;
-  int hour;
+// Copies a formatted time like snprintf() would have done: truncated to size - 1 characters and NUL terminated
+static char *copyFormattedTime(TimeFormat format, uint32_t timeMs, char *pOutput, int size) {
+  char pText[TIME_FORMAT_MAX];
+  int length;
 
-  milli = timeMs % 1000;
-  timeMs /= 1000;
-  second = timeMs % 60;
-  timeMs /= 60;
-  minute = timeMs % 60;
-  hour = timeMs / 60;
+  if (size >= TIME_FORMAT_MAX) {
+    formatTime(format, timeMs, pOutput);
+    return pOutput;
+  }
+  if (size <= 0) {
+    return pOutput;
+  }
 
-  snprintf(pOutput, size, "%d:%02d:%02d.%03d", hour, minute, second, milli);
+  length = formatTime(format, timeMs, pText);
+  if (length > size - 1) {
+    length = size - 1;
+  }
+  memcpy(pOutput, pText, length);
+  pOutput[length] = 0;
 
   return pOutput;
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
+char *timestampToHour(uint32_t timeMs, char *pOutput, int size) {
+  return copyFormattedTime(format_HOUR, timeMs, pOutput, size);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
 char *timestampToMinute(uint32_t timeMs, char *pOutput, int size) {
-  int milli;
-  int second;
-  int minute;
+  return copyFormattedTime(format_MINUTE, timeMs, pOutput, size);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
 
-  milli = timeMs % 1000;
-  timeMs /= 1000;
-  second = timeMs % 60;
-  minute = timeMs / 60;
+char *timestampToSecond(uint32_t timeMs, char *pOutput, int size) {
+  return copyFormattedTime(format_SECOND, timeMs, pOutput, size);
+}
 
-  snprintf(pOutput, size, "%d:%02d.%03d", minute, second, milli);
+/*--------------------------------------------------------------------------------------------------------------------*/
 
-  return pOutput;
+char *milliToGap(uint32_t timeMs, char *pOutput, int size) {
+  return copyFormattedTime(format_GAP, timeMs, pOutput, size);
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-char *timestampToSecond(uint32_t timeMs, char *pOutput, int size) {
-  int milli;
-  int second;
+uint64_t monotonicMicros(void) {
+  struct timespec now;
 
-  milli = timeMs % 1000;
-  second = timeMs / 1000;
+  clock_gettime(CLOCK_MONOTONIC, &now);
 
-  snprintf(pOutput, size, "%d.%03d", second, milli);
+  return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
 
-  return pOutput;
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+int processorCores(void) {
+#ifdef WIN64
+  SYSTEM_INFO info;
+
+  GetSystemInfo(&info);
+  return (int)info.dwNumberOfProcessors;
+#else
+  return (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-char *milliToGap(uint32_t timeMs, char *pOutput, int size) {
-  int milli;
-  int second;
+static uint32_t _pCrc32Table[256];
+static pthread_once_t _crc32Once = PTHREAD_ONCE_INIT;
+
+static void initializeCrc32Table(void) {
+  uint32_t crc;
+  int bit;
+  int i;
+
+  for (i = 0; i < 256; i++) {
+    crc = (uint32_t)i;
+    for (bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+    }
+    _pCrc32Table[i] = crc;
+  }
+}
 
-  milli = timeMs % 1000;
-  second = timeMs / 1000;
+/*--------------------------------------------------------------------------------------------------------------------*/
 
-  snprintf(pOutput, size, "+%d.%03ds", second, milli);
+// CRC-32 (IEEE 802.3), chained by passing the previous result, starting from 0
+uint32_t crc32Update(uint32_t crc, const void *pData, size_t size) {
+  const uint8_t *pBytes;
 
-  return pOutput;
+  pthread_once(&_crc32Once, initializeCrc32Table);
+
+  pBytes = (const uint8_t *)pData;
+  crc = ~crc;
+  while (size-- > 0) {
+    crc = _pCrc32Table[(crc ^ *pBytes++) & 0xFF] ^ (crc >> 8);
+  }
+
+  return ~crc;
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
@@ -134,48 +261,609 @@ void printEvent(EventRace *pEvent) {
 
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-void logger(Level level, const char *pMessage, ...) {
-  char pMessageBuffer[4096];
-  struct timeval currentTime;
-  struct tm timeStorage;
-  va_list vaList;
-  time_t timestamp;
-  size_t size;
+static uint64_t realtimeMicros(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_REALTIME, &now);
+
+  return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Type of the argument of a conversion, from its length modifier and its conversion character
+static LogArgument conversionArgument(char length, char conversion) {
+  switch (conversion) {
+  case 'd':
+  case 'i':
+  case 'u':
+  case 'o':
+  case 'x':
+  case 'X':
+  case 'c':
+    switch (length) {
+    case 'l':
+      return argument_LONG;
+    case 'q':
+      return argument_LONG_LONG;
+    case 'z':
+      return argument_SIZE;
+    case 'j':
+      return argument_INTMAX;
+    case 't':
+      return argument_PTRDIFF;
+    case 'L':
+      return argument_UNSUPPORTED;
+    default:
+      return argument_INT;
+    }
+  case 'e':
+  case 'E':
+  case 'f':
+  case 'F':
+  case 'g':
+  case 'G':
+  case 'a':
+  case 'A':
+    return length == 0 || length == 'l' ? argument_DOUBLE : argument_UNSUPPORTED;
+  case 's':
+    return length == 0 ? argument_STRING : argument_UNSUPPORTED;
+  case 'p':
+    return argument_POINTER;
+  case '%':
+    return argument_NONE;
+  default:
+    return argument_UNSUPPORTED;
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Reads the conversion starting at the '%' of pFormat, the same way when the message is queued and when it is written
+static void parseConversion(const char *pFormat, LogConversion *pConversion) {
+  const char *pSpec;
+  char length;
+
+  pSpec = pFormat + 1;
+  pConversion->stars = 0;
+  pConversion->precision = -1;
+  while (*pSpec == '-' || *pSpec == '+' || *pSpec == ' ' || *pSpec == '#' || *pSpec == '0' || *pSpec == '\'') {
+    pSpec++;
+  }
+  if (*pSpec == '*') {
+    pConversion->stars++;
+    pSpec++;
+  }
+  while (*pSpec >= '0' && *pSpec <= '9') {
+    pSpec++;
+  }
+  if (*pSpec == '.') {
+    pSpec++;
+    if (*pSpec == '*') {
+      pConversion->precision = LOG_STAR_PRECISION;
+      pConversion->stars++;
+      pSpec++;
+    } else {
+      pConversion->precision = 0;
+      while (*pSpec >= '0' && *pSpec <= '9') {
+        pConversion->precision = pConversion->precision * 10 + *pSpec++ - '0';
+      }
+    }
+  }
+
+  // hh and h are promoted to int, ll is stored as 'q'
+  length = 0;
+  if (*pSpec == 'h') {
+    pSpec += pSpec[1] == 'h' ? 2 : 1;
+  } else if (*pSpec == 'l' && pSpec[1] == 'l') {
+    length = 'q';
+    pSpec += 2;
+  } else if (*pSpec == 'l' || *pSpec == 'z' || *pSpec == 'j' || *pSpec == 't' || *pSpec == 'L') {
+    length = *pSpec++;
+  }
+
+  pConversion->argument = *pSpec == '\0' ? argument_UNSUPPORTED : conversionArgument(length, *pSpec);
+  pConversion->size = (int)(pSpec - pFormat) + (*pSpec != '\0');
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The arguments of pFormat in the order of the call, a '*' width or precision as an argument_INT before its value
+static void compileFormat(const char *pFormat, LogFormat *pCompiled) {
+  LogConversion conversion;
+  int star;
+
+  pCompiled->pFormat = pFormat;
+  pCompiled->arguments = 0;
+  // the text between the conversions is skipped by strchr(), the C library compares many bytes at once
+  while ((pFormat = strchr(pFormat, '%')) != NULL) {
+    parseConversion(pFormat, &conversion);
+    pFormat += conversion.size;
+    if (conversion.argument == argument_NONE) {
+      continue;
+    }
+    if (conversion.argument == argument_UNSUPPORTED ||
+        pCompiled->arguments + conversion.stars + 1 > LOG_MAX_ARGUMENTS) {
+      pCompiled->arguments = LOG_FORMATTED_BY_CALLER;
+      return;
+    }
+    for (star = 0; star < conversion.stars; star++) {
+      pCompiled->pArguments[pCompiled->arguments] = argument_INT;
+      pCompiled->pPrecisions[pCompiled->arguments++] = -1;
+    }
+    pCompiled->pArguments[pCompiled->arguments] = (uint8_t)conversion.argument;
+    pCompiled->pPrecisions[pCompiled->arguments++] = (int16_t)conversion.precision;
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Copies the arguments of a compiled format in the record
+static void captureArguments(LogRecord *pRecord, const LogFormat *pCompiled, va_list vaList) {
+  const char *pString;
+  uint64_t *pValue;
+  size_t length;
+  double value;
+  int precision;
+  int room;
+  int i;
+
+  pRecord->arguments = pCompiled->arguments;
+  pRecord->textUsed = 0;
+  for (i = 0; i < pCompiled->arguments; i++) {
+    pValue = &pRecord->pArguments[i];
+    switch (pCompiled->pArguments[i]) {
+    case argument_INT:
+      *pValue = (uint64_t)(int64_t)va_arg(vaList, int);
+      break;
+    case argument_LONG:
+      *pValue = (uint64_t)(int64_t)va_arg(vaList, long);
+      break;
+    case argument_LONG_LONG:
+      *pValue = (uint64_t)va_arg(vaList, long long);
+      break;
+    case argument_SIZE:
+      *pValue = (uint64_t)va_arg(vaList, size_t);
+      break;
+    case argument_INTMAX:
+      *pValue = (uint64_t)va_arg(vaList, intmax_t);
+      break;
+    case argument_PTRDIFF:
+      *pValue = (uint64_t)va_arg(vaList, ptrdiff_t);
+      break;
+    case argument_POINTER:
+      *pValue = (uint64_t)(uintptr_t)va_arg(vaList, void *);
+      break;
+    case argument_DOUBLE:
+      value = va_arg(vaList, double);
+      memcpy(pValue, &value, sizeof(double));
+      break;
+    default:
+      // the text, not the pointer: the caller may reuse its buffer as soon as logger() returns. A precision bounds the
+      // bytes read, the string of a slice is not terminated.
+      pString = va_arg(vaList, const char *);
+      if (pString == NULL) {
+        pString = "(null)";
+      }
+      precision = pCompiled->pPrecisions[i] == LOG_STAR_PRECISION ? (int)pValue[-1] : pCompiled->pPrecisions[i];
+      room = LOG_TEXT_SIZE - 1 - (int)pRecord->textUsed;
+      if (room < 0) {
+        // the text is full, the '\0' of the last string stands for this one
+        *pValue = LOG_TEXT_SIZE - 1;
+        break;
+      }
+      length = strnlen(pString, precision >= 0 && precision < room ? precision : room);
+      memcpy(&pRecord->pText[pRecord->textUsed], pString, length);
+      pRecord->pText[pRecord->textUsed + length] = '\0';
+      *pValue = pRecord->textUsed;
+      pRecord->textUsed += (uint16_t)(length + 1);
+      break;
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+#define LOG_SNPRINTF(value)                                                                                            \
+  (conversion.stars == 0   ? snprintf(pOutput, size, pSpec, value)                                                     \
+   : conversion.stars == 1 ? snprintf(pOutput, size, pSpec, (int)pArguments[0], value)                                 \
+                           : snprintf(pOutput, size, pSpec, (int)pArguments[0], (int)pArguments[1], value))
+
+// Formats the conversion at pFormat with the arguments copied from it, returns the bytes of pFormat read
+static int formatConversion(const LogRecord *pRecord, const char *pFormat, int *pArgument, char *pOutput, size_t size,
+                            int *pWritten) {
+  LogConversion conversion;
+  const uint64_t *pArguments;
+  char pSpec[32];
+  double value;
   int written;
 
-  if (level == log_NONE || level <= _level) {
-    if (_logFile == NULL) {
-      _logFile = fopen("stdout.log", "a+");
+  parseConversion(pFormat, &conversion);
+  if (conversion.argument == argument_NONE) {
+    *pWritten = snprintf(pOutput, size, "%%");
+    return conversion.size;
+  }
+  pArguments = &pRecord->pArguments[*pArgument];
+  *pArgument += conversion.stars + 1;
+  if (conversion.size >= (int)sizeof(pSpec)) {
+    *pWritten = 0;
+    return conversion.size;
+  }
+  memcpy(pSpec, pFormat, conversion.size);
+  pSpec[conversion.size] = '\0';
+
+  switch (conversion.argument) {
+  case argument_LONG:
+    written = LOG_SNPRINTF((long)pArguments[conversion.stars]);
+    break;
+  case argument_LONG_LONG:
+    written = LOG_SNPRINTF((long long)pArguments[conversion.stars]);
+    break;
+  case argument_SIZE:
+    written = LOG_SNPRINTF((size_t)pArguments[conversion.stars]);
+    break;
+  case argument_INTMAX:
+    written = LOG_SNPRINTF((intmax_t)pArguments[conversion.stars]);
+    break;
+  case argument_PTRDIFF:
+    written = LOG_SNPRINTF((ptrdiff_t)pArguments[conversion.stars]);
+    break;
+  case argument_POINTER:
+    written = LOG_SNPRINTF((void *)(uintptr_t)pArguments[conversion.stars]);
+    break;
+  case argument_DOUBLE:
+    memcpy(&value, &pArguments[conversion.stars], sizeof(double));
+    written = LOG_SNPRINTF(value);
+    break;
+  case argument_STRING:
+    written = LOG_SNPRINTF(&pRecord->pText[pArguments[conversion.stars]]);
+    break;
+  default:
+    written = LOG_SNPRINTF((int)pArguments[conversion.stars]);
+    break;
+  }
+
+  *pWritten = written < 0 ? 0 : written;
+  return conversion.size;
+}
+
+#undef LOG_SNPRINTF
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The message of a record as vsnprintf() would have formatted it, truncated to size - 1 bytes
+static size_t formatMessage(const LogRecord *pRecord, char *pOutput, size_t size) {
+  const char *pFormat;
+  size_t used;
+  int argument;
+  int written;
+
+  if (pRecord->pFormat == NULL) {
+    return snprintf(pOutput, size, "%s", pRecord->pText);
+  }
+
+  used = 0;
+  argument = 0;
+  pFormat = pRecord->pFormat;
+  while (*pFormat != '\0' && used < size - 1) {
+    if (*pFormat != '%') {
+      pOutput[used++] = *pFormat++;
+      continue;
     }
+    pFormat += formatConversion(pRecord, pFormat, &argument, &pOutput[used], size - used, &written);
+    used += (size_t)written < size - used ? (size_t)written : size - used - 1;
+  }
+  pOutput[used] = '\0';
+
+  return used;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// "HH:MM:SS.mmm: LEVEL: message\n" at the end of the batch, localtime_r() called once per second
+static void appendRecord(const LogRecord *pRecord, char *pBatch, size_t *pUsed) {
+  static time_t cachedSeconds = -1;
+  static char pClock[16];
+  struct tm timeStorage;
+  time_t timestamp;
+  size_t size;
 
-    gettimeofday(&currentTime, NULL);
-    timestamp = (time_t)currentTime.tv_sec;
+  timestamp = (time_t)(pRecord->timeUs / 1000000);
+  if (timestamp != cachedSeconds) {
 #ifdef WIN64
     localtime_s(&timeStorage, &timestamp);
 #else
     localtime_r(&timestamp, &timeStorage);
 #endif
+    snprintf(pClock, sizeof(pClock), "%02d:%02d:%02d", timeStorage.tm_hour, timeStorage.tm_min, timeStorage.tm_sec);
+    cachedSeconds = timestamp;
+  }
+
+  size = *pUsed;
+  size += sprintf(&pBatch[size], "%s.%03d: ", pClock, (int)(pRecord->timeUs / 1000 % 1000));
+  if (pRecord->level != log_NONE) {
+    size += sprintf(&pBatch[size], "%s: ", _ppLevelStr[pRecord->level]);
+  }
+  size += formatMessage(pRecord, &pBatch[size], LOG_MESSAGE_MAX - 1);
+  if (pBatch[size - 1] != '\n') {
+    pBatch[size++] = '\n';
+  }
+  *pUsed = size;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void writeBatch(const char *pBatch, size_t size) {
+  if (size == 0 || _logFile == NULL) {
+    return;
+  }
+  if (fwrite(pBatch, 1, size, _logFile) != size) {
+    printf("FATAL: unable to write %d bytes to log file\n", (int)size);
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
 
-    size = sprintf(pMessageBuffer, "%02d:%02d:%02d.%03d: ", timeStorage.tm_hour, timeStorage.tm_min, timeStorage.tm_sec,
-                   (int)currentTime.tv_usec / 1000);
-    if (level != log_NONE) {
-      size += sprintf(&pMessageBuffer[size], "%s: ", _ppLevelStr[level]);
+// Writes the records queued in all the rings, oldest first, then the count of the messages dropped since the last
+// call. Called with _flushLock held, the only consumer of the rings.
+static void drainRings(void) {
+  static char pBatch[LOG_BATCH_SIZE + LOG_MESSAGE_MAX + 64];
+  uint32_t pHeads[LOG_MAX_RINGS];
+  LogRing *ppRings[LOG_MAX_RINGS];
+  LogRecord dropRecord;
+  LogRecord *pOldest;
+  LogRing *pRing;
+  uint64_t dropped;
+  size_t used;
+  int oldest;
+  int rings;
+  int i;
+
+  rings = 0;
+  dropped = __atomic_load_n(&_droppedWithoutRing, __ATOMIC_RELAXED);
+  for (pRing = __atomic_load_n(&_pRings, __ATOMIC_ACQUIRE); pRing != NULL; pRing = pRing->pNext) {
+    dropped += __atomic_load_n(&pRing->dropped, __ATOMIC_RELAXED);
+    if (rings < LOG_MAX_RINGS) {
+      ppRings[rings] = pRing;
+      pHeads[rings] = __atomic_load_n(&pRing->head, __ATOMIC_ACQUIRE);
+      rings++;
     }
+  }
 
-    va_start(vaList, pMessage);
-    size += vsnprintf(&pMessageBuffer[size], sizeof(pMessageBuffer) - size - 1, pMessage, vaList);
-    if (pMessageBuffer[size - 1] != '\n') {
-      pMessageBuffer[size] = '\n';
-      size++;
+  // the queues are merged on the time of their messages, the order of the calls as long as the clock is monotonic
+  used = 0;
+  while (true) {
+    oldest = -1;
+    pOldest = NULL;
+    for (i = 0; i < rings; i++) {
+      pRing = ppRings[i];
+      if (pRing->tail != pHeads[i] &&
+          (pOldest == NULL || pRing->pRecords[pRing->tail % LOG_RING_SIZE].timeUs < pOldest->timeUs)) {
+        oldest = i;
+        pOldest = &pRing->pRecords[pRing->tail % LOG_RING_SIZE];
+      }
     }
-    va_end(vaList);
+    if (pOldest == NULL) {
+      break;
+    }
+    appendRecord(pOldest, pBatch, &used);
+    __atomic_store_n(&ppRings[oldest]->tail, ppRings[oldest]->tail + 1, __ATOMIC_RELEASE);
+    if (used >= LOG_BATCH_SIZE) {
+      writeBatch(pBatch, used);
+      used = 0;
+    }
+  }
+
+  if (dropped != _droppedReported) {
+    dropRecord.timeUs = realtimeMicros();
+    dropRecord.level = log_WARN;
+    dropRecord.pFormat = "%llu log messages dropped, the queue of their thread was full";
+    dropRecord.arguments = 1;
+    dropRecord.pArguments[0] = dropped - _droppedReported;
+    appendRecord(&dropRecord, pBatch, &used);
+    _droppedReported = dropped;
+  }
+  writeBatch(pBatch, used);
+  if (_logFile != NULL) {
+    fflush(_logFile);
+  }
+
+  // the ring of a thread gone is reused once empty
+  for (i = 0; i < rings; i++) {
+    pRing = ppRings[i];
+    if (__atomic_load_n(&pRing->state, __ATOMIC_ACQUIRE) == ring_RELEASED &&
+        pRing->tail == __atomic_load_n(&pRing->head, __ATOMIC_ACQUIRE)) {
+      __atomic_store_n(&pRing->state, ring_FREE, __ATOMIC_RELEASE);
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void *loggerThread(void *pUnused) {
+  struct timespec deadline;
+
+  pthread_mutex_lock(&_flushLock);
+  while (!_stopping) {
+    drainRings();
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += LOG_FLUSH_INTERVAL_MS * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&_flushWakeUp, &_flushLock, &deadline);
+  }
+  drainRings();
+  pthread_mutex_unlock(&_flushLock);
+
+  return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// At exit: the writer is stopped once everything queued is written, the later messages are written by their caller.
+// A message queued while _stopped is set is drained by its caller, see logger().
+static void stopLogger(void) {
+  __atomic_store_n(&_stopped, true, __ATOMIC_RELEASE);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  pthread_mutex_lock(&_flushLock);
+  _stopping = true;
+  pthread_cond_signal(&_flushWakeUp);
+  pthread_mutex_unlock(&_flushLock);
+  if (_writerStarted) {
+    pthread_join(_writerThread, NULL);
+  } else {
+    loggerFlush();
+  }
+}
 
-    written = fwrite(pMessageBuffer, 1, size, _logFile);
-    if (written == -1) {
-      printf("FATAL: unable to write %d bytes to log file\n", (int)size);
-      exit(EXIT_FAILURE);
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void releaseRing(void *pRing) {
+  __atomic_store_n(&((LogRing *)pRing)->state, ring_RELEASED, __ATOMIC_RELEASE);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void startLogger(void) {
+  _logFile = fopen("stdout.log", "a+");
+  pthread_key_create(&_ringKey, releaseRing);
+  _writerStarted = pthread_create(&_writerThread, NULL, loggerThread, NULL) == 0;
+  // without writer, every message is written by its caller
+  _stopped = !_writerStarted;
+  atexit(stopLogger);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// The ring of the calling thread: one left by a thread gone, or a new one added to the list
+static LogRing *acquireRing(void) {
+  LogRing *pRing;
+  int expected;
+
+  for (pRing = __atomic_load_n(&_pRings, __ATOMIC_ACQUIRE); pRing != NULL; pRing = pRing->pNext) {
+    expected = ring_FREE;
+    if (__atomic_compare_exchange_n(&pRing->state, &expected, ring_OWNED, false, __ATOMIC_ACQ_REL,
+                                    __ATOMIC_RELAXED)) {
+      break;
+    }
+  }
+  if (pRing == NULL) {
+    pRing = (LogRing *)calloc(1, sizeof(LogRing));
+    if (pRing == NULL) {
+      return NULL;
+    }
+    pRing->state = ring_OWNED;
+    pRing->pNext = __atomic_load_n(&_pRings, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&_pRings, &pRing->pNext, pRing, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
     }
   }
+
+  pthread_setspecific(_ringKey, pRing);
+  _pThreadRing = pRing;
+  return pRing;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Formats and writes on the calling thread, once the writer is stopped
+static void writeNow(Level level, const char *pMessage, va_list vaList) {
+  char pBatch[LOG_MESSAGE_MAX + 64];
+  LogRecord record;
+  size_t used;
+
+  record.timeUs = realtimeMicros();
+  record.level = level;
+  record.pFormat = NULL;
+  vsnprintf(record.pText, sizeof(record.pText), pMessage, vaList);
+  used = 0;
+  pthread_mutex_lock(&_flushLock);
+  appendRecord(&record, pBatch, &used);
+  writeBatch(pBatch, used);
+  fflush(_logFile);
+  pthread_mutex_unlock(&_flushLock);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void logger(Level level, const char *pMessage, ...) {
+  LogFormat *pCompiled;
+  LogRecord *pRecord;
+  LogRing *pRing;
+  va_list vaList;
+  uint32_t head;
+
+  if (level != log_NONE && level > _level) {
+    return;
+  }
+  pthread_once(&_loggerOnce, startLogger);
+  if (__atomic_load_n(&_stopped, __ATOMIC_ACQUIRE)) {
+    va_start(vaList, pMessage);
+    writeNow(level, pMessage, vaList);
+    va_end(vaList);
+    return;
+  }
+
+  pRing = _pThreadRing != NULL ? _pThreadRing : acquireRing();
+  if (pRing == NULL) {
+    __atomic_fetch_add(&_droppedWithoutRing, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  head = pRing->head;
+  if (head - __atomic_load_n(&pRing->tail, __ATOMIC_ACQUIRE) >= LOG_RING_SIZE) {
+    __atomic_store_n(&pRing->dropped, pRing->dropped + 1, __ATOMIC_RELAXED);
+    return;
+  }
+
+  pRecord = &pRing->pRecords[head % LOG_RING_SIZE];
+  pRecord->timeUs = realtimeMicros();
+  pRecord->level = level;
+  pRecord->pFormat = pMessage;
+  pCompiled = &pRing->pFormats[((uintptr_t)pMessage >> 3) & (LOG_FORMAT_CACHE - 1)];
+  if (pCompiled->pFormat != pMessage) {
+    compileFormat(pMessage, pCompiled);
+  }
+  va_start(vaList, pMessage);
+  if (pCompiled->arguments == LOG_FORMATTED_BY_CALLER) {
+    // a conversion the queue cannot hold, the message is formatted now
+    vsnprintf(pRecord->pText, sizeof(pRecord->pText), pMessage, vaList);
+    pRecord->pFormat = NULL;
+  } else {
+    captureArguments(pRecord, pCompiled, vaList);
+  }
+  va_end(vaList);
+  // a full barrier, cheaper as a locked add than as a fence: either stopLogger() drains after this message was queued,
+  // or this thread sees _stopped and drains it
+  __atomic_fetch_add(&pRing->head, 1, __ATOMIC_SEQ_CST);
+  if (level == log_FATAL || __atomic_load_n(&_stopped, __ATOMIC_SEQ_CST)) {
+    loggerFlush();
+  } else if (head + 1 - __atomic_load_n(&pRing->tail, __ATOMIC_RELAXED) == LOG_RING_SIZE / 2) {
+    // a burst, the writer is woken before the end of its wait
+    pthread_cond_signal(&_flushWakeUp);
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+void loggerFlush(void) {
+  pthread_once(&_loggerOnce, startLogger);
+  pthread_mutex_lock(&_flushLock);
+  drainRings();
+  pthread_mutex_unlock(&_flushLock);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+uint64_t loggerDropped(void) {
+  LogRing *pRing;
+  uint64_t dropped;
+
+  dropped = __atomic_load_n(&_droppedWithoutRing, __ATOMIC_RELAXED);
+  for (pRing = __atomic_load_n(&_pRings, __ATOMIC_ACQUIRE); pRing != NULL; pRing = pRing->pNext) {
+    dropped += __atomic_load_n(&pRing->dropped, __ATOMIC_RELAXED);
+  }
+  return dropped;
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/